@@ -0,0 +1,169 @@
+/** @file codecbench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Compression ratio and throughput of the delta/XOR codec
+ *
+ *  Usage: codecbench [passes] [segment.vdl ...]
+ *
+ *  The GPS capture in gpstestdata.txt is replayed passes times as one
+ *  reading per fix; only the GPS channels and the capture stamps move in
+ *  that data set, the other channels hold a fixed reading. Every segment
+ *  named on the command line is measured as a separate data set.
+ */
+
+#include "../dlclock.h"
+#include "../dlcodec.h"
+#include "../dllog.h"
+#include "../nmea.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define GPSDATA "gpstestdata.txt"
+
+/** @brief Build readings from the GPS capture, one per RMC or GGA fix.
+ */
+static void loadGps(std::vector<reading_s> &out, int passes) {
+  reading_s r = {1646000000, 24.6f, 32.0f,  101.3f, 0.012f, -0.021f,
+                 0.981f,     1.5f,  -2.25f, 0.125f, 21.5f,  -3.75f,
+                 40.125f,    0,     0,      0,      0,      0};
+  char line[256];
+
+  for (int p = 0; p < passes; p++) {
+    FILE *fp = fopen(GPSDATA, "r");
+    if (fp == NULL) {
+      perror(GPSDATA);
+      exit(1);
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+      switch (nmea_get_message_type(line)) {
+      case NMEA_GPGGA: {
+        gpgga_t gga;
+        nmea_parse_gpgga(line, &gga);
+        r.latitude = gga.lat7;
+        r.longitude = gga.lon7;
+        r.altitude = (float)gga.altitude;
+        break;
+      }
+      case NMEA_GPRMC: {
+        gprmc_t rmc;
+        nmea_parse_gprmc(line, &rmc);
+        r.latitude = rmc.lat7;
+        r.longitude = rmc.lon7;
+        r.speed = (float)rmc.speed;
+        r.heading = (float)rmc.course;
+        break;
+      }
+      default:
+        continue;
+      }
+      // Stamp the fix one second apart with some read latency jitter
+      r.rtime++;
+      r.gpst = (int64_t)out.size() * 1000000000 +
+               (int64_t)(out.size() * 7919) % 1000000;
+      r.imut = r.envt = r.gpst;
+      out.push_back(r);
+    }
+    fclose(fp);
+  }
+}
+
+/** @brief Read every record of a segment.
+ */
+static int loadSegment(std::vector<reading_s> &out, const char *path) {
+  dlsegmap_t m;
+
+  if (DlSegMap(&m, path) < 0) {
+    perror(path);
+    return -1;
+  }
+  for (size_t i = 0; i < m.nrecs; i++) {
+    reading_s r;
+    DlSegRead(&m, i, &r);
+    out.push_back(r);
+  }
+  DlSegUnmap(&m);
+  return 0;
+}
+
+/** @brief Encode, decode and check one data set.
+ */
+static void measure(const char *name, const std::vector<reading_s> &in) {
+  static dlencoder_t enc;
+  std::vector<uint8_t> blocks;
+  std::vector<reading_s> back(in.size());
+  char csv[DLFMT_BUFSZ];
+  size_t csvBytes = 0;
+  const uint8_t *blk;
+  size_t len;
+  int64_t t0;
+
+  if (in.empty()) {
+    return;
+  }
+  for (const reading_s &r : in) {
+    csvBytes += DlFormatCsv(&r, csv, sizeof(csv));
+  }
+
+  t0 = DlMonotonicNs();
+  DlEncInit(&enc);
+  for (const reading_s &r : in) {
+    if (DlEncAppend(&enc, &r) == 1) {
+      len = DlEncBlock(&enc, &blk);
+      blocks.insert(blocks.end(), blk, blk + len);
+    }
+  }
+  len = DlEncBlock(&enc, &blk);
+  blocks.insert(blocks.end(), blk, blk + len);
+  double encNs = (double)(DlMonotonicNs() - t0);
+
+  t0 = DlMonotonicNs();
+  size_t n = 0;
+  for (size_t off = 0; off < blocks.size();) {
+    dlblkhdr_t hdr;
+    memcpy(&hdr, &blocks[off], sizeof(hdr));
+    int got = DlDecBlock(&blocks[off], blocks.size() - off, &back[n],
+                         back.size() - n);
+    if (got < 0) {
+      printf("%s: corrupt block at %zu\n", name, off);
+      return;
+    }
+    n += got;
+    off += hdr.bytes;
+  }
+  double decNs = (double)(DlMonotonicNs() - t0);
+
+  size_t bad = 0;
+  for (size_t i = 0; i < in.size(); i++) {
+    bad += (i >= n || in[i].rtime != back[i].rtime ||
+            memcmp(&in[i].temperature, &back[i].temperature,
+                   DLFMT_NFIELDS * sizeof(float)) != 0);
+  }
+
+  size_t binBytes = in.size() * sizeof(dlrecord_t);
+  printf("%s: %zu samples, %zu blocks%s\n", name, in.size(),
+         (in.size() + DLC_BLOCKRECS - 1) / DLC_BLOCKRECS,
+         bad ? ", ROUND TRIP MISMATCH" : "");
+  printf("  csv %zu B, binary %zu B, codec %zu B (%.2f B/sample)\n", csvBytes,
+         binBytes, blocks.size(), (double)blocks.size() / in.size());
+  printf("  ratio %.1fx vs csv, %.1fx vs binary\n",
+         (double)csvBytes / blocks.size(), (double)binBytes / blocks.size());
+  printf("  encode %.0f samples/s, decode %.0f samples/s\n",
+         in.size() / (encNs / 1e9), in.size() / (decNs / 1e9));
+}
+
+int main(int argc, char *argv[]) {
+  int passes = (argc > 1) ? atoi(argv[1]) : 100;
+  std::vector<reading_s> gps;
+
+  loadGps(gps, passes);
+  measure(GPSDATA, gps);
+  for (int i = 2; i < argc; i++) {
+    std::vector<reading_s> seg;
+    if (loadSegment(seg, argv[i]) == 0) {
+      measure(argv[i], seg);
+    }
+  }
+  return 0;
+}
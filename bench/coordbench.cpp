@@ -0,0 +1,150 @@
+/** @file coordbench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Cost and precision of the NMEA coordinate conversion
+ *
+ *  Usage: coordbench [passes]
+ *
+ *  Every latitude and longitude field of the GGA, RMC and GLL sentences in
+ *  gpstestdata.txt is converted passes times (default 20000), once through
+ *  the atof, DlGpsDegDec and float path this replaced and once with
+ *  nmea_coord. Both results are compared against the exact value of the
+ *  text, and the worst error is reported in metres along a meridian.
+ */
+
+#include "../dlclock.h"
+#include "../nmea.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define GPSDATA "gpstestdata.txt"
+#define LINESZ 256
+#define MPERDEG 111195.0 ///< Metres per degree of a great circle
+#define DLROUND(x) ((x < 0) ? (ceil((x)-0.5)) : (floor((x)+0.5)))
+
+typedef struct coordtext {
+  std::string text; ///< ddmm.mmmm field
+  char hemi;        ///< N, S, E or W
+} coordtext_t;
+
+/** @brief The conversion nmea_coord replaced, as DlGpsDegDec had it.
+ */
+static double legacyDegDec(double deg_point) {
+  double ddeg;
+  double sec = modf(deg_point, &ddeg) * 60;
+  int deg = (int)(ddeg / 100);
+  int min = (int)(deg_point - (deg * 100));
+
+  double absmlat = DLROUND(min * 1000000.);
+  double absslat = DLROUND(sec * 1000000.);
+  double absdlat = DLROUND(deg * 1000000.);
+
+  return DLROUND(absdlat + (absmlat / 60) + (absslat / 3600)) / 1000000;
+}
+
+/** @brief atof, sign, DlGpsDegDec and the float of reading_s.
+ */
+static float legacyCoord(const coordtext_t &c) {
+  double v = atof(c.text.c_str());
+  v = (c.hemi == 'S' || c.hemi == 'W') ? -v : v;
+  return (float)legacyDegDec(v);
+}
+
+/** @brief Exact degrees of the text, from decimal digits.
+ */
+static long double exactCoord(const coordtext_t &c) {
+  long double v = strtold(c.text.c_str(), NULL);
+  long double deg = floorl(v / 100);
+  long double d = deg + (v - deg * 100) / 60;
+  return (c.hemi == 'S' || c.hemi == 'W') ? -d : d;
+}
+
+/** @brief Collect the coordinate fields of the capture.
+ */
+static void loadCoords(std::vector<coordtext_t> &out) {
+  char line[LINESZ];
+  FILE *fp = fopen(GPSDATA, "r");
+
+  if (fp == NULL) {
+    perror(GPSDATA);
+    exit(1);
+  }
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    nmeatok_t tok;
+    int first;
+    switch (nmea_tokenize(line, strlen(line), &tok)) {
+    case NMEA_GGA:
+      first = 2;
+      break;
+    case NMEA_RMC:
+      first = 3;
+      break;
+    case NMEA_GLL:
+      first = 1;
+      break;
+    default:
+      continue;
+    }
+    for (int i = first; i < first + 4 && i + 1 < tok.nfields; i += 2) {
+      if (tok.len[i] > 0 && tok.len[i + 1] > 0) {
+        out.push_back({std::string(tok.field[i], tok.len[i]),
+                       tok.field[i + 1][0]});
+      }
+    }
+  }
+  fclose(fp);
+}
+
+int main(int argc, char *argv[]) {
+  int passes = (argc > 1) ? atoi(argv[1]) : 20000;
+  std::vector<coordtext_t> coords;
+  double sink = 0;
+  int64_t isink = 0;
+
+  loadCoords(coords);
+  if (coords.empty()) {
+    fprintf(stderr, "%s: no coordinates\n", GPSDATA);
+    return 1;
+  }
+  size_t total = coords.size() * (size_t)passes;
+
+  int64_t t0 = DlMonotonicNs();
+  for (int p = 0; p < passes; p++) {
+    for (const coordtext_t &c : coords) {
+      sink += legacyCoord(c);
+    }
+  }
+  double legacyNs = (double)(DlMonotonicNs() - t0) / total;
+
+  t0 = DlMonotonicNs();
+  for (int p = 0; p < passes; p++) {
+    for (const coordtext_t &c : coords) {
+      isink += nmea_coord(c.text.data(), c.text.size(), c.hemi);
+    }
+  }
+  double coordNs = (double)(DlMonotonicNs() - t0) / total;
+
+  long double legacyErr = 0;
+  long double coordErr = 0;
+  for (const coordtext_t &c : coords) {
+    long double exact = exactCoord(c);
+    long double e1 = fabsl(legacyCoord(c) - exact);
+    long double e2 = fabsl((long double)nmea_coord(c.text.data(), c.text.size(),
+                                                   c.hemi) /
+                               NMEA_DEGE7 -
+                           exact);
+    legacyErr = (e1 > legacyErr) ? e1 : legacyErr;
+    coordErr = (e2 > coordErr) ? e2 : coordErr;
+  }
+
+  printf("%zu coordinates x %d passes\n", coords.size(), passes);
+  printf("atof+DlGpsDegDec+float %7.1f ns/coord  max error %8.4f m\n",
+         legacyNs, (double)(legacyErr * MPERDEG));
+  printf("nmea_coord             %7.1f ns/coord  max error %8.4f m  %.1fx\n",
+         coordNs, (double)(coordErr * MPERDEG), legacyNs / coordNs);
+  return (sink == 0 && isink == 0) ? 1 : 0;
+}
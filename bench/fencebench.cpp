@@ -0,0 +1,247 @@
+/** @file fencebench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Load time and lookup latency of the geofence index
+ *
+ *  Usage: fencebench [fences] [fixes] [speed]
+ *
+ *  fences random polygons (default 5000) of 6 to 24 vertices and 50 m to
+ *  1 km across are scattered over half a degree around DLAT, DLONG and
+ *  written to a fence file, which is then loaded. A track of fixes
+ *  (default 100000) one second apart at speed m/s (default 15) wanders
+ *  over the area, stopping for a minute every ten, and each fix is checked
+ *  with DlFenceCheck and against every fence. The fences each one is in
+ *  must agree, and the latency per fix is reported. A second set piles more
+ *  than DLFENCE_MAXCAND bounding boxes over one point and is checked the
+ *  same way along a line through it.
+ */
+
+#include "../dlclock.h"
+#include "../dlfence.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+#include <vector>
+
+#define LAT0 437289000 ///< Centre, 1e-7 degrees
+#define LON0 (-796074000)
+#define SPAN 5000000   ///< Side of the area, 1e-7 degrees
+#define RAD (M_PI / 180)
+#define MLAT7 0.011119493 ///< Metres per 1e-7 degree of latitude
+
+typedef struct latency {
+  std::vector<int64_t> ns; ///< Time of each fix
+  int64_t total;           ///< Sum of ns
+} latency_t;
+
+/** @brief Print mean, p99 and max of a latency set.
+ */
+static void report(const char *name, latency_t *l) {
+  std::vector<int64_t> &v = l->ns;
+  std::sort(v.begin(), v.end());
+  printf("%-12s mean %8.0f ns  p99 %8lld ns  max %8lld ns\n", name,
+         (double)l->total / v.size(), (long long)v[v.size() * 99 / 100],
+         (long long)v.back());
+}
+
+/** @brief Write random star shaped polygons to a fence file.
+ *  @return 0 on success, -1 on a write error
+ */
+static int writeFences(FILE *fp, int n, std::mt19937 &rng) {
+  std::uniform_real_distribution<double> u(0, 1);
+  double mlon7 = MLAT7 * cos(LAT0 / 1e7 * RAD);
+
+  fprintf(fp, "# fencebench, %d random polygons\n", n);
+  for (int i = 0; i < n; i++) {
+    double clat = LAT0 + (u(rng) - 0.5) * SPAN;
+    double clon = LON0 + (u(rng) - 0.5) * SPAN;
+    double r = 25 + u(rng) * 475;
+    int nv = 6 + (int)(u(rng) * 19);
+    fprintf(fp, "%d f%d", i + 1, i + 1);
+    for (int k = 0; k < nv; k++) {
+      double a = 2 * M_PI * (k + 0.8 * u(rng)) / nv;
+      double d = r * (0.4 + 0.6 * u(rng));
+      fprintf(fp, " %.7f,%.7f", (clat + d * cos(a) / MLAT7) / 1e7,
+              (clon + d * sin(a) / mlon7) / 1e7);
+    }
+    fputc('\n', fp);
+  }
+  return ferror(fp) ? -1 : 0;
+}
+
+/** @brief Check fixes on a line through more than DLFENCE_MAXCAND
+ *  overlapping bounding boxes against every fence.
+ *
+ *  10 squares hold the centre. 70 L shaped fences along their south and
+ *  east sides have boxes that hold it too, but not the centre itself.
+ *  @return fixes that disagree or left a fence listed twice, -1 on error
+ */
+static long crowdCheck(void) {
+  char path[] = "/tmp/fencebenchXXXXXX";
+  const int nsquare = 10;
+  const int nell = DLFENCE_MAXCAND + 6;
+  dlfenceset_t set;
+  dlfencetrack_t track;
+
+  int fd = mkstemp(path);
+  FILE *fp = (fd < 0) ? NULL : fdopen(fd, "w");
+  if (fp == NULL) {
+    perror("mkstemp");
+    return -1;
+  }
+  for (int i = 0; i < nsquare + nell; i++) {
+    double d = (20000 + 500 * i) / 1e7;
+    double w = 5000 / 1e7;
+    double lat = LAT0 / 1e7;
+    double lon = LON0 / 1e7;
+    if (i < nsquare) {
+      fprintf(fp, "%d s%d %.7f,%.7f %.7f,%.7f %.7f,%.7f %.7f,%.7f\n", i + 1,
+              i + 1, lat - d, lon - d, lat - d, lon + d, lat + d, lon + d,
+              lat + d, lon - d);
+    } else {
+      fprintf(fp,
+              "%d l%d %.7f,%.7f %.7f,%.7f %.7f,%.7f %.7f,%.7f %.7f,%.7f "
+              "%.7f,%.7f\n",
+              i + 1, i + 1, lat - d, lon - d, lat - d, lon + d, lat + d,
+              lon + d, lat + d, lon + d - w, lat - d + w, lon + d - w,
+              lat - d + w, lon - d);
+    }
+  }
+  if (fclose(fp) != 0 || DlFenceLoad(&set, path) != nsquare + nell) {
+    perror(path);
+    unlink(path);
+    return -1;
+  }
+  unlink(path);
+
+  long bad = 0, events = 0;
+  int32_t ev[2 * (nsquare + nell)];
+  DlFenceTrackInit(&track);
+  for (int32_t x = -100000; x <= 100000; x += 1000) {
+    int32_t lat = LAT0 + x / 4;
+    int32_t lon = LON0 + x;
+    events += DlFenceCheck(&set, &track, lat, lon, ev, nsquare + nell);
+    uint32_t nbin = 0;
+    bool same = true;
+    for (uint32_t i = 0; i < set.nfences; i++) {
+      if (DlFenceContains(&set, i, lat, lon)) {
+        same = same && nbin < track.ninside && track.inside[nbin] == i;
+        nbin++;
+      }
+    }
+    bad += !(same && nbin == track.ninside);
+  }
+  printf("%d overlapping boxes: %ld events, %llu lost, %ld fixes disagree\n",
+         nsquare + nell, events, (unsigned long long)track.lost, bad);
+  DlFenceFree(&set);
+  return bad + (track.lost > 0);
+}
+
+int main(int argc, char *argv[]) {
+  int nfences = (argc > 1) ? atoi(argv[1]) : 5000;
+  long nfixes = (argc > 2) ? atol(argv[2]) : 100000;
+  double speed = (argc > 3) ? atof(argv[3]) : 15;
+  char path[] = "/tmp/fencebenchXXXXXX";
+  std::mt19937 rng(19);
+  std::normal_distribution<double> gauss(0, 1);
+  dlfenceset_t set;
+  dlfencetrack_t track;
+
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    perror("mkstemp");
+    return 1;
+  }
+  FILE *fp = fdopen(fd, "w");
+  if (fp == NULL || writeFences(fp, nfences, rng) < 0 || fclose(fp) != 0) {
+    perror(path);
+    unlink(path);
+    return 1;
+  }
+  int64_t t0 = DlMonotonicNs();
+  int loaded = DlFenceLoad(&set, path);
+  int64_t loadNs = DlMonotonicNs() - t0;
+  unlink(path);
+  if (loaded <= 0) {
+    fprintf(stderr, "no fences loaded\n");
+    return 1;
+  }
+
+  uint32_t maxcell = 0;
+  for (uint32_t c = 0; c < set.rows * set.cols; c++) {
+    uint32_t n = set.cellstart[c + 1] - set.cellstart[c];
+    maxcell = (n > maxcell) ? n : maxcell;
+  }
+  printf("%d fences, %u vertices, %u skipped, loaded in %.1f ms\n", loaded,
+         set.nverts, set.skipped, loadNs / 1e6);
+  printf("grid %u x %u cells of %.0f m, %u entries, at most %u per cell\n",
+         set.rows, set.cols, set.cellsz * MLAT7,
+         set.cellstart[set.rows * set.cols], maxcell);
+
+  latency_t check{{}, 0}, brute{{}, 0};
+  check.ns.reserve(nfixes);
+  brute.ns.reserve(nfixes);
+  DlFenceTrackInit(&track);
+  double mlon7 = MLAT7 * cos(LAT0 / 1e7 * RAD);
+  double n = 0, e = 0, psi = 0;
+  long events = 0, mismatches = 0, insideFixes = 0;
+  int32_t ev[8];
+
+  for (long k = 0; k < nfixes; k++) {
+    // Wander, turning back towards the centre near the edge of the area
+    double half = SPAN / 2 * MLAT7 * 0.9;
+    psi += 0.1 * gauss(rng);
+    if (fabs(n) > half || fabs(e) > half) {
+      psi = atan2(-e, -n);
+    }
+    if (k % 600 >= 60) {
+      n += speed * cos(psi);
+      e += speed * sin(psi);
+    }
+    int32_t lat = LAT0 + (int32_t)lround(n / MLAT7);
+    int32_t lon = LON0 + (int32_t)lround(e / mlon7);
+
+    t0 = DlMonotonicNs();
+    events += DlFenceCheck(&set, &track, lat, lon, ev, 8);
+    int64_t dt = DlMonotonicNs() - t0;
+    check.ns.push_back(dt);
+    check.total += dt;
+
+    uint32_t bin[DLFENCE_MAXINSIDE];
+    uint32_t nbin = 0;
+    t0 = DlMonotonicNs();
+    for (uint32_t i = 0; i < set.nfences; i++) {
+      if (DlFenceContains(&set, i, lat, lon) &&
+          nbin < DLFENCE_MAXINSIDE) {
+        bin[nbin++] = i;
+      }
+    }
+    dt = DlMonotonicNs() - t0;
+    brute.ns.push_back(dt);
+    brute.total += dt;
+
+    bool same = track.ninside == nbin;
+    for (uint32_t i = 0; same && i < nbin; i++) {
+      same = track.inside[i] == bin[i];
+    }
+    mismatches += !same;
+    insideFixes += nbin > 0;
+  }
+
+  printf("%ld fixes at %.0f m/s, %ld inside a fence, %ld events, %llu lost\n",
+         nfixes, speed, insideFixes, events, (unsigned long long)track.lost);
+  printf("%.2f polygon tests per fix, %llu fixes at the last position\n",
+         (double)track.tests / nfixes, (unsigned long long)track.skips);
+  printf("%.1f%% of fixes skipped the cell walk: %llu at the last position, "
+         "%llu in its quiet box\n",
+         100.0 * (track.skips + track.reuses) / nfixes,
+         (unsigned long long)track.skips, (unsigned long long)track.reuses);
+  report("DlFenceCheck", &check);
+  report("every fence", &brute);
+  printf("%ld fixes disagree\n", mismatches);
+  DlFenceFree(&set);
+  return (mismatches || crowdCheck() != 0) ? 1 : 0;
+}
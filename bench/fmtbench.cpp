@@ -0,0 +1,120 @@
+/** @file fmtbench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Compare the table driven formatters with the sprintf path
+ *
+ *  Usage: fmtbench [iterations]
+ */
+
+#include "../dlclock.h"
+#include "../dlformat.h"
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <time.h>
+
+/** @brief CSV line as DlSaveLoggerData used to write it.
+ */
+static int sprintfCsv(const reading_s &r, char *buf) {
+  char ltime[26];
+  int commaIndex[] = {3, 7, 10, 19};
+
+  strcpy(ltime, ctime(&r.rtime));
+  for (int i : commaIndex) {
+    ltime[i] = ',';
+  }
+  return sprintf(
+      buf,
+      "%.24s,%3.1f,%3.0f,%3.1f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",
+      ltime, r.temperature, r.humidity, r.pressure, r.xa, r.ya, r.za, r.pitch,
+      r.roll, r.yaw, r.xm, r.ym, r.zm, r.latitude / 1e7, r.longitude / 1e7,
+      r.altitude, r.speed, r.heading);
+}
+
+/** @brief JSON object as DlSaveLoggerData used to write it.
+ */
+static int sprintfJson(const reading_s &r, char *buf) {
+  return sprintf(
+      buf,
+      "{\n\t\"rtime\":%lld,\n\t\"temperature\":%-3.1f,\n\t\"humidity\":%-3.0f,"
+      "\n\t\"pressure\":%-3.1f,\n\t\"xa\":%-f,\n\t\"ya\":%-f,\n\t\"za\":%-"
+      "f,\n\t\"pitch\":%-f,\n\t\"roll\":%-f,\n\t\"yaw\":%-f,\n\t\"xm\":%-"
+      "f,\n\t\"ym\":%-f,\n\t\"zm\":%-f,\n\t\"latitude\":%-f,"
+      "\n\t\"longitude\":%-f,\n\t\"altitude\":%-f,\n\t\"speed\":%-f,"
+      "\n\t\"heading\":%-f,\n\t\"active\": true\n}",
+      (long long)r.rtime, r.temperature, r.humidity, r.pressure, r.xa, r.ya,
+      r.za, r.pitch, r.roll, r.yaw, r.xm, r.ym, r.zm, r.latitude / 1e7,
+      r.longitude / 1e7, r.altitude, r.speed, r.heading);
+}
+
+/** @brief Format readings with every field at its widest in a DLFMT_BUFSZ
+ *  buffer.
+ *  @return 0 if every formatter fitted, -1 otherwise
+ */
+static int extremes(void) {
+  char buf[DLFMT_BUFSZ];
+  int worst[3] = {0, 0, 0};
+  int rc = 0;
+
+  for (float v : {FLT_MAX, -FLT_MAX}) {
+    reading_s r{0};
+    r.rtime = (v > 0) ? INT32_MAX : INT32_MIN;
+    for (const dlfmtfield_t &f : dlReadingFields) {
+      if (f.value != nullptr) {
+        r.*f.value = v;
+      } else {
+        r.*f.fixed = (v > 0) ? INT32_MAX : INT32_MIN;
+      }
+    }
+    for (const dlfmtstamp_t &s : dlReadingStamps) {
+      r.*s.value = (v > 0) ? INT64_MAX : INT64_MIN;
+    }
+    int (*fmt[3])(const reading_s *, char *, size_t) = {
+        DlFormatCsv, DlFormatJson, DlFormatText};
+    for (int i = 0; i < 3; i++) {
+      int n = fmt[i](&r, buf, sizeof(buf));
+      if (n < 0 || strlen(buf) != (size_t)n) {
+        rc = -1;
+      }
+      worst[i] = (n > worst[i]) ? n : worst[i];
+    }
+  }
+  printf("extremes in %zu bytes: csv %d, json %d, text %d%s\n", DLFMT_BUFSZ,
+         worst[0], worst[1], worst[2], rc < 0 ? "  FAILED" : "");
+  return rc;
+}
+
+int main(int argc, char *argv[]) {
+  int iters = (argc > 1) ? atoi(argv[1]) : 200000;
+  char buf[DLFMT_BUFSZ];
+  reading_s r = {1646000000, 24.6f, 32.0f,    101.3f,   0.012f,  -0.021f,
+                 0.981f,     1.5f,  -2.25f,   0.125f,   21.5f,   -3.75f,
+                 40.125f,    437289010, -796073990, 166.0f, 99.0f, 320.0f};
+  size_t sink = 0;
+  int64_t t0;
+
+  int rc = extremes();
+  printf("sprintf csv : %s", (sprintfCsv(r, buf), buf));
+  printf("DlFormatCsv : %s", (DlFormatCsv(&r, buf, sizeof(buf)), buf));
+
+  t0 = DlMonotonicNs();
+  for (int i = 0; i < iters; i++) {
+    r.rtime++;
+    sink += sprintfCsv(r, buf) + sprintfJson(r, buf);
+  }
+  double legacy = (double)(DlMonotonicNs() - t0) / iters;
+
+  t0 = DlMonotonicNs();
+  for (int i = 0; i < iters; i++) {
+    r.rtime++;
+    sink += DlFormatCsv(&r, buf, sizeof(buf)) +
+            DlFormatJson(&r, buf, sizeof(buf));
+  }
+  double table = (double)(DlMonotonicNs() - t0) / iters;
+
+  printf("sprintf     %8.1f ns/record (csv+json)\n", legacy);
+  printf("DlFormat*   %8.1f ns/record (csv+json)  %.1fx\n", table,
+         legacy / table);
+  return sink == 0 || rc < 0;
+}
@@ -0,0 +1,126 @@
+/** @file fusebench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Cost per update and accuracy of the GPS/IMU fusion filter
+ *
+ *  Usage: fusebench [seconds] [outage]
+ *
+ *  A vehicle is simulated driving at 15 m/s through alternating turns for
+ *  seconds (default 600), with 100 Hz IMU samples carrying noise and bias
+ *  and 1 Hz GPS fixes with 4 m of noise. From 120 s on there is no GPS for
+ *  outage seconds (default 30), as in a tunnel. The position error at the
+ *  IMU rate is compared with holding the last fix, as the logger did before
+ *  fusion, and the time spent in each filter call is reported.
+ */
+
+#include "../dlclock.h"
+#include "../dlfusion.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#define IMUHZ 100
+#define SPEED 15.0     ///< m/s
+#define LAT0 437289000 ///< Start, 1e-7 degrees
+#define LON0 (-796074000)
+#define OUTAGEAT 120   ///< s
+#define RAD (M_PI / 180)
+
+int main(int argc, char *argv[]) {
+  int seconds = (argc > 1) ? atoi(argv[1]) : 600;
+  int outage = (argc > 2) ? atoi(argv[2]) : 30;
+  std::mt19937 rng(252);
+  std::normal_distribution<double> gauss(0, 1);
+  double mlon7 = DLFUSE_MLAT7 * cos(LAT0 / 1e7 * RAD);
+  dlfusion_t f;
+
+  DlFuseInit(&f);
+  double n = 0, e = 0, psi = 30 * RAD, v = SPEED;
+  double stalen = 0, stalee = 0;
+  double sumFused = 0, sumStale = 0, sumHead = 0;
+  double maxFused = 0, maxStale = 0;
+  double outFused = 0, outStale = 0;
+  int64_t imuNs = 0, gpsNs = 0;
+  long imuCalls = 0, gpsCalls = 0, scored = 0;
+  uint32_t seq = 0;
+  double dt = 1.0 / IMUHZ;
+
+  for (long k = 0; k < (long)seconds * IMUHZ; k++) {
+    double t = k * dt;
+    // Alternate right and left turns, and change speed now and then
+    double r = 0.08 * sin(2 * M_PI * t / 60);
+    double a = 0.5 * sin(2 * M_PI * t / 45);
+    psi = remainder(psi + r * dt, 2 * M_PI);
+    v += a * dt;
+    n += v * cos(psi) * dt;
+    e += v * sin(psi) * dt;
+
+    imu_s imu{0};
+    imu.t = (int64_t)(t * 1e9) + 1;
+    imu.xa = (float)((a + 0.05 + 0.3 * gauss(rng)) / DLFUSE_G);
+    imu.ya = (float)((-v * r - 0.03 + 0.3 * gauss(rng)) / DLFUSE_G);
+    imu.yaw = (float)(-r + 0.004 + 0.01 * gauss(rng));
+    double mpsi = psi - DLFUSE_DECL * RAD + 5 * RAD * gauss(rng);
+    imu.xm = (float)(20 * cos(mpsi));
+    imu.ym = (float)(20 * sin(mpsi));
+
+    bool dark = t >= OUTAGEAT && t < OUTAGEAT + outage;
+    if (k % IMUHZ == 0 && !dark) {
+      fix_s fix{0};
+      fix.t = imu.t;
+      fix.seq = ++seq;
+      fix.latitude = LAT0 + (int32_t)lround((n + 2.5 * gauss(rng)) /
+                                            DLFUSE_MLAT7);
+      fix.longitude = LON0 + (int32_t)lround((e + 2.5 * gauss(rng)) / mlon7);
+      fix.speed = (float)((v + 0.2 * gauss(rng)) * 3.6);
+      fix.course = (float)(fmod(psi / RAD + 360, 360) + 2 * gauss(rng));
+      fix.hdop = 1;
+      fix.quality = 1;
+      stalen = (fix.latitude - LAT0) * DLFUSE_MLAT7;
+      stalee = (fix.longitude - LON0) * mlon7;
+      int64_t t0 = DlMonotonicNs();
+      DlFuseGps(&f, &fix);
+      gpsNs += DlMonotonicNs() - t0;
+      gpsCalls++;
+    }
+    int64_t t0 = DlMonotonicNs();
+    DlFuseImu(&f, &imu);
+    imuNs += DlMonotonicNs() - t0;
+    imuCalls++;
+
+    if (!imu.nav || t < 10) {
+      continue;
+    }
+    double fe = hypot((imu.latitude - LAT0) * DLFUSE_MLAT7 - n,
+                      (imu.longitude - LON0) * mlon7 - e);
+    double se = hypot(stalen - n, stalee - e);
+    double he = fabs(remainder(imu.heading * RAD - psi, 2 * M_PI)) / RAD;
+    sumFused += fe * fe;
+    sumStale += se * se;
+    sumHead += he * he;
+    maxFused = (fe > maxFused) ? fe : maxFused;
+    maxStale = (se > maxStale) ? se : maxStale;
+    if (dark) {
+      outFused = (fe > outFused) ? fe : outFused;
+      outStale = (se > outStale) ? se : outStale;
+    }
+    scored++;
+  }
+
+  printf("%d s at %d Hz, %d s outage, filter state %zu bytes\n", seconds,
+         IMUHZ, outage, sizeof(dlfusion_t));
+  printf("DlFuseImu %8.0f ns/sample   DlFuseGps %8.0f ns/fix\n",
+         (double)imuNs / imuCalls, (double)gpsNs / gpsCalls);
+  printf("IMU budget at %d Hz: %.3f%% of one core\n", IMUHZ,
+         (double)imuNs / imuCalls * IMUHZ / 1e7);
+  printf("position error  fused rms %7.2f m max %7.2f m, outage max %7.2f m\n",
+         sqrt(sumFused / scored), maxFused, outFused);
+  printf("                last fix  rms %7.2f m max %7.2f m, "
+         "outage max %7.2f m\n",
+         sqrt(sumStale / scored), maxStale, outStale);
+  printf("heading error   fused rms %7.2f deg\n", sqrt(sumHead / scored));
+  printf("%llu updates, %llu rejected\n", (unsigned long long)f.updates,
+         (unsigned long long)f.rejects);
+  return 0;
+}
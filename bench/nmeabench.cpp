@@ -0,0 +1,289 @@
+/** @file nmeabench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Compare the single pass NMEA tokenizer with the strchr/atof parser
+ *
+ *  Usage: nmeabench [passes]
+ *
+ *  Every sentence of gpstestdata.txt is identified and parsed passes times
+ *  by both parsers, and the parsed values are compared. The tokenizer is
+ *  also fed every truncation of every sentence, which the old parser
+ *  cannot survive.
+ */
+
+#include "../dlclock.h"
+#include "../nmea.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#define GPSDATA "gpstestdata.txt"
+
+// The parser as it was before nmea_tokenize, kept for comparison
+static uint8_t legacyValidChecksum(const char *message);
+
+/** @brief Parses GPGGA Message
+ *  @author Paul Moggach
+ *  @date 25MAR2019
+ *  @param char * nmea Pointer to message
+ *  @param gpgg_t * loc Pointer to output data structure
+ */
+static void legacyParseGpgga(char *nmea, gpgga_t *loc) {
+  char *p = nmea;
+
+  p = strchr(p, ',') + 1; // time
+  loc->utc = atof(p);
+
+  p = strchr(p, ',') + 1;
+  loc->latitude = atof(p);
+
+  p = strchr(p, ',') + 1;
+  switch (p[0]) {
+  case 'N':
+    loc->lat = 'N';
+    break;
+  case 'S':
+    loc->lat = 'S';
+    break;
+  case ',':
+    loc->lat = '\0';
+    break;
+  }
+
+  p = strchr(p, ',') + 1;
+  loc->longitude = atof(p);
+
+  p = strchr(p, ',') + 1;
+  switch (p[0]) {
+  case 'W':
+    loc->lon = 'W';
+    break;
+  case 'E':
+    loc->lon = 'E';
+    break;
+  case ',':
+    loc->lon = '\0';
+    break;
+  }
+
+  p = strchr(p, ',') + 1;
+  loc->quality = (uint8_t)atoi(p);
+
+  p = strchr(p, ',') + 1;
+  loc->satellites = (uint8_t)atoi(p);
+
+  p = strchr(p, ',') + 1;
+
+  p = strchr(p, ',') + 1;
+  loc->altitude = atof(p);
+}
+
+/** @brief Parses GPRMC Message
+ *  @author Paul Moggach
+ *  @date 25MAR2019
+ *  @param char * nmea Pointer to message
+ *  @param gpgg_t * loc Pointer to output data structure
+ */
+static void legacyParseGprmc(char *nmea, gprmc_t *loc) {
+  char *p = nmea;
+
+  p = strchr(p, ',') + 1; // skip time
+  p = strchr(p, ',') + 1; // skip status
+  p = strchr(p, ',') + 1;
+  loc->latitude = atof(p);
+  p = strchr(p, ',') + 1;
+  switch (p[0]) {
+  case 'N':
+    loc->lat = 'N';
+    break;
+  case 'S':
+    loc->lat = 'S';
+    break;
+  case ',':
+    loc->lat = '\0';
+    break;
+  }
+
+  p = strchr(p, ',') + 1;
+  loc->longitude = atof(p);
+  p = strchr(p, ',') + 1;
+  switch (p[0]) {
+  case 'W':
+    loc->lon = 'W';
+    break;
+  case 'E':
+    loc->lon = 'E';
+    break;
+  case ',':
+    loc->lon = '\0';
+    break;
+  }
+
+  p = strchr(p, ',') + 1;
+  loc->speed = atof(p);
+
+  p = strchr(p, ',') + 1;
+  loc->course = atof(p);
+
+  p = strchr(p, ',') + 1;
+  loc->date = atof(p);
+}
+
+/** @brief Get the message type (GPGGA, GPRMC, etc..)
+ *  @param message The NMEA message
+ *  @return The type of message if it is valid
+ */
+static uint8_t legacyMessageType(const char *message) {
+  uint8_t checksum = 0;
+  if ((checksum = legacyValidChecksum(message)) != _EMPTY) {
+    return checksum;
+  }
+
+  if (strstr(message, NMEA_GPGGA_STR) != NULL) {
+    return NMEA_GPGGA;
+  }
+
+  if (strstr(message, NMEA_GPRMC_STR) != NULL) {
+    return NMEA_GPRMC;
+  }
+
+  return NMEA_UNKNOWN;
+}
+
+/** @brief Checks Message Checksum
+ *  @author Paul Moggach
+ *  @date 25MAR2019
+ *  @param char * nmea Pointer to message
+ *  @return uint8_t Checksum
+ */
+static uint8_t legacyValidChecksum(const char *message) {
+  uint8_t checksum = (uint8_t)strtol(strchr(message, '*') + 1, NULL, 16);
+
+  char p;
+  uint8_t sum = 0;
+  ++message;
+  while ((p = *message++) != '*') {
+    sum ^= p;
+  }
+
+  if (sum != checksum) {
+    return NMEA_CHECKSUM_ERR;
+  }
+
+  return _EMPTY;
+}
+
+int main(int argc, char *argv[]) {
+  int passes = (argc > 1) ? atoi(argv[1]) : 2000;
+  std::vector<std::string> lines;
+  char buf[NMEAMSGSZ * 4];
+  size_t count = 0;
+  double sink = 0;
+  int64_t t0;
+
+  FILE *fp = fopen(GPSDATA, "r");
+  if (fp == NULL) {
+    perror(GPSDATA);
+    return 1;
+  }
+  while (fgets(buf, sizeof(buf), fp) != NULL) {
+    lines.push_back(buf);
+  }
+  fclose(fp);
+
+  // Both parsers must agree on every sentence
+  size_t mismatches = 0;
+  for (const std::string &l : lines) {
+    gpgga_t g1 = {}, g2 = {};
+    gprmc_t r1 = {}, r2 = {};
+    nmeatok_t tok;
+    strcpy(buf, l.c_str());
+    uint8_t type = legacyMessageType(buf);
+    uint8_t ntype = nmea_tokenize(l.data(), l.size(), &tok);
+    // The old parser only knew GGA and RMC
+    if (ntype != NMEA_GPGGA && ntype != NMEA_GPRMC &&
+        !(ntype & NMEA_CHECKSUM_ERR)) {
+      ntype = NMEA_UNKNOWN;
+    }
+    if (type != ntype) {
+      mismatches++;
+    } else if (type == NMEA_GPGGA) {
+      legacyParseGpgga(buf, &g1);
+      nmea_read_gpgga(&tok, &g2);
+      mismatches += (g1.utc != g2.utc || g1.latitude != g2.latitude ||
+                     g1.longitude != g2.longitude || g1.lat != g2.lat ||
+                     g1.lon != g2.lon || g1.altitude != g2.altitude ||
+                     g1.satellites != g2.satellites);
+    } else if (type == NMEA_GPRMC) {
+      legacyParseGprmc(buf, &r1);
+      nmea_read_gprmc(&tok, &r2);
+      mismatches += (r1.latitude != r2.latitude ||
+                     r1.longitude != r2.longitude || r1.speed != r2.speed ||
+                     r1.course != r2.course || r1.date != r2.date);
+    }
+  }
+
+  t0 = DlMonotonicNs();
+  for (int p = 0; p < passes; p++) {
+    for (const std::string &l : lines) {
+      gpgga_t gga;
+      gprmc_t rmc;
+      memcpy(buf, l.c_str(), l.size() + 1);
+      switch (legacyMessageType(buf)) {
+      case NMEA_GPGGA:
+        legacyParseGpgga(buf, &gga);
+        sink += gga.latitude;
+        break;
+      case NMEA_GPRMC:
+        legacyParseGprmc(buf, &rmc);
+        sink += rmc.latitude;
+        break;
+      }
+      count++;
+    }
+  }
+  double legacy = (double)(DlMonotonicNs() - t0) / 1e9;
+
+  t0 = DlMonotonicNs();
+  for (int p = 0; p < passes; p++) {
+    for (const std::string &l : lines) {
+      gpgga_t gga;
+      gprmc_t rmc;
+      nmeatok_t tok;
+      switch (nmea_tokenize(l.data(), l.size(), &tok)) {
+      case NMEA_GPGGA:
+        nmea_read_gpgga(&tok, &gga);
+        sink += gga.latitude;
+        break;
+      case NMEA_GPRMC:
+        nmea_read_gprmc(&tok, &rmc);
+        sink += rmc.latitude;
+        break;
+      }
+    }
+  }
+  double tokenizer = (double)(DlMonotonicNs() - t0) / 1e9;
+
+  // Every truncation, with and without the line end
+  size_t truncated = 0;
+  for (const std::string &l : lines) {
+    for (size_t n = 0; n <= l.size(); n++) {
+      nmeatok_t tok;
+      gpgga_t gga;
+      gprmc_t rmc;
+      nmea_tokenize(l.data(), n, &tok);
+      nmea_read_gpgga(&tok, &gga);
+      nmea_read_gprmc(&tok, &rmc);
+      truncated++;
+    }
+  }
+
+  printf("%zu sentences, %zu parser mismatches, %zu truncations survived\n",
+         lines.size(), mismatches, truncated);
+  printf("strchr/atof %12.0f sentences/s\n", count / legacy);
+  printf("tokenizer   %12.0f sentences/s  %.1fx\n", count / tokenizer,
+         legacy / tokenizer);
+  return sink == 0;
+}
@@ -0,0 +1,290 @@
+/** @file nmeascanbench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Throughput of the NMEA scanning kernels on a large capture
+ *
+ *  Usage: nmeascanbench [GiB] [file]
+ *
+ *  A synthetic capture of GiB gibibytes (default 2) is built in file
+ *  (default /tmp/nmeascan.dat) from the sentences of gpstestdata.txt, with
+ *  every digit outside the address and checksum randomized and the
+ *  checksum recomputed. An existing file of the right size is reused. The
+ *  file is mapped, and each kernel the CPU supports then classifies the
+ *  whole file and validates every sentence in it from its masks. All
+ *  kernels must find the same counts. nmea_tokenize is timed over the
+ *  same sentences last.
+ */
+
+#include "../dlclock.h"
+#include "../nmea.h"
+#include "../nmeascan.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#define GPSDATA "gpstestdata.txt"
+#define SCANFILE "/tmp/nmeascan.dat"
+#define GENCHUNK (1 << 20)
+#define MAXKERNELS 8
+
+typedef struct scancount {
+  uint64_t dollars;
+  uint64_t commas;
+  uint64_t stops;
+  uint64_t valid;
+  uint64_t invalid;
+} scancount_t;
+
+/** @brief xorshift64 generator for the synthetic digits.
+ */
+static uint64_t nextRandom(uint64_t *s) {
+  *s ^= *s << 13;
+  *s ^= *s >> 7;
+  *s ^= *s << 17;
+  return *s;
+}
+
+/** @brief Append one sentence built from a template to out.
+ */
+static void synthesize(const std::string &tmpl, uint64_t *rng,
+                       std::string *out) {
+  static const char hex[] = "0123456789ABCDEF";
+  size_t star = tmpl.find('*');
+  size_t comma = tmpl.find(',');
+  uint8_t sum = 0;
+
+  if (tmpl[0] != '$' || star == std::string::npos ||
+      comma == std::string::npos) {
+    return;
+  }
+  std::string s = tmpl.substr(0, star);
+  for (size_t i = comma; i < s.size(); i++) {
+    if (s[i] >= '0' && s[i] <= '9') {
+      s[i] = (char)('0' + nextRandom(rng) % 10);
+    }
+  }
+  for (size_t i = 1; i < s.size(); i++) {
+    sum ^= (uint8_t)s[i];
+  }
+  // One sentence in 64 gets a wrong checksum so validation has work to do
+  if (nextRandom(rng) % 64 == 0) {
+    sum ^= 0x01;
+  }
+  out->append(s);
+  out->push_back('*');
+  out->push_back(hex[sum >> 4]);
+  out->push_back(hex[sum & 0x0F]);
+  out->append("\r\n");
+}
+
+/** @brief Build the synthetic capture unless a file of that size exists.
+ */
+static int generate(const char *path, size_t size,
+                    const std::vector<std::string> &tmpl) {
+  struct stat st;
+  uint64_t rng = 0x9E3779B97F4A7C15ULL;
+  size_t written = 0;
+  size_t next = 0;
+  std::string chunk;
+
+  if (stat(path, &st) == 0 && (size_t)st.st_size == size) {
+    return 0;
+  }
+  FILE *fp = fopen(path, "w");
+  if (fp == NULL) {
+    perror(path);
+    return -1;
+  }
+  while (written < size) {
+    chunk.clear();
+    while (chunk.size() < GENCHUNK) {
+      synthesize(tmpl[next], &rng, &chunk);
+      next = (next + 1) % tmpl.size();
+    }
+    size_t n = (size - written < chunk.size()) ? size - written : chunk.size();
+    if (fwrite(chunk.data(), 1, n, fp) != n) {
+      perror(path);
+      fclose(fp);
+      return -1;
+    }
+    written += n;
+  }
+  return fclose(fp);
+}
+
+/** @brief Value of a hexadecimal checksum digit, -1 for anything else.
+ */
+static int hexval(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+/** @brief Classify the whole buffer and count the delimiters.
+ */
+static void classifyAll(const nmeakernel_t *k, const char *buf, size_t len,
+                        scancount_t *c) {
+  nmeamask_t m;
+
+  for (size_t off = 0; off < len; off += NMEA_SCANBLOCK) {
+    size_t n = (len - off < NMEA_SCANBLOCK) ? len - off : NMEA_SCANBLOCK;
+    k->classify(buf + off, n, &m);
+    c->dollars += __builtin_popcountll(m.dollar);
+    c->commas += __builtin_popcountll(m.comma);
+    c->stops += __builtin_popcountll(m.stop);
+  }
+}
+
+/** @brief Validate every sentence of the buffer from its masks.
+ *
+ *  Sentences are delimited by the '$' and stop bits of whole blocks, so a
+ *  block holding several sentences is classified once.
+ */
+static void validateAll(const nmeakernel_t *k, const char *buf, size_t len,
+                        scancount_t *c) {
+  const char *start = NULL;
+  nmeamask_t m;
+
+  for (size_t off = 0; off < len; off += NMEA_SCANBLOCK) {
+    size_t n = (len - off < NMEA_SCANBLOCK) ? len - off : NMEA_SCANBLOCK;
+    k->classify(buf + off, n, &m);
+    uint64_t events = m.dollar | m.stop;
+    while (events != 0) {
+      int i = __builtin_ctzll(events);
+      const char *p = buf + off + i;
+      events &= events - 1;
+      if (*p == '$') {
+        start = p + 1;
+        continue;
+      }
+      if (start == NULL) {
+        continue;
+      }
+      if (*p == '*' && p + 2 < buf + len) {
+        int hi = hexval(p[1]);
+        int lo = hexval(p[2]);
+        uint8_t sum = k->checksum(start, (size_t)(p - start));
+        if (hi >= 0 && lo >= 0 && ((hi << 4) | lo) == sum) {
+          c->valid++;
+        } else {
+          c->invalid++;
+        }
+      } else {
+        c->invalid++;
+      }
+      start = NULL;
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  double gib = (argc > 1) ? atof(argv[1]) : 2;
+  const char *path = (argc > 2) ? argv[2] : SCANFILE;
+  size_t size = (size_t)(gib * (1 << 30));
+  std::vector<std::string> tmpl;
+  const nmeakernel_t *kernels[MAXKERNELS];
+  scancount_t first = {};
+  char line[NMEAMSGSZ * 4];
+  bool agree = true;
+  int64_t t0;
+
+  FILE *fp = fopen(GPSDATA, "r");
+  if (fp == NULL) {
+    perror(GPSDATA);
+    return 1;
+  }
+  while (fgets(line, sizeof(line), fp) != NULL) {
+    tmpl.push_back(line);
+  }
+  fclose(fp);
+  if (tmpl.empty() || size == 0) {
+    fprintf(stderr, "nothing to scan\n");
+    return 1;
+  }
+
+  t0 = DlMonotonicNs();
+  if (generate(path, size, tmpl) < 0) {
+    return 1;
+  }
+  printf("%s: %.2f GiB ready in %.1f s\n", path, (double)size / (1 << 30),
+         (double)(DlMonotonicNs() - t0) / 1e9);
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    perror(path);
+    return 1;
+  }
+  const char *buf =
+      (const char *)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (buf == MAP_FAILED) {
+    perror("mmap");
+    return 1;
+  }
+  madvise((void *)buf, size, MADV_SEQUENTIAL);
+  // Fault the file in so the first kernel is not charged for it
+  volatile uint8_t touch = 0;
+  for (size_t i = 0; i < size; i += 4096) {
+    touch ^= (uint8_t)buf[i];
+  }
+
+  size_t nk = nmea_scan_kernels(kernels, MAXKERNELS);
+  printf("best kernel: %s\n", nmea_scan_kernel()->name);
+  printf("%-8s %12s %12s %16s\n", "kernel", "classify", "validate",
+         "sentences/s");
+  for (size_t i = 0; i < nk; i++) {
+    scancount_t c = {};
+
+    t0 = DlMonotonicNs();
+    classifyAll(kernels[i], buf, size, &c);
+    double classify = (double)(DlMonotonicNs() - t0) / 1e9;
+    t0 = DlMonotonicNs();
+    validateAll(kernels[i], buf, size, &c);
+    double validate = (double)(DlMonotonicNs() - t0) / 1e9;
+
+    printf("%-8s %9.2f GB/s %7.2f GB/s %16.0f\n", kernels[i]->name,
+           size / classify / 1e9, size / validate / 1e9,
+           (c.valid + c.invalid) / validate);
+    if (i == 0) {
+      first = c;
+    } else if (memcmp(&c, &first, sizeof(c)) != 0) {
+      agree = false;
+    }
+  }
+  printf("%llu sentences, %llu valid, %llu bad checksums, %llu fields\n",
+         (unsigned long long)(first.valid + first.invalid),
+         (unsigned long long)first.valid, (unsigned long long)first.invalid,
+         (unsigned long long)first.commas);
+  printf("kernels %s\n", agree ? "agree" : "DISAGREE");
+
+  // The tokenizer on the same sentences, one line at a time
+  uint64_t tokens = 0;
+  uint64_t good = 0;
+  const char *end = buf + size;
+  const char *p = buf;
+  t0 = DlMonotonicNs();
+  while (p < end) {
+    const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+    size_t n = (nl != NULL) ? (size_t)(nl - p) + 1 : (size_t)(end - p);
+    nmeatok_t tok;
+    good += !(nmea_tokenize(p, n, &tok) & NMEA_CHECKSUM_ERR);
+    tokens++;
+    p += n;
+  }
+  double tokenize = (double)(DlMonotonicNs() - t0) / 1e9;
+  printf("tokenizer %.2f GB/s %16.0f sentences/s, %llu valid\n",
+         size / tokenize / 1e9, tokens / tokenize, (unsigned long long)good);
+
+  munmap((void *)buf, size);
+  return agree ? 0 : 1;
+}
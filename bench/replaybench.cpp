@@ -0,0 +1,118 @@
+/** @file replaybench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Pacing accuracy and throughput of the GPS capture replay
+ *
+ *  Usage: replaybench [speed] [passes] [capture]
+ *
+ *  The capture (default gpstestdata.txt) is first replayed once at speed
+ *  times real time (default 100) and the lateness of every sentence
+ *  against its due time is reported. It is then replayed passes times
+ *  (default 1000) unthrottled. Every sentence must pass its checksum, and
+ *  the UTC of the timed sentences must keep increasing across passes.
+ */
+
+#include "../dlclock.h"
+#include "../dlreplay.h"
+#include "../nmea.h"
+#include <cstdio>
+#include <cstdlib>
+
+#define GPSDATA "gpstestdata.txt"
+#define LINESZ 256
+
+/** @brief Count lines of a capture, one pass of the replay.
+ */
+static uint64_t passLength(const char *path) {
+  dlreplay_t r;
+  char buf[LINESZ];
+  uint64_t n = 0;
+
+  if (DlReplayOpen(&r, path, DLREPLAY_FAST, 1) < 0) {
+    return 0;
+  }
+  do {
+    DlReplayNext(&r, buf, sizeof(buf));
+    n++;
+  } while (r.pos < r.len);
+  DlReplayClose(&r);
+  return n;
+}
+
+int main(int argc, char *argv[]) {
+  double speed = (argc > 1) ? atof(argv[1]) : 100;
+  long passes = (argc > 2) ? atol(argv[2]) : 1000;
+  const char *path = (argc > 3) ? argv[3] : GPSDATA;
+  char buf[LINESZ];
+  dlreplay_t r;
+
+  uint64_t perpass = passLength(path);
+  if (perpass == 0) {
+    perror(path);
+    return 1;
+  }
+
+  // Paced
+  if (DlReplayOpen(&r, path, DLREPLAY_SCALED, speed) < 0) {
+    perror(path);
+    return 1;
+  }
+  int64_t sum = 0;
+  int64_t max = 0;
+  int64_t t0 = DlMonotonicNs();
+  for (uint64_t i = 0; i < perpass; i++) {
+    DlReplayNext(&r, buf, sizeof(buf));
+    int64_t late = DlMonotonicNs() - DlReplayDue(&r);
+    sum += late;
+    max = (late > max) ? late : max;
+  }
+  double secs = (double)(DlMonotonicNs() - t0) / 1e9;
+  printf("%.0fx: %llu sentences over %.2f s of %.0f s captured, late mean "
+         "%.3f ms max %.3f ms\n",
+         r.speed, (unsigned long long)perpass, secs,
+         (double)(r.prev - r.first) / 1000, sum / (double)perpass / 1e6,
+         max / 1e6);
+  DlReplayClose(&r);
+
+  // Unthrottled, across passes
+  if (DlReplayOpen(&r, path, DLREPLAY_FAST, 1) < 0) {
+    perror(path);
+    return 1;
+  }
+  uint64_t bad = 0;
+  uint64_t backwards = 0;
+  double lastutc = -1;
+  uint64_t total = perpass * (uint64_t)passes;
+  t0 = DlMonotonicNs();
+  for (uint64_t i = 0; i < total; i++) {
+    nmeatok_t tok;
+    nmeasentence_t s;
+    int n = DlReplayNext(&r, buf, sizeof(buf));
+    nmea_tokenize(buf, (size_t)n, &tok);
+    uint8_t type = nmea_read(&tok, &s);
+    double utc = -1;
+    if (type & NMEA_CHECKSUM_ERR) {
+      bad++;
+    } else if (type == NMEA_GGA) {
+      utc = s.gga.utc;
+    } else if (type == NMEA_RMC) {
+      utc = s.rmc.utc;
+    } else if (type == NMEA_GLL) {
+      utc = s.gll.utc;
+    }
+    // A day boundary is the only way back
+    if (utc >= 0 && lastutc >= 0 && utc <= lastutc && lastutc - utc < 120000) {
+      backwards++;
+    }
+    lastutc = (utc >= 0) ? utc : lastutc;
+  }
+  secs = (double)(DlMonotonicNs() - t0) / 1e9;
+  printf("unthrottled: %llu sentences in %ld passes, %.0f sentences/s, "
+         "%.0fx real time\n",
+         (unsigned long long)total, passes, total / secs,
+         (double)r.span * passes / 1000 / secs);
+  printf("%llu bad checksums, %llu timestamps out of order\n",
+         (unsigned long long)bad, (unsigned long long)backwards);
+  DlReplayClose(&r);
+  return (bad == 0 && backwards == 0) ? 0 : 1;
+}
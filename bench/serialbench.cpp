@@ -0,0 +1,189 @@
+/** @file serialbench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Line latency and throughput of the serial reader on a pty pair
+ *
+ *  Usage: serialbench [baud] [lines]
+ *
+ *  The slave side of a pseudo-terminal is opened with serial_open and a
+ *  writer thread plays gpstestdata.txt into the master side. First the
+ *  sentences are written at 10 Hz, as a receiver would send them, and the
+ *  time from each write to serial_readline returning the line is measured,
+ *  for the byte-at-a-time reader this replaced and for serial_readline.
+ *  Then lines are written as fast as the pty takes them and every line read
+ *  back is checked. Last, an overlong line must come back truncated.
+ */
+
+#include "../dlclock.h"
+#include "../nmea.h"
+#include "../serial.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#define GPSDATA "gpstestdata.txt"
+#define LINESZ 256
+#define RATELINES 20     ///< Lines written at 10 Hz per reader
+#define RATEPERIOD 100   ///< ms between lines at 10 Hz
+
+static std::atomic<int64_t> writtenAt(0);
+
+/** @brief Write all of a buffer to the master side.
+ */
+static void writeAll(int fd, const char *p, size_t n) {
+  while (n > 0) {
+    ssize_t w = write(fd, p, n);
+    if (w < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        usleep(100);
+        continue;
+      }
+      return;
+    }
+    p += w;
+    n -= (size_t)w;
+  }
+}
+
+/** @brief The reader serial_readline replaced, one byte per read() and a
+ *  one second sleep whenever nothing is there.
+ */
+static void legacyReadln(int fd, char *buffer, int len) {
+  char c;
+  char *b = buffer;
+
+  (void)len;
+  while (true) {
+    if (read(fd, &c, 1) <= 0) {
+      sleep(1);
+    } else if (c == '\n') {
+      *b = '\0';
+      break;
+    } else {
+      *b++ = c;
+    }
+  }
+}
+
+/** @brief Write lines at 10 Hz, noting the time of each write.
+ */
+static void pacedWriter(int fd, const std::vector<std::string> *lines) {
+  for (int i = 0; i < RATELINES; i++) {
+    const std::string &l = (*lines)[i % lines->size()];
+    usleep(RATEPERIOD * 1000);
+    writtenAt.store(DlMonotonicNs());
+    writeAll(fd, l.data(), l.size());
+  }
+}
+
+/** @brief Report the latency of RATELINES paced lines.
+ */
+static void report(const char *name, const int64_t *lat) {
+  int64_t sum = 0;
+  int64_t max = 0;
+
+  for (int i = 0; i < RATELINES; i++) {
+    sum += lat[i];
+    max = (lat[i] > max) ? lat[i] : max;
+  }
+  printf("%-16s mean %10.3f ms  max %10.3f ms\n", name,
+         sum / RATELINES / 1e6, max / 1e6);
+}
+
+int main(int argc, char *argv[]) {
+  int baud = (argc > 1) ? atoi(argv[1]) : 921600;
+  long total = (argc > 2) ? atol(argv[2]) : 1000000;
+  std::vector<std::string> lines;
+  char buf[LINESZ];
+  int64_t lat[RATELINES];
+  serial_t port;
+
+  FILE *fp = fopen(GPSDATA, "r");
+  if (fp == NULL) {
+    perror(GPSDATA);
+    return 1;
+  }
+  while (fgets(buf, sizeof(buf), fp) != NULL) {
+    lines.push_back(buf);
+  }
+  fclose(fp);
+
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) < 0 || unlockpt(master) < 0) {
+    perror("posix_openpt");
+    return 1;
+  }
+  if (serial_open(&port, ptsname(master), baud) < 0) {
+    perror(ptsname(master));
+    return 1;
+  }
+  printf("%s at %d baud\n", ptsname(master), baud);
+
+  // 10 Hz latency, byte-at-a-time reader
+  std::thread w(pacedWriter, master, &lines);
+  for (int i = 0; i < RATELINES; i++) {
+    legacyReadln(port.fd, buf, sizeof(buf));
+    lat[i] = DlMonotonicNs() - writtenAt.load();
+  }
+  w.join();
+  report("read()+sleep(1)", lat);
+
+  // 10 Hz latency, poll and ring
+  w = std::thread(pacedWriter, master, &lines);
+  for (int i = 0; i < RATELINES; i++) {
+    serial_readline(&port, buf, sizeof(buf), SERIAL_FOREVER);
+    lat[i] = DlMonotonicNs() - writtenAt.load();
+  }
+  w.join();
+  report("serial_readline", lat);
+
+  // Unthrottled
+  long got = 0;
+  long bad = 0;
+  size_t bytes = 0;
+  w = std::thread([&]() {
+    for (long i = 0; i < total; i++) {
+      const std::string &l = lines[i % lines.size()];
+      writeAll(master, l.data(), l.size());
+    }
+  });
+  int64_t t0 = DlMonotonicNs();
+  while (got < total) {
+    nmeatok_t tok;
+    int n = serial_readline(&port, buf, sizeof(buf), 2000);
+    if (n <= 0) {
+      break;
+    }
+    bytes += (size_t)n + 1;
+    bad += (nmea_tokenize(buf, (size_t)n, &tok) & NMEA_CHECKSUM_ERR) != 0;
+    got++;
+  }
+  double secs = (double)(DlMonotonicNs() - t0) / 1e9;
+  w.join();
+  printf("%ld of %ld lines, %ld bad, %.0f lines/s, %.1f MB/s\n", got, total,
+         bad, got / secs, bytes / secs / 1e6);
+
+  // Overlong line
+  std::string longline(3 * LINESZ, 'x');
+  longline += "\n";
+  writeAll(master, longline.data(), longline.size());
+  writeAll(master, lines[0].data(), lines[0].size());
+  int n1 = serial_readline(&port, buf, sizeof(buf), 1000);
+  int n2 = serial_readline(&port, buf, sizeof(buf), 1000);
+  printf("overlong line: %d bytes kept, next line %s, %llu truncated, "
+         "%llu dropped\n",
+         n1, (n2 > 0 && buf[0] == '$') ? "intact" : "LOST",
+         (unsigned long long)port.truncated,
+         (unsigned long long)port.dropped);
+
+  serial_shut(&port);
+  close(master);
+  return (got == total && bad == 0) ? 0 : 1;
+}
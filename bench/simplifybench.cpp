@@ -0,0 +1,138 @@
+/** @file simplifybench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Reduction and cost of the streaming track simplifier
+ *
+ *  Usage: simplifybench [tol] [vtol] [seconds]
+ *
+ *  Three drives of seconds (default 3600) at one fix a second, with 1.5 m
+ *  of noise across the ground and 3 m in altitude, are simplified with an
+ *  error of tol metres across the ground (default TRACKTOL) and vtol in
+ *  altitude (default TRACKVTOL): highway at 100 km/h on long curves over
+ *  rolling hills, city blocks at 40 km/h with turns and stops, and a unit
+ *  standing still. Every fix is checked against the segment of the kept
+ *  track that replaces it, and the time per fix is reported.
+ */
+
+#include "../dlclock.h"
+#include "../dlsimplify.h"
+#include "../logger.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#define LAT0 437289000 ///< Start, 1e-7 degrees
+#define LON0 (-796074000)
+#define RAD (M_PI / 180)
+
+enum drive { HIGHWAY, CITY, PARKED };
+
+/** @brief Generate one drive of noisy fixes.
+ */
+static void makeDrive(int kind, int seconds, std::vector<dltrackpt_t> *out) {
+  std::mt19937 rng(20 + kind);
+  std::normal_distribution<double> gauss(0, 1);
+  double mlon7 = DLSIMP_MLAT7 * cos(LAT0 / 1e7 * RAD);
+  double n = 0, e = 0, psi = 0.3, alt = 166;
+
+  for (int k = 0; k < seconds; k++) {
+    double v = 0;
+    if (kind == HIGHWAY) {
+      v = 100 / 3.6;
+      psi += 0.004 * sin(2 * M_PI * k / 900);
+      alt = 166 + 20 * sin(2 * M_PI * k / 600);
+    } else if (kind == CITY) {
+      // A block every 20 s, a right or left turn every fourth, a red light
+      // for 30 s every 3 minutes
+      int phase = k % 180;
+      v = (phase < 30) ? 0 : 40 / 3.6;
+      if (k % 80 == 79) {
+        psi += ((k / 80) % 3 == 0 ? -1 : 1) * M_PI / 2;
+      }
+      alt = 166 + 3 * sin(2 * M_PI * k / 1200);
+    }
+    n += v * cos(psi);
+    e += v * sin(psi);
+    dltrackpt_t p;
+    p.lat = LAT0 + (int32_t)lround((n + 1.5 * gauss(rng)) / DLSIMP_MLAT7);
+    p.lon = LON0 + (int32_t)lround((e + 1.5 * gauss(rng)) / mlon7);
+    p.alt = (float)(alt + 3 * gauss(rng));
+    p.tag = (uint32_t)k;
+    out->push_back(p);
+  }
+}
+
+/** @brief Largest error of the fixes between two vertices, across the
+ *  ground and in altitude.
+ */
+static void segError(const std::vector<dltrackpt_t> &pts, uint32_t i,
+                     uint32_t j, double *h, double *v) {
+  const dltrackpt_t &a = pts[i];
+  const dltrackpt_t &b = pts[j];
+  double mlon7 = DLSIMP_MLAT7 * cos(a.lat / 1e7 * RAD);
+  double dx = ((int64_t)b.lon - a.lon) * mlon7;
+  double dy = ((int64_t)b.lat - a.lat) * DLSIMP_MLAT7;
+  double len = dx * dx + dy * dy;
+
+  for (uint32_t k = i + 1; k < j; k++) {
+    double qx = ((int64_t)pts[k].lon - a.lon) * mlon7;
+    double qy = ((int64_t)pts[k].lat - a.lat) * DLSIMP_MLAT7;
+    double t = (len > 0) ? (qx * dx + qy * dy) / len : 0;
+    t = (t < 0) ? 0 : (t > 1) ? 1 : t;
+    double eh = hypot(qx - t * dx, qy - t * dy);
+    double ev = fabs(pts[k].alt - (a.alt + t * (b.alt - a.alt)));
+    *h = (eh > *h) ? eh : *h;
+    *v = (ev > *v) ? ev : *v;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  double tol = (argc > 1) ? atof(argv[1]) : TRACKTOL;
+  double vtol = (argc > 2) ? atof(argv[2]) : TRACKVTOL;
+  int seconds = (argc > 3) ? atoi(argv[3]) : 3600;
+  const char *names[] = {"highway", "city", "parked"};
+  int bad = 0;
+
+  printf("error %.1f m across, %.1f m in altitude, window %d, state %zu "
+         "bytes\n",
+         tol, vtol, DLSIMP_WINDOW, sizeof(dlsimplify_t));
+  for (int kind = HIGHWAY; kind <= PARKED; kind++) {
+    std::vector<dltrackpt_t> pts;
+    std::vector<uint32_t> kept;
+    dlsimplify_t s;
+    dltrackpt_t vertex;
+    int64_t ns = 0, worst = 0;
+
+    makeDrive(kind, seconds, &pts);
+    DlSimplifyInit(&s, tol, vtol);
+    for (const dltrackpt_t &p : pts) {
+      int64_t t0 = DlMonotonicNs();
+      int got = DlSimplifyPush(&s, &p, &vertex);
+      int64_t dt = DlMonotonicNs() - t0;
+      ns += dt;
+      worst = (dt > worst) ? dt : worst;
+      if (got) {
+        kept.push_back(vertex.tag);
+      }
+    }
+    if (DlSimplifyFlush(&s, &vertex)) {
+      kept.push_back(vertex.tag);
+    }
+
+    double h = 0, v = 0;
+    for (size_t k = 1; k < kept.size(); k++) {
+      segError(pts, kept[k - 1], kept[k], &h, &v);
+    }
+    bad += h > tol + 1e-6 || v > vtol + 1e-6 || kept.back() != pts.back().tag;
+    printf("%-8s %6zu fixes -> %5zu kept, %5.1fx fewer, worst error %.2f m "
+           "across %.2f m up\n",
+           names[kind], pts.size(), kept.size(),
+           (double)pts.size() / kept.size(), h, v);
+    printf("         %6.0f ns/fix mean, %6lld ns max\n",
+           (double)ns / pts.size(), (long long)worst);
+  }
+  printf("%s\n", bad ? "ERROR BOUND EXCEEDED" : "all fixes within the bound");
+  return bad;
+}
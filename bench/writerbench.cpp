@@ -0,0 +1,245 @@
+/** @file writerbench.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Compare the buffered log writer with the per-record CSV path
+ *
+ *  Usage: writerbench [records] [never|batch|interval]
+ *
+ *  Both paths write into a fresh directory under the current one, so run it
+ *  from the filesystem you want to measure (the SD card on a unit).
+ */
+
+#include "../dlclock.h"
+#include "../dlwriter.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <string>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+/** @brief The JSON payload, formatted the way DlSaveLoggerData does.
+ */
+static int formatJson(char *jsondata, const reading_s &creads) {
+  return sprintf(
+      jsondata,
+      "{\n\t\"temperature\":%-3.1f,\n\t\"humidity\":%-3.0f,"
+      "\n\t\"pressure\":%-3.1f,\n\t\"xa\":%-f,\n\t\"ya\":%-f,\n\t\"za\":%-"
+      "f,\n\t\"pitch\":%-f,\n\t\"roll\":%-f,\n\t\"yaw\":%-f,\n\t\"xm\":%-"
+      "f,\n\t\"ym\":%-f,\n\t\"zm\":%-f,\n\t\"latitude\":%-f,"
+      "\n\t\"longitude\":%-f,\n\t\"altitude\":%-f,\n\t\"speed\":%-f,"
+      "\n\t\"heading\":%-f,\n\t\"active\": true\n}",
+      creads.temperature, creads.humidity, creads.pressure, creads.xa,
+      creads.ya, creads.za, creads.pitch, creads.roll, creads.yaw, creads.xm,
+      creads.ym, creads.zm, creads.latitude / 1e7, creads.longitude / 1e7,
+      creads.altitude, creads.speed, creads.heading);
+}
+
+/** @brief The original save path: reopen, format and close per record.
+ */
+static int legacySave(const reading_s &creads) {
+  FILE *fp;
+  char ltime[TIMESTRSZ];
+  char jsondata[PAYLOADSTRSZ];
+  int commaIndex[] = {3, 7, 10, 19};
+
+  fp = fopen("loggerdata.csv", "a");
+  if (fp == NULL) {
+    return 0;
+  }
+  strcpy(ltime, ctime(&creads.rtime));
+  for (int i : commaIndex) {
+    ltime[i] = ',';
+  }
+  fprintf(fp,
+          "%.24s,%3.1f,%3.0f,%3.1f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",
+          ltime, creads.temperature, creads.humidity, creads.pressure,
+          creads.xa, creads.ya, creads.za, creads.pitch, creads.roll,
+          creads.yaw, creads.xm, creads.ym, creads.zm, creads.latitude / 1e7,
+          creads.longitude / 1e7, creads.altitude, creads.speed,
+          creads.heading);
+  fclose(fp);
+
+  formatJson(jsondata, creads);
+  fp = fopen("loggerdata.json", "w");
+  if (fp == NULL) {
+    return -1;
+  }
+  fputs(jsondata, fp);
+  fclose(fp);
+  return 1;
+}
+
+/** @brief Buffered writer path. The live state goes to shared memory, so
+ *  there is no JSON file to rewrite.
+ */
+static int writerSave(dlwriter_t *w, const reading_s &creads) {
+  dlrecord_t rec;
+
+  DlLogPack(&creads, &rec);
+  return DlWriterAppend(w, &rec) < 0 ? 0 : 1;
+}
+
+/** @brief A plausible reading that changes every call.
+ */
+static reading_s sample(int i) {
+  reading_s r{0};
+  r.rtime = 1646000000 + i;
+  r.temperature = 24.6 + (i % 10) * 0.1;
+  r.humidity = 32;
+  r.pressure = 101.3;
+  r.xa = 0.01 * (i % 7);
+  r.ya = -0.02;
+  r.za = 0.98;
+  r.latitude = DLAT;
+  r.longitude = DLONG;
+  r.altitude = 166;
+  r.speed = 99;
+  r.heading = 320;
+  return r;
+}
+
+/** @brief Remove a directory and the files in it.
+ */
+static void removeDir(const char *dir) {
+  DIR *d = opendir(dir);
+  struct dirent *de;
+
+  if (d == NULL) {
+    return;
+  }
+  while ((de = readdir(d)) != NULL) {
+    if (de->d_name[0] != '.') {
+      std::string path = std::string(dir) + "/" + de->d_name;
+      unlink(path.c_str());
+    }
+  }
+  closedir(d);
+  rmdir(dir);
+}
+
+/** @brief Fail flushes by taking the log directory away mid-batch.
+ *
+ *  The batch that fails is half written, across a rotation, before the next
+ *  segment cannot be created. Appends that follow find the batch still full
+ *  and are dropped. Once the directory is back, the rest of that batch must
+ *  be written exactly once.
+ *  @return 0 if the writer recovered as expected, -1 otherwise
+ */
+static int flushFailure(void) {
+  dlwriter_cfg_t cfg = {8, 0, 60000, DLW_FSYNC_NEVER, 0,
+                        sizeof(dlseghdr_t) + 20 * sizeof(dlrecord_t)};
+  const char *dir = "fail";
+  dlwriter_t *w = new dlwriter_t;
+  size_t maxcount = 0;
+  int failed = 0;
+  int i = 0;
+
+  mkdir(dir, 0755);
+  if (DlWriterOpen(w, dir, 0, &cfg) < 0) {
+    perror("DlWriterOpen");
+    delete w;
+    return -1;
+  }
+  for (; i < 48; i++) {
+    dlrecord_t rec;
+    reading_s r = sample(i);
+    if (i == 16) {
+      removeDir(dir); // records 16-19 fit the open segment, 20 rotates
+    } else if (i == 40) {
+      mkdir(dir, 0755);
+    }
+    DlLogPack(&r, &rec);
+    failed += (DlWriterAppend(w, &rec) < 0);
+    maxcount = std::max(maxcount, w->count);
+  }
+  DlWriterClose(w);
+
+  // Expect 20-23 from the failed batch, then 40-47
+  std::vector<int64_t> times;
+  for (const dlsegent_t &e : DlSegList(dir)) {
+    dlsegmap_t m;
+    if (DlSegMap(&m, e.path) < 0) {
+      continue;
+    }
+    for (size_t k = 0; k < m.nrecs; k++) {
+      reading_s r;
+      DlSegRead(&m, k, &r);
+      times.push_back(r.rtime - sample(0).rtime);
+    }
+    DlSegUnmap(&m);
+  }
+  std::vector<int64_t> want = {20, 21, 22, 23, 40, 41, 42, 43, 44, 45, 46, 47};
+  printf("flush failure: %d appends failed, %llu dropped, batch peak %zu, "
+         "%zu records after recovery (%s)\n",
+         failed, (unsigned long long)w->dropped, maxcount, times.size(),
+         times == want ? "as expected" : "WRONG");
+  int ok = (times == want && w->dropped == 16 && maxcount <= cfg.maxrecs);
+  delete w;
+  return ok ? 0 : -1;
+}
+
+/** @brief Print throughput and latency percentiles.
+ */
+static void report(const char *name, std::vector<int64_t> &lat,
+                   int64_t total) {
+  std::sort(lat.begin(), lat.end());
+  size_t n = lat.size();
+  printf("%-18s %10.0f rec/s  p50 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+         name, n * 1e9 / total, lat[n / 2] / 1e3, lat[n * 99 / 100] / 1e3,
+         lat[n - 1] / 1e3);
+}
+
+int main(int argc, char *argv[]) {
+  int records = (argc > 1) ? atoi(argv[1]) : 20000;
+  const char *policy = (argc > 2) ? argv[2] : "interval";
+  dlwriter_cfg_t cfg = {64, 0, 1000, DLW_FSYNC_INTERVAL, 1000, 16 << 20};
+  char dir[] = "writerbench.XXXXXX";
+  std::vector<int64_t> lat(records);
+
+  if (strcmp(policy, "never") == 0) {
+    cfg.fsyncpolicy = DLW_FSYNC_NEVER;
+  } else if (strcmp(policy, "batch") == 0) {
+    cfg.fsyncpolicy = DLW_FSYNC_BATCH;
+  }
+  if (mkdtemp(dir) == NULL || chdir(dir) < 0) {
+    perror("writerbench");
+    return 1;
+  }
+
+  int64_t t0 = DlMonotonicNs();
+  for (int i = 0; i < records; i++) {
+    reading_s r = sample(i);
+    int64_t s = DlMonotonicNs();
+    legacySave(r);
+    lat[i] = DlMonotonicNs() - s;
+  }
+  report("fopen/fprintf", lat, DlMonotonicNs() - t0);
+
+  dlwriter_t *w = new dlwriter_t;
+  if (DlWriterOpen(w, ".", 0, &cfg) < 0) {
+    perror("DlWriterOpen");
+    return 1;
+  }
+  t0 = DlMonotonicNs();
+  for (int i = 0; i < records; i++) {
+    reading_s r = sample(i);
+    int64_t s = DlMonotonicNs();
+    writerSave(w, r);
+    lat[i] = DlMonotonicNs() - s;
+  }
+  DlWriterClose(w);
+  std::string name = std::string("writer/") + policy;
+  report(name.c_str(), lat, DlMonotonicNs() - t0);
+  printf("%llu batches, %llu fdatasync\n", (unsigned long long)w->flushes,
+         (unsigned long long)w->syncs);
+  delete w;
+
+  int rc = (flushFailure() < 0) ? 1 : 0;
+  printf("output left in %s\n", dir);
+  return rc;
+}
@@ -0,0 +1,81 @@
+/** @file dlclock.cpp
+ *  @brief Monotonic to wall clock mapping functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlclock.h"
+#include <atomic>
+
+static std::atomic<int64_t> gpsOffset(0);
+static std::atomic<int> source(DLCLK_SYSTEM);
+static int64_t estimates[DLCLK_WINDOW]; ///< Written by the GPS thread only
+static unsigned nestimates;
+
+/** @brief Wall clock minus CLOCK_MONOTONIC.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return offset in ns
+ */
+int64_t DlClockOffset(void) {
+  if (source.load(std::memory_order_acquire) == DLCLK_GPS) {
+    return gpsOffset.load(std::memory_order_relaxed);
+  }
+  return DlClockNs(CLOCK_REALTIME) - DlMonotonicNs();
+}
+
+/** @brief Wall clock time of a monotonic stamp.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param mono CLOCK_MONOTONIC ns
+ *  @return ns since the epoch
+ */
+int64_t DlClockWallNs(int64_t mono) { return mono + DlClockOffset(); }
+
+/** @brief Where the offset currently comes from.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return DLCLK_SYSTEM or DLCLK_GPS
+ */
+int DlClockSource(void) { return source.load(std::memory_order_relaxed); }
+
+/** @brief Refine the offset with a GPS fix (GPS thread only).
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param utc NMEA time of the fix, hhmmss.sss
+ *  @param date NMEA date of the fix, ddmmyy
+ *  @param mono CLOCK_MONOTONIC ns when the fix was read
+ *  @return 0 if the offset was updated, -1 if the fix has no valid time
+ */
+int DlClockGpsFix(double utc, double date, int64_t mono) {
+  struct tm tm = {};
+  long d = (long)date;
+  long hms = (long)utc;
+
+  if (d <= 0 || utc < 0) {
+    return -1;
+  }
+  tm.tm_mday = d / 10000;
+  tm.tm_mon = (d / 100) % 100 - 1;
+  tm.tm_year = d % 100 + 100;
+  tm.tm_hour = hms / 10000;
+  tm.tm_min = (hms / 100) % 100;
+  tm.tm_sec = hms % 100;
+  if (tm.tm_mday < 1 || tm.tm_mday > 31 || tm.tm_mon < 0 || tm.tm_mon > 11 ||
+      tm.tm_hour > 23 || tm.tm_min > 59 || tm.tm_sec > 60) {
+    return -1;
+  }
+  int64_t ns = (int64_t)timegm(&tm) * 1000000000 +
+               (int64_t)((utc - hms) * 1e9 + 0.5);
+
+  estimates[nestimates++ % DLCLK_WINDOW] = ns - mono;
+  unsigned n = (nestimates < DLCLK_WINDOW) ? nestimates : DLCLK_WINDOW;
+  int64_t best = estimates[0];
+  for (unsigned i = 1; i < n; i++) {
+    if (estimates[i] > best) {
+      best = estimates[i];
+    }
+  }
+  gpsOffset.store(best, std::memory_order_relaxed);
+  source.store(DLCLK_GPS, std::memory_order_release);
+  return 0;
+}
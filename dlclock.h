@@ -0,0 +1,53 @@
+#ifndef DLCLOCK_H
+#define DLCLOCK_H
+/** @file dlclock.h
+ *  @brief Session mapping from CLOCK_MONOTONIC to wall clock time.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  Samples are stamped with CLOCK_MONOTONIC nanoseconds at capture. The
+ *  wall clock time of a stamp is the stamp plus an offset. Until the GPS
+ *  reports a valid date and time the offset follows the system clock.
+ *  After that each fix gives an estimate of UTC minus the time the fix was
+ *  read. Reading can only make a fix look late, so the largest estimate of
+ *  the last DLCLK_WINDOW fixes is the one used.
+ *
+ *  The clock readers are inline here, with no other dependency, so every
+ *  module and benchmark stamps time the same way without linking this one.
+ */
+#include <cstdint>
+#include <time.h>
+
+#define DLCLK_WINDOW 16
+
+// Offset sources
+#define DLCLK_SYSTEM 0 ///< CLOCK_REALTIME
+#define DLCLK_GPS 1    ///< GPS UTC
+
+/** @brief A clock in nanoseconds.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param id clock to read
+ *  @return time in ns
+ */
+inline int64_t DlClockNs(clockid_t id) {
+  struct timespec ts;
+  clock_gettime(id, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/** @brief Monotonic clock in nanoseconds.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return CLOCK_MONOTONIC time in nanoseconds
+ */
+inline int64_t DlMonotonicNs(void) { return DlClockNs(CLOCK_MONOTONIC); }
+
+///\cond INTERNAL
+// Function Prototypes
+int64_t DlClockOffset(void);
+int64_t DlClockWallNs(int64_t);
+int DlClockSource(void);
+int DlClockGpsFix(double, double, int64_t);
+///\endcond
+#endif
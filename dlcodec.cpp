@@ -0,0 +1,358 @@
+/** @file dlcodec.cpp
+ *  @brief Delta/XOR time-series codec functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlcodec.h"
+#include <cstring>
+
+#define NOWINDOW 0xFF ///< lead value before a channel has an XOR window
+
+typedef struct bitreader {
+  const uint8_t *p; ///< Payload
+  uint64_t pos;     ///< Next bit
+  uint64_t end;     ///< Payload size in bits
+} bitreader_t;
+
+/** @brief Append the low n bits of v to the block, most significant first.
+ */
+static void putBits(dlencoder_t *e, uint64_t v, int n) {
+  uint8_t *p = e->buf + sizeof(dlblkhdr_t);
+
+  while (n > 0) {
+    int room = 8 - (int)(e->bits & 7);
+    int take = (n < room) ? n : room;
+    uint8_t chunk = (uint8_t)((v >> (n - take)) & ((1u << take) - 1));
+    if (room == 8) {
+      p[e->bits >> 3] = 0;
+    }
+    p[e->bits >> 3] |= (uint8_t)(chunk << (room - take));
+    e->bits += take;
+    n -= take;
+  }
+}
+
+/** @brief Read n bits, most significant first.
+ *  @return 0 on success, -1 past the end of the block
+ */
+static int getBits(bitreader_t *r, int n, uint64_t *v) {
+  uint64_t out = 0;
+
+  if (r->pos + n > r->end) {
+    return -1;
+  }
+  while (n > 0) {
+    int room = 8 - (int)(r->pos & 7);
+    int take = (n < room) ? n : room;
+    uint8_t byte = r->p[r->pos >> 3];
+    out = (out << take) | ((byte >> (room - take)) & ((1u << take) - 1));
+    r->pos += take;
+    n -= take;
+  }
+  *v = out;
+  return 0;
+}
+
+/** @brief Read one bit.
+ *  @return 0 or 1, -1 past the end of the block
+ */
+static int getBit(bitreader_t *r) {
+  if (r->pos >= r->end) {
+    return -1;
+  }
+  int bit = (r->p[r->pos >> 3] >> (7 - (r->pos & 7))) & 1;
+  r->pos++;
+  return bit;
+}
+
+/** @brief Bit pattern of channel i, a float or a scaled integer.
+ */
+static uint32_t channelBits(const reading_s *r, size_t i) {
+  const dlfmtfield_t &f = dlReadingFields[i];
+  uint32_t u;
+
+  if (f.value == nullptr) {
+    return (uint32_t)(r->*f.fixed);
+  }
+  memcpy(&u, &(r->*f.value), sizeof(u));
+  return u;
+}
+
+/** @brief Store the bit pattern of channel i.
+ */
+static void setChannel(reading_s *r, size_t i, uint32_t u) {
+  const dlfmtfield_t &f = dlReadingFields[i];
+
+  if (f.value == nullptr) {
+    r->*f.fixed = (int32_t)u;
+  } else {
+    memcpy(&(r->*f.value), &u, sizeof(u));
+  }
+}
+
+/** @brief Encode a signed value so small magnitudes have few bits.
+ */
+static uint64_t zigzag(int64_t v) {
+  return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+/** @brief Inverse of zigzag.
+ */
+static int64_t unzigzag(uint64_t v) {
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/** @brief Time number i of a reading, rtime first.
+ */
+static int64_t timeOf(const reading_s *r, size_t i) {
+  return (i == 0) ? (int64_t)r->rtime : r->*dlReadingStamps[i - 1].value;
+}
+
+/** @brief Set time number i of a reading, rtime first.
+ */
+static void setTime(reading_s *r, size_t i, int64_t v) {
+  if (i == 0) {
+    r->rtime = (time_t)v;
+  } else {
+    r->*dlReadingStamps[i - 1].value = v;
+  }
+}
+
+/** @brief Append the delta-of-delta of one time.
+ */
+static void putTime(dlencoder_t *e, size_t i, int64_t t) {
+  int64_t delta = t - e->t[i];
+  uint64_t z = zigzag(delta - e->delta[i]);
+
+  if (z == 0) {
+    putBits(e, 0, 1);
+  } else if (z < (1u << 7)) {
+    putBits(e, 0x2, 2);
+    putBits(e, z, 7);
+  } else if (z < (1u << 9)) {
+    putBits(e, 0x6, 3);
+    putBits(e, z, 9);
+  } else if (z < (1u << 12)) {
+    putBits(e, 0xE, 4);
+    putBits(e, z, 12);
+  } else {
+    putBits(e, 0xF, 4);
+    putBits(e, z, 64);
+  }
+  e->t[i] = t;
+  e->delta[i] = delta;
+}
+
+/** @brief Read the delta-of-delta of one time.
+ *  @return 0 on success, -1 past the end of the block
+ */
+static int getTime(bitreader_t *r, int64_t *t, int64_t *delta) {
+  static const int widths[] = {0, 7, 9, 12, 64};
+  int ones = 0;
+  int bit = 0;
+  uint64_t v = 0;
+
+  // Count the prefix ones, at most four
+  while (ones < 4 && (bit = getBit(r)) == 1) {
+    ones++;
+  }
+  if (bit < 0 || (ones > 0 && getBits(r, widths[ones], &v) < 0)) {
+    return -1;
+  }
+  *delta += unzigzag(v);
+  *t += *delta;
+  return 0;
+}
+
+/** @brief Clear the encoder for a new block.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param e encoder
+ *  @return void
+ */
+void DlEncInit(dlencoder_t *e) {
+  e->bits = 0;
+  e->count = 0;
+  e->first = 0;
+  memset(e->t, 0, sizeof(e->t));
+  memset(e->delta, 0, sizeof(e->delta));
+  memset(e->prev, 0, sizeof(e->prev));
+  memset(e->lead, NOWINDOW, sizeof(e->lead));
+  memset(e->trail, 0, sizeof(e->trail));
+}
+
+/** @brief Add one reading to the current block.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param e encoder
+ *  @param r reading
+ *  @return 1 if the block is now full, 0 if it has room, -1 if the block
+ *  was already full and the reading was not added
+ */
+int DlEncAppend(dlencoder_t *e, const reading_s *r) {
+  int64_t t = (int64_t)r->rtime;
+
+  if (e->count >= DLC_BLOCKRECS) {
+    return -1;
+  }
+  if (e->count == 0) {
+    for (size_t i = 0; i < DLC_NTIMES; i++) {
+      e->t[i] = timeOf(r, i);
+      putBits(e, (uint64_t)e->t[i], 64);
+    }
+    for (size_t i = 0; i < DLFMT_NFIELDS; i++) {
+      e->prev[i] = channelBits(r, i);
+      putBits(e, e->prev[i], 32);
+    }
+    e->first = t;
+    e->count = 1;
+    return 0;
+  }
+
+  for (size_t i = 0; i < DLC_NTIMES; i++) {
+    putTime(e, i, timeOf(r, i));
+  }
+  for (size_t i = 0; i < DLFMT_NFIELDS; i++) {
+    uint32_t v = channelBits(r, i);
+    uint32_t x = v ^ e->prev[i];
+    e->prev[i] = v;
+    if (x == 0) {
+      putBits(e, 0, 1);
+      continue;
+    }
+    int lz = __builtin_clz(x);
+    int tz = __builtin_ctz(x);
+    if (e->lead[i] != NOWINDOW && lz >= e->lead[i] && tz >= e->trail[i]) {
+      putBits(e, 0x2, 2);
+      putBits(e, x >> e->trail[i], 32 - e->lead[i] - e->trail[i]);
+    } else {
+      int len = 32 - lz - tz;
+      putBits(e, 0x3, 2);
+      putBits(e, lz, 5);
+      putBits(e, len, 6);
+      putBits(e, x >> tz, len);
+      e->lead[i] = (uint8_t)lz;
+      e->trail[i] = (uint8_t)tz;
+    }
+  }
+  e->count++;
+  return (e->count >= DLC_BLOCKRECS) ? 1 : 0;
+}
+
+/** @brief Close the current block and start a new one.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param e encoder
+ *  @param out set to the finished block, valid until the next append
+ *  @return size of the block in bytes, 0 if it held no samples
+ */
+size_t DlEncBlock(dlencoder_t *e, const uint8_t **out) {
+  dlblkhdr_t hdr;
+
+  if (e->count == 0) {
+    return 0;
+  }
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic = DLC_MAGIC;
+  hdr.count = e->count;
+  hdr.nfields = DLFMT_NFIELDS;
+  hdr.bytes = (uint32_t)(sizeof(hdr) + (e->bits + 7) / 8);
+  hdr.first = e->first;
+  hdr.ntimes = DLC_NTIMES;
+  hdr.last = e->t[0];
+  memcpy(e->buf, &hdr, sizeof(hdr));
+  *out = e->buf;
+  DlEncInit(e);
+  return hdr.bytes;
+}
+
+/** @brief Decode one block.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param blk block, starting with its dlblkhdr_t
+ *  @param len bytes available at blk
+ *  @param out output readings
+ *  @param max capacity of out
+ *  @return number of readings decoded, -1 if the block is corrupt or does
+ *  not fit in out
+ */
+int DlDecBlock(const uint8_t *blk, size_t len, reading_s *out, size_t max) {
+  dlblkhdr_t hdr;
+  bitreader_t r;
+  uint32_t prev[DLFMT_NFIELDS];
+  uint8_t lead[DLFMT_NFIELDS];
+  uint8_t trail[DLFMT_NFIELDS];
+  int64_t t[DLC_NTIMES];
+  int64_t delta[DLC_NTIMES];
+  uint64_t v;
+  int bit;
+
+  if (len < sizeof(hdr)) {
+    return -1;
+  }
+  memcpy(&hdr, blk, sizeof(hdr));
+  if (hdr.magic != DLC_MAGIC || hdr.nfields != DLFMT_NFIELDS ||
+      hdr.ntimes != DLC_NTIMES ||
+      hdr.bytes > len || hdr.bytes < sizeof(hdr) || hdr.count > max) {
+    return -1;
+  }
+  r.p = blk + sizeof(hdr);
+  r.pos = 0;
+  r.end = (uint64_t)(hdr.bytes - sizeof(hdr)) * 8;
+
+  for (int n = 0; n < hdr.count; n++) {
+    reading_s *o = &out[n];
+    memset(o, 0, sizeof(*o));
+    if (n == 0) {
+      for (size_t i = 0; i < DLC_NTIMES; i++) {
+        if (getBits(&r, 64, &v) < 0) {
+          return -1;
+        }
+        t[i] = (int64_t)v;
+        delta[i] = 0;
+        setTime(o, i, t[i]);
+      }
+      for (size_t i = 0; i < DLFMT_NFIELDS; i++) {
+        if (getBits(&r, 32, &v) < 0) {
+          return -1;
+        }
+        prev[i] = (uint32_t)v;
+        lead[i] = NOWINDOW;
+        setChannel(o, i, prev[i]);
+      }
+      continue;
+    }
+
+    for (size_t i = 0; i < DLC_NTIMES; i++) {
+      if (getTime(&r, &t[i], &delta[i]) < 0) {
+        return -1;
+      }
+      setTime(o, i, t[i]);
+    }
+
+    for (size_t i = 0; i < DLFMT_NFIELDS; i++) {
+      if ((bit = getBit(&r)) <= 0) {
+        if (bit < 0) {
+          return -1;
+        }
+      } else if ((bit = getBit(&r)) == 0) {
+        if (lead[i] == NOWINDOW ||
+            getBits(&r, 32 - lead[i] - trail[i], &v) < 0) {
+          return -1;
+        }
+        prev[i] ^= (uint32_t)v << trail[i];
+      } else {
+        uint64_t lz, bits;
+        if (bit < 0 || getBits(&r, 5, &lz) < 0 || getBits(&r, 6, &bits) < 0 ||
+            bits == 0 || lz + bits > 32 || getBits(&r, (int)bits, &v) < 0) {
+          return -1;
+        }
+        lead[i] = (uint8_t)lz;
+        trail[i] = (uint8_t)(32 - lz - bits);
+        prev[i] ^= (uint32_t)v << trail[i];
+      }
+      setChannel(o, i, prev[i]);
+    }
+  }
+  return hdr.count;
+}
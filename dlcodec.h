@@ -0,0 +1,60 @@
+#ifndef DLCODEC_H
+#define DLCODEC_H
+/** @file dlcodec.h
+ *  @brief Streaming delta/XOR time-series codec for reading_s.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  Readings are packed into blocks of at most DLC_BLOCKRECS samples. In a
+ *  block the first sample is stored whole. rtime and every stamp of
+ *  dlReadingStamps are then encoded as a delta-of-delta with variable
+ *  length prefixes. Every channel of dlReadingFields is XORed with its
+ *  previous value and only the meaningful bits are kept, as in Facebook's
+ *  Gorilla. Each block starts with a dlblkhdr_t holding the sample count
+ *  and time range, so a reader can skip to any block and decode it on its
+ *  own.
+ */
+#include "dlformat.h"
+#include "logger.h"
+#include <cstddef>
+#include <cstdint>
+
+#define DLC_MAGIC 0x4B4C4244 // "DBLK"
+#define DLC_BLOCKRECS 256
+#define DLC_NTIMES (1 + DLFMT_NSTAMPS) ///< rtime and the capture stamps
+/// Worst case bits of one sample: 68 bits per time and 45 per channel
+#define DLC_SAMPLEBITS (68 * DLC_NTIMES + 45 * DLFMT_NFIELDS)
+#define DLC_BLOCKSZ                                                            \
+  (sizeof(dlblkhdr_t) + (DLC_BLOCKRECS * DLC_SAMPLEBITS + 7) / 8 + 8)
+
+typedef struct dlblkhdr {
+  uint32_t magic;   ///< DLC_MAGIC
+  uint16_t count;   ///< Samples in the block
+  uint16_t nfields; ///< Channels per sample
+  uint32_t bytes;   ///< Block size including this header
+  uint16_t ntimes;  ///< Delta-of-delta times per sample
+  uint16_t reserved;
+  int64_t first;    ///< rtime of the first sample
+  int64_t last;     ///< rtime of the last sample
+} dlblkhdr_t;
+
+typedef struct dlencoder {
+  uint8_t buf[DLC_BLOCKSZ];       ///< Block being built, header first
+  uint64_t bits;                  ///< Payload bits written
+  uint16_t count;                 ///< Samples in the block
+  int64_t first;                  ///< rtime of the first sample
+  int64_t t[DLC_NTIMES];          ///< Previous rtime and stamps
+  int64_t delta[DLC_NTIMES];      ///< Previous delta of each time
+  uint32_t prev[DLFMT_NFIELDS];   ///< Previous value bits of each channel
+  uint8_t lead[DLFMT_NFIELDS];    ///< Leading zeros of the last XOR window
+  uint8_t trail[DLFMT_NFIELDS];   ///< Trailing zeros of the last XOR window
+} dlencoder_t;
+
+///\cond INTERNAL
+// Function Prototypes
+void DlEncInit(dlencoder_t *);
+int DlEncAppend(dlencoder_t *, const reading_s *);
+size_t DlEncBlock(dlencoder_t *, const uint8_t **);
+int DlDecBlock(const uint8_t *, size_t, reading_s *, size_t);
+///\endcond
+#endif
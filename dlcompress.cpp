@@ -0,0 +1,210 @@
+/** @file dlcompress.cpp
+ *  @brief Segment compression thread and disk budget functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlcompress.h"
+#include "spsc.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
+static SpscRing<dlzjob_t, DLZ_QUEUESZ> queue;
+static std::atomic<bool> running(false);
+static std::thread worker;
+static char budgetDir[DLSEG_PATHSZ];
+static uint64_t budget;
+static int level;
+
+/** @brief Drop the calling thread to idle scheduling priority.
+ */
+static void lowerPriority(void) {
+  struct sched_param sp;
+
+  memset(&sp, 0, sizeof(sp));
+#ifdef SCHED_IDLE
+  if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &sp) == 0) {
+    return;
+  }
+#endif
+  // On Linux a nice value set with a zero id only applies to this thread
+  setpriority(PRIO_PROCESS, 0, 19);
+}
+
+/** @brief Compression thread body.
+ */
+static void compressTask(void) {
+  dlzjob_t job;
+
+  lowerPriority();
+  while (true) {
+    bool stop = !running.load(std::memory_order_relaxed);
+    bool worked = false;
+
+    while (queue.Pop(job)) {
+      DlCompressFile(job.path, level);
+      worked = true;
+    }
+    if (worked && budget > 0) {
+      DlEnforceBudget(budgetDir, budget);
+    }
+    if (stop) {
+      break;
+    }
+    usleep(DLZ_IDLEMS * 1000);
+  }
+}
+
+/** @brief Start the compression thread.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param dir segment directory
+ *  @param maxbytes disk budget of the directory in bytes, 0 for none
+ *  @param zlevel gzip level 1-9, 0 to only enforce the budget
+ *  @return 0 on success, -1 if the thread is already running
+ *
+ *  Call before the first segment of the session is opened: segments left
+ *  uncompressed by an earlier session are queued as well.
+ */
+int DlCompressStart(const char *dir, uint64_t maxbytes, int zlevel) {
+  if (running.exchange(true)) {
+    return -1;
+  }
+  snprintf(budgetDir, sizeof(budgetDir), "%s", dir);
+  budget = maxbytes;
+  level = zlevel;
+  for (const dlsegent_t &e : DlSegList(dir)) {
+    if (!e.compressed) {
+      DlCompressQueue(e.path);
+    }
+  }
+  worker = std::thread(compressTask);
+  return 0;
+}
+
+/** @brief Hand a closed segment to the compression thread.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param path closed segment
+ *  @return 0 if queued, -1 if the queue is full or the thread is not running
+ *
+ *  A segment that could not be queued stays uncompressed until the next
+ *  session picks it up.
+ */
+int DlCompressQueue(const char *path) {
+  dlzjob_t job;
+
+  if (!running.load(std::memory_order_relaxed)) {
+    return -1;
+  }
+  snprintf(job.path, sizeof(job.path), "%s", path);
+  return queue.Push(job) ? 0 : -1;
+}
+
+/** @brief Finish the queued work and stop the compression thread.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return void
+ */
+void DlCompressStop(void) {
+  if (!running.exchange(false)) {
+    return;
+  }
+  worker.join();
+}
+
+/** @brief Replace a segment with its gzip compressed copy.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param path segment to compress
+ *  @param zlevel gzip level 1-9, 0 leaves the segment alone
+ *  @return 0 on success, -1 on error
+ */
+int DlCompressFile(const char *path, int zlevel) {
+  char tmp[DLSEG_PATHSZ + 8];
+  char dst[DLSEG_PATHSZ + 4];
+  char mode[4];
+  static char buf[DLZ_CHUNK];
+  ssize_t n;
+  int fd;
+  gzFile gz;
+
+  if (zlevel <= 0) {
+    return 0;
+  }
+  snprintf(dst, sizeof(dst), "%s" DLSEG_ZSUFFIX, path);
+  snprintf(tmp, sizeof(tmp), "%s.tmp", dst);
+  snprintf(mode, sizeof(mode), "wb%d", zlevel > 9 ? 9 : zlevel);
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return -1;
+  }
+  gz = gzopen(tmp, mode);
+  if (gz == NULL) {
+    close(fd);
+    return -1;
+  }
+  while ((n = read(fd, buf, sizeof(buf))) > 0) {
+    if (gzwrite(gz, buf, n) != n) {
+      n = -1;
+      break;
+    }
+  }
+  // The segment will not be read again, keep it out of the page cache
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+  if (gzclose(gz) != Z_OK || n < 0) {
+    unlink(tmp);
+    return -1;
+  }
+  fd = open(tmp, O_RDONLY);
+  if (fd >= 0) {
+    fdatasync(fd);
+    close(fd);
+  }
+  if (rename(tmp, dst) < 0) {
+    unlink(tmp);
+    return -1;
+  }
+  return unlink(path);
+}
+
+/** @brief Delete the oldest segments until a directory fits its budget.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param dir segment directory
+ *  @param maxbytes disk budget in bytes
+ *  @return number of segments deleted
+ *
+ *  The newest segment is the one being written and is never deleted. The
+ *  index of a deleted segment goes with it; its catalog entry stays and is
+ *  skipped by queries.
+ */
+int DlEnforceBudget(const char *dir, uint64_t maxbytes) {
+  std::vector<dlsegent_t> ents = DlSegList(dir);
+  uint64_t total = 0;
+  int deleted = 0;
+
+  for (const dlsegent_t &e : ents) {
+    total += e.size;
+  }
+  for (size_t i = 0; i + 1 < ents.size() && total > maxbytes; i++) {
+    char idx[DLSEG_PATHSZ + sizeof(DLIDX_SUFFIX)];
+    if (unlink(ents[i].path) == 0) {
+      total -= ents[i].size;
+      deleted++;
+    }
+    if (DlIndexPath(ents[i].path, idx, sizeof(idx)) == 0) {
+      unlink(idx);
+    }
+  }
+  return deleted;
+}
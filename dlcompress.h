@@ -0,0 +1,34 @@
+#ifndef DLCOMPRESS_H
+#define DLCOMPRESS_H
+/** @file dlcompress.h
+ *  @brief Background compression of closed segments and disk budget.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  Closed segments are queued through an SpscRing to a single background
+ *  thread running at the lowest scheduling priority. It gzips each segment
+ *  next to the original, renames the result into place and only then
+ *  removes the original, so a crash leaves one complete copy. After every
+ *  pass the oldest segments are deleted until the directory fits in the
+ *  disk budget. Queueing never blocks the thread that closed the segment.
+ */
+#include "dllog.h"
+#include <cstdint>
+
+#define DLZ_QUEUESZ 64  ///< Closed segments waiting for compression
+#define DLZ_IDLEMS 200  ///< Queue polling interval of the thread
+#define DLZ_CHUNK 65536 ///< Bytes read per gzwrite
+
+typedef struct dlzjob {
+  char path[DLSEG_PATHSZ]; ///< Closed segment to compress
+} dlzjob_t;
+
+///\cond INTERNAL
+// Function Prototypes
+int DlCompressStart(const char *, uint64_t, int);
+int DlCompressQueue(const char *);
+void DlCompressStop(void);
+int DlCompressFile(const char *, int);
+int DlEnforceBudget(const char *, uint64_t);
+///\endcond
+#endif
@@ -0,0 +1,35 @@
+/** @file dlexport.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Export binary log segments as CSV
+ *
+ *  Usage: dlexport loggerdata-<serial>-<time>.<seq>.vdl [...] > data.csv
+ */
+
+#include "dllog.h"
+#include <cstdio>
+
+/** @brief Log export main function
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return int program status
+ */
+int main(int argc, char *argv[]) {
+  int status = 0;
+
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s segment...\n", argv[0]);
+    return 1;
+  }
+  for (int i = 1; i < argc; i++) {
+    dlsegmap_t m;
+    if (DlSegMap(&m, argv[i]) < 0) {
+      fprintf(stderr, "%s: not a valid log segment\n", argv[i]);
+      status = 1;
+      continue;
+    }
+    DlSegExportCsv(&m, stdout);
+    DlSegUnmap(&m);
+  }
+  return status;
+}
@@ -0,0 +1,477 @@
+/** @file dlfence.cpp
+ *  @brief Geofence functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlfence.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/** @brief Grow an array to hold at least n elements.
+ *  @return 0 on success, -1 if out of memory
+ */
+static int reserve(void **p, uint32_t *cap, uint32_t n, size_t size) {
+  if (n <= *cap) {
+    return 0;
+  }
+  uint32_t c = (*cap == 0) ? 64 : *cap;
+  while (c < n) {
+    c *= 2;
+  }
+  void *q = realloc(*p, (size_t)c * size);
+  if (q == NULL) {
+    return -1;
+  }
+  *p = q;
+  *cap = c;
+  return 0;
+}
+
+/** @brief Parse decimal degrees into 1e-7 degrees, rounded.
+ *  @return 0 on success, -1 if there is no number or it is out of range
+ */
+static int parseE7(const char **sp, int32_t *out) {
+  const char *s = *sp;
+  int64_t v = 0;
+  int frac = -1;
+  bool neg = false;
+  bool digits = false;
+  bool up = false;
+
+  if (*s == '-' || *s == '+') {
+    neg = (*s++ == '-');
+  }
+  for (;; s++) {
+    if (*s == '.' && frac < 0) {
+      frac = 0;
+      continue;
+    }
+    if (*s < '0' || *s > '9') {
+      break;
+    }
+    digits = true;
+    if (frac == 7) {
+      up = (*s >= '5');
+      frac++;
+      continue;
+    }
+    if (frac > 7) {
+      continue;
+    }
+    if (frac >= 0) {
+      frac++;
+    }
+    v = v * 10 + (*s - '0');
+    if (v > 1800000000LL) {
+      return -1;
+    }
+  }
+  for (frac = (frac < 0) ? 0 : frac; frac < 7; frac++) {
+    v *= 10;
+  }
+  v += up;
+  if (!digits || v > 1800000000LL) {
+    return -1;
+  }
+  *out = (int32_t)(neg ? -v : v);
+  *sp = s;
+  return 0;
+}
+
+/** @brief Parse one fence line into the set.
+ *  @return 1 for a fence, 0 for a blank or comment line, -1 if malformed
+ */
+static int parseLine(dlfenceset_t *set, uint32_t *fcap, uint32_t *vcap,
+                     const char *s) {
+  dlfence_t f;
+  char *end;
+
+  while (*s == ' ' || *s == '\t') {
+    s++;
+  }
+  if (*s == '#' || *s == '\n' || *s == '\r' || *s == '\0') {
+    return 0;
+  }
+  memset(&f, 0, sizeof(f));
+  long id = strtol(s, &end, 10);
+  if (end == s || id <= 0 || id > INT32_MAX) {
+    return -1;
+  }
+  f.id = (int32_t)id;
+  s = end;
+  while (*s == ' ' || *s == '\t') {
+    s++;
+  }
+  size_t n = strcspn(s, " \t\r\n");
+  if (n == 0) {
+    return -1;
+  }
+  memcpy(f.name, s, (n < DLFENCE_NAMESZ - 1) ? n : DLFENCE_NAMESZ - 1);
+  s += n;
+
+  f.first = set->nverts;
+  f.min = dlvertex_t{INT32_MAX, INT32_MAX};
+  f.max = dlvertex_t{INT32_MIN, INT32_MIN};
+  while (true) {
+    dlvertex_t v;
+    while (*s == ' ' || *s == '\t') {
+      s++;
+    }
+    if (*s == '\0' || *s == '\r' || *s == '\n' || *s == '#') {
+      break;
+    }
+    if (parseE7(&s, &v.lat) < 0 || v.lat < -900000000 || v.lat > 900000000 ||
+        *s++ != ',' || parseE7(&s, &v.lon) < 0) {
+      set->nverts = f.first;
+      return -1;
+    }
+    if (reserve((void **)&set->verts, vcap, set->nverts + 1,
+                sizeof(dlvertex_t)) < 0) {
+      set->nverts = f.first;
+      return -1;
+    }
+    set->verts[set->nverts++] = v;
+    f.min.lat = (v.lat < f.min.lat) ? v.lat : f.min.lat;
+    f.min.lon = (v.lon < f.min.lon) ? v.lon : f.min.lon;
+    f.max.lat = (v.lat > f.max.lat) ? v.lat : f.max.lat;
+    f.max.lon = (v.lon > f.max.lon) ? v.lon : f.max.lon;
+  }
+  f.nverts = set->nverts - f.first;
+  // Integer tests need the box to fit in 31 bits
+  if (f.nverts < 3 || (int64_t)f.max.lon - f.min.lon > 1800000000LL ||
+      reserve((void **)&set->fences, fcap, set->nfences + 1,
+              sizeof(dlfence_t)) < 0) {
+    set->nverts = f.first;
+    return -1;
+  }
+  set->fences[set->nfences++] = f;
+  return 1;
+}
+
+/** @brief Build the grid over the loaded fences.
+ *  @return 0 on success, -1 if out of memory
+ */
+static int buildGrid(dlfenceset_t *set) {
+  dlvertex_t lo = {INT32_MAX, INT32_MAX};
+  dlvertex_t hi = {INT32_MIN, INT32_MIN};
+
+  for (uint32_t i = 0; i < set->nfences; i++) {
+    const dlfence_t &f = set->fences[i];
+    lo.lat = (f.min.lat < lo.lat) ? f.min.lat : lo.lat;
+    lo.lon = (f.min.lon < lo.lon) ? f.min.lon : lo.lon;
+    hi.lat = (f.max.lat > hi.lat) ? f.max.lat : hi.lat;
+    hi.lon = (f.max.lon > hi.lon) ? f.max.lon : hi.lon;
+  }
+  int64_t span = (int64_t)hi.lat - lo.lat;
+  if ((int64_t)hi.lon - lo.lon > span) {
+    span = (int64_t)hi.lon - lo.lon;
+  }
+  int64_t sz = DLFENCE_CELLE7;
+  while ((span / sz + 1) * (span / sz + 1) > DLFENCE_MAXCELLS) {
+    sz *= 2;
+  }
+  set->origin = lo;
+  set->cellsz = (int32_t)sz;
+  set->rows = (uint32_t)(((int64_t)hi.lat - lo.lat) / sz + 1);
+  set->cols = (uint32_t)(((int64_t)hi.lon - lo.lon) / sz + 1);
+
+  size_t ncells = (size_t)set->rows * set->cols;
+  set->cellstart = (uint32_t *)calloc(ncells + 1, sizeof(uint32_t));
+  if (set->cellstart == NULL) {
+    return -1;
+  }
+  // Count, then fill, each fence in every cell its box overlaps
+  for (int pass = 0; pass < 2; pass++) {
+    for (uint32_t i = 0; i < set->nfences; i++) {
+      const dlfence_t &f = set->fences[i];
+      uint32_t r0 = (uint32_t)(((int64_t)f.min.lat - lo.lat) / sz);
+      uint32_t r1 = (uint32_t)(((int64_t)f.max.lat - lo.lat) / sz);
+      uint32_t c0 = (uint32_t)(((int64_t)f.min.lon - lo.lon) / sz);
+      uint32_t c1 = (uint32_t)(((int64_t)f.max.lon - lo.lon) / sz);
+      for (uint32_t r = r0; r <= r1; r++) {
+        for (uint32_t c = c0; c <= c1; c++) {
+          size_t cell = (size_t)r * set->cols + c;
+          if (pass == 0) {
+            set->cellstart[cell + 1]++;
+          } else {
+            set->cellfence[set->cellstart[cell]++] = i;
+          }
+        }
+      }
+    }
+    if (pass == 0) {
+      for (size_t c = 0; c < ncells; c++) {
+        set->cellstart[c + 1] += set->cellstart[c];
+      }
+      set->cellfence =
+          (uint32_t *)malloc((set->cellstart[ncells] + 1) * sizeof(uint32_t));
+      if (set->cellfence == NULL) {
+        return -1;
+      }
+    }
+  }
+  // The fill pass left each start at the next cell's start
+  memmove(set->cellstart + 1, set->cellstart, ncells * sizeof(uint32_t));
+  set->cellstart[0] = 0;
+  return 0;
+}
+
+/** @brief Load a fence file and index it.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param set output set, empty on failure
+ *  @param path fence file
+ *  @return number of fences loaded, -1 with errno set if the file cannot
+ *  be read or memory runs out
+ *
+ *  Malformed lines are skipped and counted in set->skipped.
+ */
+int DlFenceLoad(dlfenceset_t *set, const char *path) {
+  uint32_t fcap = 0;
+  uint32_t vcap = 0;
+  char *line = NULL;
+  size_t linecap = 0;
+
+  memset(set, 0, sizeof(*set));
+  FILE *fp = fopen(path, "r");
+  if (fp == NULL) {
+    return -1;
+  }
+  while (getline(&line, &linecap, fp) >= 0) {
+    if (parseLine(set, &fcap, &vcap, line) < 0) {
+      set->skipped++;
+    }
+  }
+  free(line);
+  fclose(fp);
+  if (set->nfences > 0 && buildGrid(set) < 0) {
+    DlFenceFree(set);
+    errno = ENOMEM;
+    return -1;
+  }
+  return (int)set->nfences;
+}
+
+/** @brief Release a fence set.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param set set from DlFenceLoad
+ *  @return void
+ */
+void DlFenceFree(dlfenceset_t *set) {
+  free(set->fences);
+  free(set->verts);
+  free(set->cellstart);
+  free(set->cellfence);
+  memset(set, 0, sizeof(*set));
+}
+
+/** @brief Grid cell of a position.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param set fence set
+ *  @param lat latitude, 1e-7 degrees
+ *  @param lon longitude, 1e-7 degrees
+ *  @return cell index, -1 outside the grid, where there are no fences
+ */
+int64_t DlFenceCell(const dlfenceset_t *set, int32_t lat, int32_t lon) {
+  if (set->nfences == 0 || lat < set->origin.lat || lon < set->origin.lon) {
+    return -1;
+  }
+  int64_t r = ((int64_t)lat - set->origin.lat) / set->cellsz;
+  int64_t c = ((int64_t)lon - set->origin.lon) / set->cellsz;
+  if (r >= set->rows || c >= set->cols) {
+    return -1;
+  }
+  return r * set->cols + c;
+}
+
+/** @brief Test whether a position is inside one fence.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param set fence set
+ *  @param i fence index
+ *  @param lat latitude, 1e-7 degrees
+ *  @param lon longitude, 1e-7 degrees
+ *  @return 1 inside, 0 outside
+ *
+ *  The crossing test uses exact integer cross products. A position on an
+ *  edge may go either way.
+ */
+int DlFenceContains(const dlfenceset_t *set, uint32_t i, int32_t lat,
+                    int32_t lon) {
+  const dlfence_t &f = set->fences[i];
+  const dlvertex_t *v = set->verts + f.first;
+
+  if (lat < f.min.lat || lat > f.max.lat || lon < f.min.lon ||
+      lon > f.max.lon) {
+    return 0;
+  }
+  int inside = 0;
+  for (uint32_t k = 0, j = f.nverts - 1; k < f.nverts; j = k++) {
+    const dlvertex_t &a = v[j];
+    const dlvertex_t &b = v[k];
+    if ((a.lat > lat) != (b.lat > lat)) {
+      int64_t d = ((int64_t)b.lon - a.lon) * ((int64_t)lat - a.lat) -
+                  ((int64_t)lon - a.lon) * ((int64_t)b.lat - a.lat);
+      if ((d > 0) == (b.lat > a.lat)) {
+        inside ^= 1;
+      }
+    }
+  }
+  return inside;
+}
+
+/** @brief Reset the fence state of a position.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param t tracker
+ *  @return void
+ */
+void DlFenceTrackInit(dlfencetrack_t *t) { memset(t, 0, sizeof(*t)); }
+
+/** @brief Find the fences of a fix's cell whose bounding box holds it, and
+ *  the quiet box around the fix that no bounding box edge of the cell
+ *  crosses.
+ *  @return 0 with t->cand and the quiet box set, -1 with no candidates kept
+ *  if the fix is outside the grid or more than DLFENCE_MAXCAND boxes hold it
+ */
+static int scanCell(const dlfenceset_t *set, dlfencetrack_t *t, int64_t cell,
+                    int32_t lat, int32_t lon) {
+  t->quiet = 0;
+  t->ncand = 0;
+  if (cell < 0) {
+    return -1;
+  }
+  int32_t r = (int32_t)(cell / set->cols);
+  int32_t c = (int32_t)(cell % set->cols);
+  dlvertex_t lo = {set->origin.lat + r * set->cellsz,
+                   set->origin.lon + c * set->cellsz};
+  dlvertex_t hi = {lo.lat + (set->cellsz - 1), lo.lon + (set->cellsz - 1)};
+
+  for (uint32_t k = set->cellstart[cell]; k < set->cellstart[cell + 1]; k++) {
+    uint32_t i = set->cellfence[k];
+    const dlfence_t &f = set->fences[i];
+    if (lat >= f.min.lat && lat <= f.max.lat && lon >= f.min.lon &&
+        lon <= f.max.lon) {
+      if (t->ncand == DLFENCE_MAXCAND) {
+        t->ncand = 0;
+        return -1;
+      }
+      t->cand[t->ncand++] = i;
+      lo.lat = (f.min.lat > lo.lat) ? f.min.lat : lo.lat;
+      lo.lon = (f.min.lon > lo.lon) ? f.min.lon : lo.lon;
+      hi.lat = (f.max.lat < hi.lat) ? f.max.lat : hi.lat;
+      hi.lon = (f.max.lon < hi.lon) ? f.max.lon : hi.lon;
+      continue;
+    }
+    // Keep the box out along the side with the widest gap from the fix
+    int64_t south = (int64_t)f.min.lat - lat;
+    int64_t north = (int64_t)lat - f.max.lat;
+    int64_t west = (int64_t)f.min.lon - lon;
+    int64_t east = (int64_t)lon - f.max.lon;
+    int64_t gap = (south > north) ? south : north;
+    int64_t gapl = (west > east) ? west : east;
+    if (gap >= gapl) {
+      if (south > north) {
+        hi.lat = (f.min.lat - 1 < hi.lat) ? f.min.lat - 1 : hi.lat;
+      } else {
+        lo.lat = (f.max.lat + 1 > lo.lat) ? f.max.lat + 1 : lo.lat;
+      }
+    } else if (west > east) {
+      hi.lon = (f.min.lon - 1 < hi.lon) ? f.min.lon - 1 : hi.lon;
+    } else {
+      lo.lon = (f.max.lon + 1 > lo.lon) ? f.max.lon + 1 : lo.lon;
+    }
+  }
+  t->cell = cell;
+  t->qmin = lo;
+  t->qmax = hi;
+  t->quiet = 1;
+  return 0;
+}
+
+/** @brief Check a new fix against the fences.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param set fence set
+ *  @param t tracker of the position
+ *  @param lat latitude, 1e-7 degrees
+ *  @param lon longitude, 1e-7 degrees
+ *  @param ev output events, +id for a fence entered, -id for one left
+ *  @param max capacity of ev
+ *  @return number of events in ev
+ *
+ *  Only fences of the fix's cell whose bounding box holds the fix are
+ *  tested. When the fix is in the quiet box of the last one, those are the
+ *  fences the tracker kept and the cell is not walked again. The fences the
+ *  fix is in are compared with those of the last fix, and events beyond
+ *  max are counted in t->lost.
+ */
+int DlFenceCheck(const dlfenceset_t *set, dlfencetrack_t *t, int32_t lat,
+                 int32_t lon, int32_t *ev, int max) {
+  uint32_t now[DLFENCE_MAXINSIDE];
+  uint32_t nnow = 0;
+  int nev = 0;
+
+  t->fixes++;
+  if (t->valid && t->at.lat == lat && t->at.lon == lon) {
+    t->skips++;
+    return 0;
+  }
+  t->at = dlvertex_t{lat, lon};
+  t->valid = 1;
+  int64_t cell = DlFenceCell(set, lat, lon);
+  if (t->quiet && cell == t->cell && lat >= t->qmin.lat &&
+      lat <= t->qmax.lat && lon >= t->qmin.lon && lon <= t->qmax.lon) {
+    t->reuses++;
+  } else if (scanCell(set, t, cell, lat, lon) < 0 && cell >= 0) {
+    // Too many boxes to keep, test the cell directly
+    for (uint32_t k = set->cellstart[cell]; k < set->cellstart[cell + 1];
+         k++) {
+      uint32_t i = set->cellfence[k];
+      const dlfence_t &f = set->fences[i];
+      if (lat < f.min.lat || lat > f.max.lat || lon < f.min.lon ||
+          lon > f.max.lon) {
+        continue;
+      }
+      t->tests++;
+      if (DlFenceContains(set, i, lat, lon) && nnow < DLFENCE_MAXINSIDE) {
+        now[nnow++] = i;
+      }
+    }
+  }
+  for (uint32_t k = 0; k < t->ncand; k++) {
+    t->tests++;
+    if (DlFenceContains(set, t->cand[k], lat, lon) &&
+        nnow < DLFENCE_MAXINSIDE) {
+      now[nnow++] = t->cand[k];
+    }
+  }
+
+  // Both lists ascend, so one merge finds every entry and exit
+  uint32_t a = 0;
+  uint32_t b = 0;
+  while (a < t->ninside || b < nnow) {
+    int32_t e;
+    if (b == nnow || (a < t->ninside && t->inside[a] < now[b])) {
+      e = -set->fences[t->inside[a++]].id;
+    } else if (a == t->ninside || now[b] < t->inside[a]) {
+      e = set->fences[now[b++]].id;
+    } else {
+      a++;
+      b++;
+      continue;
+    }
+    if (nev < max) {
+      ev[nev++] = e;
+    } else {
+      t->lost++;
+    }
+  }
+  memcpy(t->inside, now, nnow * sizeof(uint32_t));
+  t->ninside = nnow;
+  return nev;
+}
@@ -0,0 +1,93 @@
+#ifndef DLFENCE_H
+#define DLFENCE_H
+/** @file dlfence.h
+ *  @brief Geofence polygons, their grid index and per-fix tracking.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  Polygons are loaded from a text file with one fence per line:
+ *
+ *      <id> <name> <lat>,<lon> <lat>,<lon> <lat>,<lon> ...
+ *
+ *  in decimal degrees, with '#' starting a comment. Vertices are kept as
+ *  1e-7 degree integers. A uniform grid covers all fences, and each cell
+ *  lists the fences whose bounding box overlaps it, so a fix is only
+ *  tested against the fences of its own cell, bounding box first.
+ *
+ *  A dlfencetrack_t follows one position and keeps the fences it was in,
+ *  so each fix only has to be compared with the last one. Entering or
+ *  leaving a fence is reported as an event, +id on entry and -id on exit.
+ *  The tracker also keeps the last fix's cell, the fences of that cell
+ *  whose bounding box held it, and a quiet box around it that no bounding
+ *  box edge of the cell crosses. A fix inside the quiet box is in the same
+ *  boxes, so only those fences are tested and the cell is not walked. A fix
+ *  at exactly the last position is not tested again.
+ */
+#include <cstddef>
+#include <cstdint>
+
+#define DLFENCE_NAMESZ 24
+#define DLFENCE_CELLE7 100000  ///< Smallest grid cell, 1e-7 degrees
+#define DLFENCE_MAXCELLS 65536 ///< Largest grid
+#define DLFENCE_MAXINSIDE 32   ///< Fences a position can be in at once
+#define DLFENCE_MAXCAND 64     ///< Bounding boxes a tracker remembers
+
+typedef struct dlvertex {
+  int32_t lat; ///< 1e-7 degrees
+  int32_t lon; ///< 1e-7 degrees
+} dlvertex_t;
+
+typedef struct dlfence {
+  int32_t id;                 ///< Fence id from the file, positive
+  char name[DLFENCE_NAMESZ];  ///< Fence name, NUL terminated
+  uint32_t first;             ///< Index of the first vertex
+  uint32_t nverts;            ///< Vertices, the last joins the first
+  dlvertex_t min;             ///< Bounding box, south west corner
+  dlvertex_t max;             ///< Bounding box, north east corner
+} dlfence_t;
+
+/// Fences of one file and their grid
+typedef struct dlfenceset {
+  dlfence_t *fences;     ///< Fences, malloc owned
+  uint32_t nfences;      ///< Fences loaded
+  dlvertex_t *verts;     ///< Vertices of every fence, malloc owned
+  uint32_t nverts;       ///< Vertices loaded
+  dlvertex_t origin;     ///< South west corner of the grid
+  int32_t cellsz;        ///< Cell side, 1e-7 degrees
+  uint32_t rows;         ///< Cells north to south
+  uint32_t cols;         ///< Cells west to east
+  uint32_t *cellstart;   ///< rows * cols + 1 offsets into cellfence
+  uint32_t *cellfence;   ///< Fence indexes of each cell, ascending
+  uint32_t skipped;      ///< Lines of the file that were not a fence
+} dlfenceset_t;
+
+/// Fence state of one moving position
+typedef struct dlfencetrack {
+  dlvertex_t at;                       ///< Last position checked
+  uint8_t valid;                       ///< A position has been checked
+  uint8_t quiet;                       ///< cell, qmin, qmax and cand are set
+  int64_t cell;                        ///< Grid cell of the last position
+  dlvertex_t qmin;                     ///< Quiet box, south west corner
+  dlvertex_t qmax;                     ///< Quiet box, north east corner
+  uint32_t ncand;                      ///< Boxes of the cell holding it
+  uint32_t cand[DLFENCE_MAXCAND];      ///< Their fence indexes, ascending
+  uint32_t ninside;                    ///< Fences the position is in
+  uint32_t inside[DLFENCE_MAXINSIDE];  ///< Their indexes, ascending
+  uint64_t fixes;                      ///< Fixes checked
+  uint64_t tests;                      ///< Polygon tests run
+  uint64_t skips;                      ///< Fixes at the last position
+  uint64_t reuses;                     ///< Fixes inside the quiet box
+  uint64_t lost;                       ///< Events that did not fit
+} dlfencetrack_t;
+
+///\cond INTERNAL
+// Function Prototypes
+int DlFenceLoad(dlfenceset_t *, const char *);
+void DlFenceFree(dlfenceset_t *);
+int64_t DlFenceCell(const dlfenceset_t *, int32_t, int32_t);
+int DlFenceContains(const dlfenceset_t *, uint32_t, int32_t, int32_t);
+void DlFenceTrackInit(dlfencetrack_t *);
+int DlFenceCheck(const dlfenceset_t *, dlfencetrack_t *, int32_t, int32_t,
+                 int32_t *, int);
+///\endcond
+#endif
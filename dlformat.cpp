@@ -0,0 +1,298 @@
+/** @file dlformat.cpp
+ *  @brief reading_s formatters.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlformat.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <time.h>
+
+static const uint64_t pow10[] = {1,       10,       100,       1000,
+                                 10000,   100000,   1000000,   10000000,
+                                 100000000, 1000000000};
+static const char days[] = "SunMonTueWedThuFriSat";
+static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+/** @brief Append a string without its terminator.
+ */
+static inline char *put(char *p, const char *s) {
+  while (*s) {
+    *p++ = *s++;
+  }
+  return p;
+}
+
+/** @brief Append an unsigned integer.
+ */
+static inline char *putUnsigned(char *p, uint64_t v) {
+  char tmp[20];
+  int n = 0;
+
+  do {
+    tmp[n++] = '0' + (char)(v % 10);
+    v /= 10;
+  } while (v > 0);
+  while (n > 0) {
+    *p++ = tmp[--n];
+  }
+  return p;
+}
+
+/** @brief Append exactly two digits.
+ */
+static inline char *put2(char *p, int v) {
+  *p++ = '0' + v / 10;
+  *p++ = '0' + v % 10;
+  return p;
+}
+
+/** @brief Write a float in fixed-point notation.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param p output position, needs DLFMT_FIELDMAX bytes
+ *  @param v value
+ *  @param prec digits after the decimal point, 0 to 9
+ *  @return position after the last character written
+ */
+char *DlFmtFixed(char *p, float v, int prec) {
+  double d = v;
+
+  if (d != d) {
+    return put(p, "nan");
+  }
+  if (d < 0) {
+    *p++ = '-';
+    d = -d;
+  }
+  if (std::isinf(d)) {
+    return put(p, "inf");
+  }
+  if (d * pow10[prec] >= 1.8e19) {
+    // Past what the scaled integer holds; a float that large has no
+    // meaningful fraction, and 6 places keep FLT_MAX within the field
+    return p + snprintf(p, DLFMT_FIELDMAX - 1, "%.*f", (prec < 6) ? prec : 6,
+                        d);
+  }
+  uint64_t scaled = (uint64_t)(d * pow10[prec] + 0.5);
+  p = putUnsigned(p, scaled / pow10[prec]);
+  if (prec > 0) {
+    uint64_t frac = scaled % pow10[prec];
+    *p++ = '.';
+    for (int i = prec - 1; i >= 0; i--) {
+      p[i] = '0' + (char)(frac % 10);
+      frac /= 10;
+    }
+    p += prec;
+  }
+  return p;
+}
+
+/** @brief Write a signed integer.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param p output position, needs 20 bytes
+ *  @param v value
+ *  @return position after the last character written
+ */
+char *DlFmtInt(char *p, int64_t v) {
+  if (v < 0) {
+    *p++ = '-';
+    return putUnsigned(p, (uint64_t)0 - (uint64_t)v);
+  }
+  return putUnsigned(p, (uint64_t)v);
+}
+
+/** @brief Write a scaled integer as an exact decimal.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param p output position, needs DLFMT_FIELDMAX bytes
+ *  @param v value times 10^prec
+ *  @param prec digits after the decimal point, 0 to 9
+ *  @return position after the last character written
+ */
+char *DlFmtDecimal(char *p, int64_t v, int prec) {
+  uint64_t u = (uint64_t)v;
+
+  if (v < 0) {
+    *p++ = '-';
+    u = (uint64_t)0 - u;
+  }
+  p = putUnsigned(p, u / pow10[prec]);
+  if (prec > 0) {
+    uint64_t frac = u % pow10[prec];
+    *p++ = '.';
+    for (int i = prec - 1; i >= 0; i--) {
+      p[i] = '0' + (char)(frac % 10);
+      frac /= 10;
+    }
+    p += prec;
+  }
+  return p;
+}
+
+/** @brief Write one field of a reading.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param p output position, needs DLFMT_FIELDMAX bytes
+ *  @param r reading
+ *  @param f field
+ *  @return position after the last character written
+ */
+char *DlFmtField(char *p, const reading_s *r, const dlfmtfield_t &f) {
+  if (f.value == nullptr) {
+    return DlFmtDecimal(p, r->*f.fixed, f.precision);
+  }
+  return DlFmtFixed(p, r->*f.value, f.precision);
+}
+
+/** @brief Write a local time as the comma separated ctime used in the CSV.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param p output position, needs 24 bytes
+ *  @param t time
+ *  @return position after the last character written
+ *
+ *  Produces "Www,Mmm,dd,hh:mm:ss,yyyy" with the same space padded day as
+ *  ctime, without going through strftime.
+ */
+char *DlFmtTime(char *p, time_t t) {
+  struct tm tm;
+
+  localtime_r(&t, &tm);
+  memcpy(p, days + 3 * tm.tm_wday, 3);
+  p[3] = ',';
+  memcpy(p + 4, months + 3 * tm.tm_mon, 3);
+  p[7] = ',';
+  p[8] = (tm.tm_mday < 10) ? ' ' : '0' + tm.tm_mday / 10;
+  p[9] = '0' + tm.tm_mday % 10;
+  p[10] = ',';
+  p = put2(p + 11, tm.tm_hour);
+  *p++ = ':';
+  p = put2(p, tm.tm_min);
+  *p++ = ':';
+  p = put2(p, tm.tm_sec);
+  *p++ = ',';
+  return putUnsigned(p, tm.tm_year + 1900);
+}
+
+/** @brief Format a reading as one loggerdata.csv line.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param r reading
+ *  @param buf output buffer
+ *  @param size size of buf
+ *  @return length written excluding the terminator, -1 if buf is too small
+ */
+int DlFormatCsv(const reading_s *r, char *buf, size_t size) {
+  char *p = buf;
+  char *end = buf + size;
+
+  if (size < DLFMT_FIELDMAX) {
+    return -1;
+  }
+  p = DlFmtTime(p, r->rtime);
+  for (size_t i = 0; i < DLFMT_NFIELDS; i++) {
+    const dlfmtfield_t &f = dlReadingFields[i];
+    if (end - p < DLFMT_FIELDMAX) {
+      return -1;
+    }
+    *p++ = ',';
+    p = DlFmtField(p, r, f);
+  }
+  for (size_t i = 0; i < DLFMT_NSTAMPS; i++) {
+    if (end - p < DLFMT_FIELDMAX) {
+      return -1;
+    }
+    *p++ = ',';
+    p = DlFmtInt(p, r->*dlReadingStamps[i].value);
+  }
+  *p++ = '\n';
+  *p = '\0';
+  return p - buf;
+}
+
+/** @brief Format a reading as the loggerdata.json object.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param r reading
+ *  @param buf output buffer
+ *  @param size size of buf
+ *  @return length written excluding the terminator, -1 if buf is too small
+ */
+int DlFormatJson(const reading_s *r, char *buf, size_t size) {
+  char *p = buf;
+  char *end = buf + size;
+
+  if (size < DLFMT_FIELDMAX) {
+    return -1;
+  }
+  p = put(p, "{\n\t\"rtime\":");
+  p = DlFmtInt(p, r->rtime);
+  for (size_t i = 0; i < DLFMT_NFIELDS; i++) {
+    const dlfmtfield_t &f = dlReadingFields[i];
+    if ((size_t)(end - p) < DLFMT_FIELDMAX + strlen(f.name) + DLFMT_JSONKEY) {
+      return -1;
+    }
+    p = put(p, ",\n\t\"");
+    p = put(p, f.name);
+    *p++ = '"';
+    *p++ = ':';
+    if (f.value != nullptr && r->*f.value != r->*f.value) {
+      p = put(p, "null");
+    } else {
+      p = DlFmtField(p, r, f);
+    }
+  }
+  for (size_t i = 0; i < DLFMT_NSTAMPS; i++) {
+    const dlfmtstamp_t &s = dlReadingStamps[i];
+    if ((size_t)(end - p) < DLFMT_FIELDMAX + strlen(s.name) + DLFMT_JSONKEY) {
+      return -1;
+    }
+    p = put(p, ",\n\t\"");
+    p = put(p, s.name);
+    *p++ = '"';
+    *p++ = ':';
+    p = DlFmtInt(p, r->*s.value);
+  }
+  if (end - p < DLFMT_FIELDMAX) {
+    return -1;
+  }
+  p = put(p, ",\n\t\"active\": true\n}");
+  *p = '\0';
+  return p - buf;
+}
+
+/** @brief Format a reading for the display, one labelled group per line.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param r reading
+ *  @param buf output buffer
+ *  @param size size of buf
+ *  @return length written excluding the terminator, -1 if buf is too small
+ */
+int DlFormatText(const reading_s *r, char *buf, size_t size) {
+  char *p = buf;
+  char *end = buf + size;
+
+  for (size_t i = 0; i < DLFMT_NFIELDS; i++) {
+    const dlfmtfield_t &f = dlReadingFields[i];
+    if ((size_t)(end - p) < DLFMT_FIELDMAX + strlen(f.label) +
+                                strlen(f.unit) + DLFMT_TEXTSEP) {
+      return -1;
+    }
+    p = put(p, f.label);
+    *p++ = ':';
+    *p++ = ' ';
+    p = DlFmtField(p, r, f);
+    p = put(p, f.unit);
+    p = put(p, f.eol ? "\n" : "\t\t");
+  }
+  if (end - p < 2) {
+    return -1;
+  }
+  *p++ = '\n';
+  *p = '\0';
+  return p - buf;
+}
@@ -0,0 +1,119 @@
+#ifndef DLFORMAT_H
+#define DLFORMAT_H
+/** @file dlformat.h
+ *  @brief Field description of reading_s and the text formatters built on it.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  dlReadingFields is the one place that lists the measured fields of
+ *  reading_s, and dlReadingStamps the capture stamps that go with them.
+ *  Fields are floats, or integers already scaled by their precision, such
+ *  as the 1e-7 degree coordinates. The CSV, JSON and display formatters
+ *  walk it and write into a caller supplied buffer with integer fixed-point
+ *  conversion, so there is no printf parsing, locale lookup or heap use per
+ *  record.
+ */
+#include "logger.h"
+#include <cstddef>
+#include <cstdint>
+
+#define DLFMT_FIELDMAX 48 ///< Worst case bytes for one formatted field
+#define DLFMT_JSONKEY 6   ///< Bytes of ,\n\t"": around a JSON key
+#define DLFMT_TEXTSEP 4   ///< Bytes of ": " and the separator after a value
+#define DLFMT_FIXED 128   ///< Bound on the time, braces and terminators
+
+typedef struct dlfmtfield {
+  const char *name;       ///< CSV/JSON key
+  const char *label;      ///< Display label
+  const char *unit;       ///< Display unit suffix
+  uint8_t precision;      ///< Digits after the decimal point
+  bool eol;               ///< Last field on its display line
+  float reading_s::*value; ///< Member holding the value, or nullptr
+  int32_t reading_s::*fixed; ///< Member holding value * 10^precision
+} dlfmtfield_t;
+
+constexpr dlfmtfield_t dlReadingFields[] = {
+    {"temperature", "T", "C", 1, false, &reading_s::temperature},
+    {"humidity", "H", "%", 0, false, &reading_s::humidity},
+    {"pressure", "P", "kPa", 1, true, &reading_s::pressure},
+    {"xa", "Xa", "g", 6, false, &reading_s::xa},
+    {"ya", "Ya", "g", 6, false, &reading_s::ya},
+    {"za", "Za", "g", 6, true, &reading_s::za},
+    {"pitch", "Pitch", "", 6, false, &reading_s::pitch},
+    {"roll", "Roll", "", 6, false, &reading_s::roll},
+    {"yaw", "Yaw", "", 6, true, &reading_s::yaw},
+    {"xm", "Xm", "", 6, false, &reading_s::xm},
+    {"ym", "Ym", "", 6, false, &reading_s::ym},
+    {"zm", "Zm", "", 6, true, &reading_s::zm},
+    {"latitude", "Latitude", "", 7, false, nullptr, &reading_s::latitude},
+    {"longitude", "Longitude", "", 7, false, nullptr, &reading_s::longitude},
+    {"altitude", "Altitude", "", 6, true, &reading_s::altitude},
+    {"speed", "Speed", "", 6, false, &reading_s::speed},
+    {"heading", "Heading", "", 6, true, &reading_s::heading},
+    {"fence", "Fence", "", 0, false, nullptr, &reading_s::fence},
+    {"fenceev", "Event", "", 0, true, nullptr, &reading_s::fenceev},
+};
+
+constexpr size_t DLFMT_NFIELDS =
+    sizeof(dlReadingFields) / sizeof(dlReadingFields[0]);
+
+typedef struct dlfmtstamp {
+  const char *name;          ///< CSV/JSON key
+  int64_t reading_s::*value; ///< Member holding the stamp
+} dlfmtstamp_t;
+
+/// Capture stamps of reading_s, CLOCK_MONOTONIC ns, and their wall offset
+constexpr dlfmtstamp_t dlReadingStamps[] = {
+    {"imut", &reading_s::imut},
+    {"envt", &reading_s::envt},
+    {"gpst", &reading_s::gpst},
+    {"wallofs", &reading_s::wallofs},
+};
+
+constexpr size_t DLFMT_NSTAMPS =
+    sizeof(dlReadingStamps) / sizeof(dlReadingStamps[0]);
+
+/** @brief Length of a string in a constant expression.
+ */
+constexpr size_t DlFmtLen(const char *s) {
+  size_t n = 0;
+  while (s[n] != '\0') {
+    n++;
+  }
+  return n;
+}
+
+/** @brief Buffer size that none of the formatters can run out of.
+ *
+ *  Each field is counted at DLFMT_FIELDMAX, with the wider of its JSON key
+ *  and its display label and unit, the same space the formatters check for
+ *  before writing it.
+ */
+constexpr size_t DlFmtBufSize(void) {
+  size_t n = DLFMT_FIXED;
+  for (const dlfmtfield_t &f : dlReadingFields) {
+    size_t json = DlFmtLen(f.name) + DLFMT_JSONKEY;
+    size_t text = DlFmtLen(f.label) + DlFmtLen(f.unit) + DLFMT_TEXTSEP;
+    n += DLFMT_FIELDMAX + ((json > text) ? json : text);
+  }
+  for (const dlfmtstamp_t &s : dlReadingStamps) {
+    n += DLFMT_FIELDMAX + DlFmtLen(s.name) + DLFMT_JSONKEY;
+  }
+  return n;
+}
+
+/// Large enough for any formatter output
+constexpr size_t DLFMT_BUFSZ = DlFmtBufSize();
+
+///\cond INTERNAL
+// Function Prototypes
+char *DlFmtFixed(char *, float, int);
+char *DlFmtInt(char *, int64_t);
+char *DlFmtDecimal(char *, int64_t, int);
+char *DlFmtField(char *, const reading_s *, const dlfmtfield_t &);
+char *DlFmtTime(char *, time_t);
+int DlFormatCsv(const reading_s *, char *, size_t);
+int DlFormatJson(const reading_s *, char *, size_t);
+int DlFormatText(const reading_s *, char *, size_t);
+///\endcond
+#endif
@@ -0,0 +1,267 @@
+/** @file dlfusion.cpp
+ *  @brief GPS/IMU fusion filter functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlfusion.h"
+#include <cmath>
+#include <cstring>
+
+#define NS DLFUSE_STATES
+#define RAD (M_PI / 180)
+
+/** @brief Square of a value.
+ */
+static inline double sq(double v) { return v * v; }
+
+/** @brief Angle wrapped to [-pi, pi].
+ */
+static inline double wrap(double a) { return remainder(a, 2 * M_PI); }
+
+/** @brief Apply a measurement of state i.
+ *  @return 1 if applied, 0 if the innovation was outside the gate
+ */
+static int update(dlfusion_t *f, int i, double y, double r) {
+  double k[NS];
+  double row[NS];
+  double s = f->P[i][i] + r;
+
+  if (y * y > DLFUSE_GATE * s) {
+    f->rejects++;
+    return 0;
+  }
+  for (int a = 0; a < NS; a++) {
+    k[a] = f->P[a][i] / s;
+    row[a] = f->P[i][a];
+  }
+  for (int a = 0; a < NS; a++) {
+    f->x[a] += k[a] * y;
+    for (int b = 0; b < NS; b++) {
+      f->P[a][b] -= k[a] * row[b];
+    }
+  }
+  f->x[DLFUSE_PSI] = wrap(f->x[DLFUSE_PSI]);
+  f->updates++;
+  return 1;
+}
+
+/** @brief Advance the state by one IMU step.
+ */
+static void predict(dlfusion_t *f, const imu_s *imu, double dt) {
+  double F[NS][NS];
+  double A[NS][NS];
+  double *x = f->x;
+  double c = cos(x[DLFUSE_PSI]);
+  double s = sin(x[DLFUSE_PSI]);
+  double fx = imu->xa * DLFUSE_G - x[DLFUSE_BAX];
+  double fy = imu->ya * DLFUSE_G - x[DLFUSE_BAY];
+  double an = fx * c + fy * s;
+  double ae = fx * s - fy * c;
+  double h = 0.5 * dt * dt;
+
+  x[DLFUSE_N] += x[DLFUSE_VN] * dt + an * h;
+  x[DLFUSE_E] += x[DLFUSE_VE] * dt + ae * h;
+  x[DLFUSE_VN] += an * dt;
+  x[DLFUSE_VE] += ae * dt;
+  // z is up, so a positive rate turns the heading anticlockwise
+  x[DLFUSE_PSI] = wrap(x[DLFUSE_PSI] - (imu->yaw - x[DLFUSE_BG]) * dt);
+
+  memset(F, 0, sizeof(F));
+  for (int i = 0; i < NS; i++) {
+    F[i][i] = 1;
+  }
+  F[DLFUSE_N][DLFUSE_VN] = dt;
+  F[DLFUSE_E][DLFUSE_VE] = dt;
+  F[DLFUSE_N][DLFUSE_PSI] = -ae * h;
+  F[DLFUSE_E][DLFUSE_PSI] = an * h;
+  F[DLFUSE_VN][DLFUSE_PSI] = -ae * dt;
+  F[DLFUSE_VE][DLFUSE_PSI] = an * dt;
+  F[DLFUSE_PSI][DLFUSE_BG] = dt;
+  F[DLFUSE_N][DLFUSE_BAX] = -c * h;
+  F[DLFUSE_N][DLFUSE_BAY] = -s * h;
+  F[DLFUSE_E][DLFUSE_BAX] = -s * h;
+  F[DLFUSE_E][DLFUSE_BAY] = c * h;
+  F[DLFUSE_VN][DLFUSE_BAX] = -c * dt;
+  F[DLFUSE_VN][DLFUSE_BAY] = -s * dt;
+  F[DLFUSE_VE][DLFUSE_BAX] = -s * dt;
+  F[DLFUSE_VE][DLFUSE_BAY] = c * dt;
+
+  // P = F P F' + Q
+  for (int i = 0; i < NS; i++) {
+    for (int j = 0; j < NS; j++) {
+      double v = 0;
+      for (int k = 0; k < NS; k++) {
+        v += F[i][k] * f->P[k][j];
+      }
+      A[i][j] = v;
+    }
+  }
+  for (int i = 0; i < NS; i++) {
+    for (int j = i; j < NS; j++) {
+      double v = 0;
+      for (int k = 0; k < NS; k++) {
+        v += A[i][k] * F[j][k];
+      }
+      f->P[i][j] = f->P[j][i] = v;
+    }
+  }
+  double qa = sq(DLFUSE_ACCSD);
+  for (int p = DLFUSE_N; p <= DLFUSE_E; p++) {
+    int v = p + DLFUSE_VN;
+    f->P[p][p] += qa * h * h;
+    f->P[p][v] += qa * h * dt;
+    f->P[v][p] += qa * h * dt;
+    f->P[v][v] += qa * dt * dt;
+  }
+  f->P[DLFUSE_PSI][DLFUSE_PSI] += sq(DLFUSE_GYROSD * dt);
+  f->P[DLFUSE_BG][DLFUSE_BG] += sq(DLFUSE_GBIASSD) * dt;
+  f->P[DLFUSE_BAX][DLFUSE_BAX] += sq(DLFUSE_ABIASSD) * dt;
+  f->P[DLFUSE_BAY][DLFUSE_BAY] += sq(DLFUSE_ABIASSD) * dt;
+  f->predicts++;
+}
+
+/** @brief Move the origin to the position estimate.
+ */
+static void recenter(dlfusion_t *f) {
+  int32_t dlat = (int32_t)lround(f->x[DLFUSE_N] / DLFUSE_MLAT7);
+  int32_t dlon = (int32_t)lround(f->x[DLFUSE_E] / f->mlon7);
+
+  f->lat0 += dlat;
+  f->lon0 += dlon;
+  f->x[DLFUSE_N] -= dlat * DLFUSE_MLAT7;
+  f->x[DLFUSE_E] -= dlon * f->mlon7;
+  f->mlon7 = DLFUSE_MLAT7 * cos((double)f->lat0 / DLDEGE7 * RAD);
+}
+
+/** @brief Start position and velocity over from a fix.
+ */
+static void resetPosition(dlfusion_t *f, const fix_s *fix, double sd) {
+  double v = fix->speed / 3.6;
+
+  for (int i = DLFUSE_N; i <= DLFUSE_VE; i++) {
+    for (int j = 0; j < NS; j++) {
+      f->P[i][j] = f->P[j][i] = 0;
+    }
+  }
+  f->lat0 = fix->latitude;
+  f->lon0 = fix->longitude;
+  f->mlon7 = DLFUSE_MLAT7 * cos((double)f->lat0 / DLDEGE7 * RAD);
+  f->x[DLFUSE_N] = 0;
+  f->x[DLFUSE_E] = 0;
+  f->x[DLFUSE_VN] = v * cos(fix->course * RAD);
+  f->x[DLFUSE_VE] = v * sin(fix->course * RAD);
+  f->P[DLFUSE_N][DLFUSE_N] = f->P[DLFUSE_E][DLFUSE_E] = sq(sd);
+  f->P[DLFUSE_VN][DLFUSE_VN] = f->P[DLFUSE_VE][DLFUSE_VE] =
+      sq(2 * DLFUSE_VELSD + v);
+  f->fixed = 1;
+  f->misses = 0;
+}
+
+/** @brief Reset the filter.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param f filter
+ *  @return void
+ *
+ *  Position stays unknown until the first fix, and heading until the first
+ *  magnetometer sample or fast enough fix.
+ */
+void DlFuseInit(dlfusion_t *f) {
+  memset(f, 0, sizeof(*f));
+  f->P[DLFUSE_PSI][DLFUSE_PSI] = sq(M_PI);
+  f->P[DLFUSE_BG][DLFUSE_BG] = sq(0.05);
+  f->P[DLFUSE_BAX][DLFUSE_BAX] = sq(0.5);
+  f->P[DLFUSE_BAY][DLFUSE_BAY] = sq(0.5);
+  f->mlon7 = DLFUSE_MLAT7;
+}
+
+/** @brief Run the filter on an IMU sample and fill in its navigation
+ *  fields.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param f filter
+ *  @param imu sample; yaw is the z gyro rate in rad/s. latitude,
+ *  longitude, speed and heading are set, nav once a fix has been fused.
+ *  @return void
+ *
+ *  A step longer than DLFUSE_MAXDT is not predicted over, the sample only
+ *  restarts the integration.
+ */
+void DlFuseImu(dlfusion_t *f, imu_s *imu) {
+  double dt = (f->t == 0) ? 0 : (double)(imu->t - f->t) / 1e9;
+  double mag = sqrt(sq(imu->xm) + sq(imu->ym));
+  double psim = atan2(imu->ym, imu->xm) + DLFUSE_DECL * RAD;
+
+  f->t = imu->t;
+  if (!f->headed && mag > 0) {
+    f->x[DLFUSE_PSI] = wrap(psim);
+    f->P[DLFUSE_PSI][DLFUSE_PSI] = sq(DLFUSE_MAGSD * RAD);
+    f->headed = 1;
+  }
+  if (dt > 0 && dt <= DLFUSE_MAXDT) {
+    predict(f, imu, dt);
+    if (mag > 0) {
+      // A sample every dt carries dt / DLFUSE_MAGTAU of an independent one
+      update(f, DLFUSE_PSI, wrap(psim - f->x[DLFUSE_PSI]),
+             sq(DLFUSE_MAGSD * RAD) * DLFUSE_MAGTAU / dt);
+    }
+  }
+
+  double deg = f->x[DLFUSE_PSI] / RAD;
+  imu->heading = (float)((deg < 0) ? deg + 360 : deg);
+  imu->nav = f->fixed;
+  if (f->fixed) {
+    imu->latitude =
+        f->lat0 + (int32_t)lround(f->x[DLFUSE_N] / DLFUSE_MLAT7);
+    imu->longitude = f->lon0 + (int32_t)lround(f->x[DLFUSE_E] / f->mlon7);
+    imu->speed = (float)(hypot(f->x[DLFUSE_VN], f->x[DLFUSE_VE]) * 3.6);
+  }
+}
+
+/** @brief Correct the filter with a GPS fix.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param f filter
+ *  @param fix new fix; t is when its position was read
+ *  @return 1 if the position was applied, 0 if the fix was unusable or
+ *  outside the gate
+ *
+ *  The fix is moved forward to the time of the last IMU sample with the
+ *  velocity estimate. After DLFUSE_RESET rejected fixes in a row the
+ *  position restarts from the fix.
+ */
+int DlFuseGps(dlfusion_t *f, const fix_s *fix) {
+  double *x = f->x;
+  double sd = ((fix->hdop > 0) ? fix->hdop : DLFUSE_NOHDOP) * DLFUSE_UERE;
+  double age = (f->t > fix->t) ? (double)(f->t - fix->t) / 1e9 : 0;
+  double v = fix->speed / 3.6;
+  int ok;
+
+  if (fix->t == 0 || fix->quality == 0) {
+    return 0;
+  }
+  if (!f->fixed || f->misses >= DLFUSE_RESET) {
+    resetPosition(f, fix, sd);
+    ok = 1;
+  } else {
+    recenter(f);
+    double zn = (fix->latitude - f->lat0) * DLFUSE_MLAT7 + x[DLFUSE_VN] * age;
+    double ze = (fix->longitude - f->lon0) * f->mlon7 + x[DLFUSE_VE] * age;
+    ok = update(f, DLFUSE_N, zn - x[DLFUSE_N], sq(sd));
+    ok &= update(f, DLFUSE_E, ze - x[DLFUSE_E], sq(sd));
+    f->misses = ok ? 0 : f->misses + 1;
+  }
+  if (v >= DLFUSE_MINSPEED) {
+    double cr = fix->course * RAD;
+    if (!f->headed) {
+      x[DLFUSE_PSI] = wrap(cr);
+      f->P[DLFUSE_PSI][DLFUSE_PSI] = sq(DLFUSE_COURSESD * RAD);
+      f->headed = 1;
+    }
+    update(f, DLFUSE_VN, v * cos(cr) - x[DLFUSE_VN], sq(DLFUSE_VELSD));
+    update(f, DLFUSE_VE, v * sin(cr) - x[DLFUSE_VE], sq(DLFUSE_VELSD));
+    update(f, DLFUSE_PSI, wrap(cr - x[DLFUSE_PSI]),
+           sq(DLFUSE_COURSESD * RAD));
+  }
+  return ok;
+}
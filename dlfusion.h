@@ -0,0 +1,75 @@
+#ifndef DLFUSION_H
+#define DLFUSION_H
+/** @file dlfusion.h
+ *  @brief GPS/IMU dead reckoning with an extended Kalman filter.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  The filter runs on the IMU thread. Each IMU sample predicts position,
+ *  velocity and heading from the accelerometer and the z gyro, and the
+ *  magnetometer corrects the heading. Each new GPS fix corrects position,
+ *  and velocity and heading once the unit moves fast enough for the course
+ *  to mean something. Between fixes, or with no fix at all, the position
+ *  keeps following the IMU.
+ *
+ *  The unit is assumed level, with x forward, y to the left and z up.
+ *  Position is kept in metres north and east of an origin that is moved to
+ *  the estimate at every fix, so a flat-earth step is always exact enough.
+ *  Every measurement is applied as a scalar update, so the filter needs no
+ *  matrix inverse, no heap and a fixed amount of memory.
+ */
+#include "logger.h"
+#include <cstdint>
+
+// State vector
+#define DLFUSE_N 0     ///< Metres north of the origin
+#define DLFUSE_E 1     ///< Metres east of the origin
+#define DLFUSE_VN 2    ///< Velocity north, m/s
+#define DLFUSE_VE 3    ///< Velocity east, m/s
+#define DLFUSE_PSI 4   ///< Heading, radians clockwise from true north
+#define DLFUSE_BG 5    ///< z gyro bias, rad/s
+#define DLFUSE_BAX 6   ///< x accelerometer bias, m/s^2
+#define DLFUSE_BAY 7   ///< y accelerometer bias, m/s^2
+#define DLFUSE_STATES 8
+
+// Tuning
+#define DLFUSE_G 9.80665        ///< m/s^2 per g of the accelerometer
+#define DLFUSE_MLAT7 0.011119493 ///< Metres per 1e-7 degree of latitude
+#define DLFUSE_DECL (-10.3)     ///< Magnetic declination, degrees east
+#define DLFUSE_ACCSD 0.5        ///< Accelerometer noise, m/s^2
+#define DLFUSE_GYROSD 0.02      ///< Gyro noise, rad/s
+#define DLFUSE_GBIASSD 0.0005   ///< Gyro bias drift, rad/s per sqrt(s)
+#define DLFUSE_ABIASSD 0.002    ///< Accelerometer bias drift, m/s^2/sqrt(s)
+#define DLFUSE_MAGSD 15.0       ///< Magnetometer heading error, degrees
+#define DLFUSE_MAGTAU 1.0       ///< s over which that error is correlated
+#define DLFUSE_UERE 4.0         ///< Position error per unit of HDOP, m
+#define DLFUSE_NOHDOP 2.0       ///< HDOP assumed when the receiver has none
+#define DLFUSE_VELSD 0.5        ///< GPS velocity error, m/s
+#define DLFUSE_COURSESD 5.0     ///< GPS course error, degrees
+#define DLFUSE_MINSPEED 3.0     ///< m/s above which the course is used
+#define DLFUSE_GATE 25.0        ///< Innovation gate, squared sigmas
+#define DLFUSE_RESET 5          ///< Rejected fixes in a row before a reset
+#define DLFUSE_MAXDT 0.1        ///< Longest IMU step predicted, s
+
+typedef struct dlfusion {
+  double x[DLFUSE_STATES];                ///< State, indexed by DLFUSE_*
+  double P[DLFUSE_STATES][DLFUSE_STATES]; ///< State covariance
+  int32_t lat0;      ///< Latitude of the origin, 1e-7 degrees
+  int32_t lon0;      ///< Longitude of the origin, 1e-7 degrees
+  double mlon7;      ///< Metres per 1e-7 degree of longitude at the origin
+  int64_t t;         ///< Time of the last IMU sample, ns, 0 before any
+  uint8_t headed;    ///< Heading initialised
+  uint8_t fixed;     ///< Position initialised from a fix
+  uint8_t misses;    ///< Fixes rejected in a row
+  uint64_t predicts; ///< IMU samples predicted
+  uint64_t updates;  ///< Measurements applied
+  uint64_t rejects;  ///< Measurements outside the gate
+} dlfusion_t;
+
+///\cond INTERNAL
+// Function Prototypes
+void DlFuseInit(dlfusion_t *);
+void DlFuseImu(dlfusion_t *, imu_s *);
+int DlFuseGps(dlfusion_t *, const fix_s *);
+///\endcond
+#endif
@@ -2,35 +2,168 @@
  *  @brief Data logger gps Functions
  */
 #include "dlgps.h"
+#include "dlclock.h"
 #include "nmea.h"
+#include "seqlock.h"
 #include "serial.h"
-#include <cmath>
+#include "spsc.h"
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
 
 #if SIMGPS
-// Global GPS Data File Pointer
-FILE *fpgps = NULL;
+// Capture standing in for the receiver
+static dlreplay_t gpsreplay;
+#else
+// Receiver port
+static serial_t gpsport = {-1};
 #endif
 
+// Fix cache, written only by the reader thread
+static SeqLock<gpsfix_t> gpsLatest;
+static std::atomic<bool> gpsRunning(false);
+static std::thread gpsReader;
+
+// Every new position, for DlGpsNext, and the eventfd that signals one
+static SpscRing<gpsfix_t, GPSQUEUESZ> gpsQueue;
+static int gpsEvent = -1;
+
+/** @brief Fold one sentence into the fix.
+ *  @return 1 if the fix changed
+ */
+static int updateFix(gpsfix_t *fix, uint8_t *inview, const char *line,
+                     int64_t now) {
+  nmeasentence_t s;
+  nmeatok_t tok;
+
+  nmea_tokenize(line, strnlen(line, GPSDATASZ), &tok);
+  switch (nmea_read(&tok, &s)) {
+  case NMEA_GGA:
+    if (s.gga.lat7 == NMEA_BADCOORD || s.gga.lon7 == NMEA_BADCOORD) {
+      fix->errors++;
+      return 1;
+    }
+    fix->loc.quality = s.gga.quality;
+    fix->loc.satused = s.gga.satellites;
+    if (s.gga.quality == 0) {
+      // No position, keep the last one and let it age
+      return 1;
+    }
+    fix->loc.utc = s.gga.utc;
+    fix->loc.latitude = s.gga.lat7;
+    fix->loc.longitude = s.gga.lon7;
+    fix->loc.altitude = s.gga.altitude;
+    fix->post = now;
+    fix->seq++;
+    return 1;
+  case NMEA_RMC:
+    fix->loc.speed = s.rmc.speed * NMEA_KPHKNOT;
+    fix->loc.course = s.rmc.course;
+    fix->loc.date = s.rmc.date;
+    fix->velt = now;
+    return 1;
+  case NMEA_GSA:
+    fix->loc.fixtype = s.gsa.fix;
+    fix->loc.pdop = s.gsa.pdop;
+    fix->loc.hdop = s.gsa.hdop;
+    fix->loc.vdop = s.gsa.vdop;
+    fix->dopt = now;
+    return 1;
+  case NMEA_GSV:
+    // Each system reports its own satellites in view
+    inview[s.talker] = s.gsv.inview;
+    fix->loc.satview = 0;
+    for (int i = 0; i < NMEA_TALKERS; i++) {
+      fix->loc.satview += inview[i];
+    }
+    fix->satt = now;
+    return 1;
+  default:
+    if (tok.type & NMEA_CHECKSUM_ERR) {
+      fix->errors++;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/** @brief Background reader, the only consumer of the GPS stream.
+ *
+ *  Every sentence is parsed as it arrives and the fix cache republished,
+ *  so readers of the cache never wait on the receiver. A sentence carrying
+ *  a new position also queues the fix and signals the eventfd; a GGA
+ *  without a fix only updates the quality and satellites used.
+ */
+static void readerTask(void) {
+  uint8_t inview[NMEA_TALKERS] = {0};
+  char buffer[GPSDATASZ];
+  gpsfix_t fix;
+
+  memset(&fix, 0, sizeof(fix));
+  while (gpsRunning.load(std::memory_order_relaxed)) {
+#if SIMGPS
+    if (DlReplayNext(&gpsreplay, buffer, GPSDATASZ) < 0) {
+      break;
+    }
+#else
+    int n = serial_readline(&gpsport, buffer, GPSDATASZ, GPSREADWAIT);
+    if (n == 0) {
+      continue;
+    }
+    if (n < 0) {
+      // Port gone, keep the last fix and try again later
+      usleep(GPSREADWAIT * 1000);
+      continue;
+    }
+#endif
+    uint32_t seq = fix.seq;
+    if (updateFix(&fix, inview, buffer, DlMonotonicNs())) {
+      gpsLatest.Store(fix);
+    }
+    if (fix.seq != seq && gpsQueue.Push(fix) && gpsEvent >= 0) {
+      uint64_t one = 1;
+      if (write(gpsEvent, &one, sizeof(one)) < 0) {
+        // The counter only saturates, the fix is queued anyway
+      }
+    }
+  }
+}
+
 /** @brief Initializes GPS Module
  *  @author Paul Moggach
  *  @date 25MAR2019
  *  @param None
  *  @return void
+ *
+ *  Opens the receiver or the replayed capture and starts the background
+ *  reader that keeps the fix cache current.
  */
 extern void DlGpsInit(void) {
 #if SIMGPS
-  fpgps = fopen("gpstestdata.txt", "r");
-  if (fpgps == NULL) {
+  if (DlReplayOpen(&gpsreplay, GPSREPLAYFILE, GPSREPLAYMODE,
+                   GPSREPLAYSPEED) < 0) {
     fprintf(stdout, "Unable to open gps test data file\n");
+    return;
   }
 #else
   // Serial GPS device or GPSD server
-  serial_init();
-  serial_config();
+  if (serial_open(&gpsport, PORTNAME, GPSBAUD) < 0) {
+    perror(PORTNAME);
+    return;
+  }
 #endif
+  if (gpsEvent < 0) {
+    gpsEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  }
+  if (!gpsRunning.exchange(true)) {
+    gpsReader = std::thread(readerTask);
+  }
 }
 
 /** @brief Turns on GPS Module
@@ -43,49 +176,44 @@ extern void DlGpsOn(void) {
   // Write on
 }
 
-/** @brief Compute the GPS location using decimal scale
- *  @author Paul Moggach
- *  @date 25MAR2019
- *  @param void
- *  @return coord loc_t data structure
+/** @brief Get the latest fix without waiting on the receiver.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param fix output fix with the update time of each field group
+ *  @return age of the position in ns, -1 if there has been none yet
  */
-loc_t DlGpsLocation(void) {
-  loc_t cloc = {0.0};
-  char buffer[GPSDATASZ] = {0};
-  uint8_t status = _EMPTY;
-  gpgga_t gpgga;
-  gprmc_t gprmc;
+int64_t DlGpsLatest(gpsfix_t *fix) {
+  gpsLatest.Load(*fix);
+  return (fix->post != 0) ? DlMonotonicNs() - fix->post : -1;
+}
 
-  while (status != _COMPLETED) {
-#if SIMGPS
-    fgets(buffer, NMEAMSGSZ, fpgps);
-    if (feof(fpgps)) {
-      rewind(fpgps);
-    }
-#else
-    serial_readln(buffer, GPSDATASZ);
-#endif
-    switch (nmea_get_message_type(buffer)) {
-    case NMEA_GPGGA:
-      nmea_parse_gpgga(buffer, &gpgga);
-      cloc.utc = gpgga.utc;
-      DlGpsConvertDegToDec(&(gpgga.latitude), gpgga.lat, &(gpgga.longitude),
-                           gpgga.lon);
-      cloc.latitude = gpgga.latitude;
-      cloc.longitude = gpgga.longitude;
-      cloc.altitude = gpgga.altitude;
-      status |= NMEA_GPGGA;
-      break;
-    case NMEA_GPRMC:
-      nmea_parse_gprmc(buffer, &gprmc);
-      cloc.speed = gprmc.speed;
-      cloc.course = gprmc.course;
-      cloc.date = gprmc.date;
-      status |= NMEA_GPRMC;
-      break;
+/** @brief Wait for the next position the receiver sends.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param fix output fix as it stood when that position arrived
+ *  @param timeout ms to wait for one
+ *  @return 1 with a fix, 0 if none arrived in time
+ *
+ *  Positions are handed out in order, one per call, and none is skipped
+ *  unless GPSQUEUESZ of them are left waiting. Only one thread may call
+ *  this.
+ */
+int DlGpsNext(gpsfix_t *fix, int timeout) {
+  if (gpsQueue.Pop(*fix)) {
+    return 1;
+  }
+  if (gpsEvent < 0) {
+    usleep(timeout * 1000);
+    return gpsQueue.Pop(*fix) ? 1 : 0;
+  }
+  struct pollfd pfd = {gpsEvent, POLLIN, 0};
+  if (poll(&pfd, 1, timeout) > 0) {
+    uint64_t count;
+    if (read(gpsEvent, &count, sizeof(count)) < 0) {
+      // Already cleared, the queue tells what arrived
     }
   }
-  return cloc;
+  return gpsQueue.Pop(*fix) ? 1 : 0;
 }
 
 /** @brief Turns Off GPS Module
@@ -93,47 +221,21 @@ loc_t DlGpsLocation(void) {
  *  @date 25MAR2019
  *  @param None
  *  @return void
+ *
+ *  The reader is joined first; it notices the request after the sentence
+ *  or read timeout it is waiting on.
  */
 extern void DlGpsOff(void) {
+  if (gpsRunning.exchange(false)) {
+    gpsReader.join();
+  }
+  if (gpsEvent >= 0) {
+    close(gpsEvent);
+    gpsEvent = -1;
+  }
 #if SIMGPS
-  fclose(fpgps);
+  DlReplayClose(&gpsreplay);
+#else
+  serial_shut(&gpsport);
 #endif
-  //    serial_close();
-}
-
-/** @brief Convert lat e lon to decimals (from deg)
- *  @author Paul Moggach
- *  @date 25MAR2019
- *  @param latitude double *
- *  @param ns char
- *  @param longitude double *
- *  @param we char
- *  @return void
- */
-void DlGpsConvertDegToDec(double *latitude, char ns, double *longitude,
-                          char we) {
-  double lat = (ns == 'N') ? *latitude : -1 * (*latitude);
-  double lon = (we == 'E') ? *longitude : -1 * (*longitude);
-
-  *latitude = DlGpsDegDec(lat);
-  *longitude = DlGpsDegDec(lon);
-}
-
-/** @brief Convert GPS points to decimal
- *  @author Paul Moggach
- *  @date 25MAR2019
- *  @param deg_point double
- *  @return double
- */
-double DlGpsDegDec(double deg_point) {
-  double ddeg;
-  double sec = modf(deg_point, &ddeg) * 60;
-  int deg = (int)(ddeg / 100);
-  int min = (int)(deg_point - (deg * 100));
-
-  double absmlat = round(min * 1000000.);
-  double absslat = round(sec * 1000000.);
-  double absdlat = round(deg * 1000000.);
-
-  return round(absdlat + (absmlat / 60) + (absslat / 3600)) / 1000000;
 }
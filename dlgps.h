@@ -2,36 +2,62 @@
 #define DLGPS_H
 /** @file dlgps.h
  *  @brief Constants, structures, function prototypes for gps functions
+ *
+ *  A background reader parses the receiver stream, or the replayed
+ *  capture, and publishes the latest fix in a SeqLock. DlGpsLatest copies
+ *  it out in constant time and never waits on I/O; the CLOCK_MONOTONIC
+ *  stamps of gpsfix_t tell how fresh each field group is.
+ *  Every new position is also queued, and DlGpsNext hands each one to a
+ *  single consumer as soon as it arrives, however fast the receiver runs.
  */
-#include <cmath>
+#include "dlreplay.h"
+#include <cstdint>
 
-#define round(x) ((x < 0) ? (ceil((x)-0.5)) : (floor((x)+0.5)))
 #define SIMGPS 1
 #define GPSSERIAL 0
 #define GPSDATASZ 256
+#define GPSBAUD 9600 ///< Receiver line rate, up to 921600
+#define GPSREADWAIT 200 ///< ms a receiver read waits before checking for stop
+#define GPSREPLAYFILE "gpstestdata.txt" ///< Capture replayed when SIMGPS
+#define GPSREPLAYMODE DLREPLAY_REALTIME ///< DLREPLAY_* pacing of the capture
+#define GPSREPLAYSPEED 1.0              ///< Speed-up for DLREPLAY_SCALED
+#define GPSQUEUESZ 64 ///< Positions queued for DlGpsNext
 
 typedef struct location
 {
 	double utc;
 	double date;
-    double latitude;
-    double longitude;
-    double speed;
+    int32_t latitude;   ///< Signed 1e-7 degrees, north positive
+    int32_t longitude;  ///< Signed 1e-7 degrees, east positive
+    double speed;       ///< Speed over ground, km/h
     double altitude;
-    double course;
+    double course;      ///< Course over ground, degrees true
+    double hdop;        ///< Horizontal dilution of precision, 0 if unknown
+    double vdop;        ///< Vertical dilution of precision, 0 if unknown
+    double pdop;        ///< Position dilution of precision, 0 if unknown
+    uint8_t quality;    ///< GGA fix quality, 0 no fix
+    uint8_t fixtype;    ///< GSA fix type, 1 none, 2 2D, 3 3D
+    uint8_t satused;    ///< Satellites used in the solution
+    uint8_t satview;    ///< Satellites in view, all systems
 } loc_t;
 
+/// Cached fix, each field group stamped when a sentence last updated it
+typedef struct gpsfix {
+  loc_t loc;       ///< Latest value of every field
+  int64_t post;    ///< Position of the last GGA with a fix, ns
+  int64_t velt;    ///< Speed, course and date (RMC), ns
+  int64_t dopt;    ///< Fix type and DOP (GSA), ns
+  int64_t satt;    ///< Satellites in view (GSV), ns
+  uint32_t seq;    ///< Positions with a fix received, 0 before the first
+  uint32_t errors; ///< Lines failing the checksum or malformed
+} gpsfix_t;
+
 ///\cond INTERNAL
 // Function Prototypes
 extern void DlGpsInit(void);
 extern void DlGpsOn(void);
-loc_t DlGpsLocation(void);
+int64_t DlGpsLatest(gpsfix_t *);
+int DlGpsNext(gpsfix_t *, int);
 extern void DlGpsOff(void);
-// -------------------------------------------------------------------------
-// Internal functions
-// -------------------------------------------------------------------------
-// convert deg to decimal deg latitude, (N/S), longitude, (W/E)
-void DlGpsConvertDegToDec(double *, char, double *, char);
-double DlGpsDegDec(double);
 ///\endcond
 #endif
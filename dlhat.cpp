@@ -0,0 +1,485 @@
+/** @file dlhat.cpp
+ *  @brief Sensor backend selection, and the synthetic and replay backends.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  Each operation of a backend is only ever called from one thread: imu
+ *  from the IMU thread, env from the environmental thread, frame from the
+ *  LED renderer and joystick from the display, so every part of a backend
+ *  state has a single writer.
+ */
+#include "dlhat.h"
+#include "dlclock.h"
+#include "dllog.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define RAD (M_PI / 180)
+#define SPECSZ 256
+
+typedef struct noise {
+  uint64_t s; ///< xorshift state, never 0
+} noise_t;
+
+typedef struct synth {
+  double rate;          ///< IMU samples a second
+  double noise;         ///< Scale of every noise term
+  double vib;           ///< Vibration amplitude, g
+  double tilt;          ///< Roll and pitch swing, degrees
+  double period;        ///< Swing period, s
+  int64_t start;        ///< CLOCK_MONOTONIC ns of sample 0
+  uint64_t next;        ///< Index of the next IMU sample
+  noise_t imunoise;     ///< IMU thread generator
+  noise_t envnoise;     ///< Environmental thread generator
+  uint16_t fb[8][8];    ///< Last frame shown
+} synth_t;
+
+/// One cursor through the records of a replayed segment
+typedef struct cursor {
+  size_t i;      ///< Next record
+  int64_t last;  ///< Capture time of the last sample handed out
+  int64_t shift; ///< Capture ns added by the passes so far
+} cursor_t;
+
+typedef struct replay {
+  dlsegmap_t map;    ///< Mapped segment
+  double speed;      ///< Speed-up, 0 for as fast as read
+  int64_t start;     ///< CLOCK_MONOTONIC ns the replay started
+  int64_t first;     ///< First IMU capture time of the segment
+  int64_t span;      ///< Capture ns of one pass, with the gap to the next
+  cursor_t imu;      ///< IMU thread cursor
+  cursor_t env;      ///< Environmental thread cursor
+  uint16_t fb[8][8]; ///< Last frame shown
+} replay_t;
+
+/** @brief Uniform deviate in (0, 1].
+ */
+static double uniform(noise_t *n) {
+  n->s ^= n->s >> 12;
+  n->s ^= n->s << 25;
+  n->s ^= n->s >> 27;
+  return ((n->s * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0) +
+         (1.0 / 9007199254740992.0);
+}
+
+/** @brief Standard normal deviate.
+ */
+static double gauss(noise_t *n) {
+  return sqrt(-2 * log(uniform(n))) * cos(2 * M_PI * uniform(n));
+}
+
+/** @brief Look up key=value in a comma separated spec.
+ *  @return the value, or def if the key is absent
+ */
+static double specValue(const char *spec, const char *key, double def) {
+  size_t klen = strlen(key);
+
+  for (const char *p = spec; p != NULL && *p != '\0';) {
+    if (strncmp(p, key, klen) == 0 && p[klen] == '=') {
+      return atof(p + klen + 1);
+    }
+    p = strchr(p, ',');
+    p = (p != NULL) ? p + 1 : NULL;
+  }
+  return def;
+}
+
+/** @brief Synthetic IMU samples due since the last call.
+ *
+ *  The unit rolls and pitches around level, the engine shakes it, and
+ *  every axis gets white noise. Samples fall on an exact grid of 1/rate,
+ *  and if the caller falls more than DLHAT_MAXLAG behind, the backlog is
+ *  dropped the way a FIFO would overflow.
+ */
+static int synthImu(dlhat_t *hat, imu_s *batch, int max) {
+  synth_t *sy = (synth_t *)hat->state;
+  int64_t now = DlMonotonicNs();
+  double due = (now - sy->start) / 1e9 * sy->rate;
+  int n = 0;
+
+  if (due - sy->next > DLHAT_MAXLAG / 1e9 * sy->rate) {
+    uint64_t skip = (uint64_t)due - sy->next;
+    hat->lost += skip;
+    sy->next += skip;
+  }
+  while (n < max && (double)sy->next <= due) {
+    double t = sy->next / sy->rate;
+    double w = 2 * M_PI / sy->period;
+    double roll = sy->tilt * RAD * sin(w * t);
+    double pitch = 0.5 * sy->tilt * RAD * sin(0.77 * w * t);
+    double shake = sy->vib * sin(2 * M_PI * 31 * t);
+    double nz = sy->noise;
+    imu_s &imu = batch[n++];
+
+    imu = imu_s{0};
+    imu.t = sy->start + (int64_t)(t * 1e9);
+    imu.xa = (float)(-sin(pitch) + 0.01 * nz * gauss(&sy->imunoise));
+    imu.ya = (float)(sin(roll) * cos(pitch) + 0.01 * nz * gauss(&sy->imunoise));
+    imu.za = (float)(cos(roll) * cos(pitch) + shake +
+                     0.01 * nz * gauss(&sy->imunoise));
+    imu.pitch = (float)(sy->tilt * RAD * w * cos(w * t) +
+                        0.005 * nz * gauss(&sy->imunoise));
+    imu.roll = (float)(0.5 * sy->tilt * RAD * 0.77 * w * cos(0.77 * w * t) +
+                       0.005 * nz * gauss(&sy->imunoise));
+    imu.yaw = (float)(0.005 * nz * gauss(&sy->imunoise));
+    imu.xm = (float)(20 + 0.5 * nz * gauss(&sy->imunoise));
+    imu.ym = (float)(0.5 * nz * gauss(&sy->imunoise));
+    imu.zm = (float)(-45 + 0.5 * nz * gauss(&sy->imunoise));
+    imu.froll = (float)roll;
+    imu.fpitch = (float)pitch;
+    imu.pose = 1;
+    sy->next++;
+  }
+  return n;
+}
+
+/** @brief Synthetic environmental sample, slow drift around the defaults.
+ */
+static int synthEnv(dlhat_t *hat, dlhatenv_t *env) {
+  synth_t *sy = (synth_t *)hat->state;
+  int64_t now = DlMonotonicNs();
+  double t = (now - sy->start) / 1e9;
+  double nz = sy->noise;
+
+  env->t = now;
+  env->rawtemp = (float)(DTEMP + 0.5 * sin(2 * M_PI * t / 600) +
+                         0.05 * nz * gauss(&sy->envnoise));
+  // As far above the sensor as a Pi runs
+  env->cputemp = (float)(DTEMP + 20);
+  env->temperature = DlHatCorrectTemp(env->rawtemp, env->cputemp);
+  env->humidity = (float)(DHUMID + 0.3 * nz * gauss(&sy->envnoise));
+  env->pressure = (float)(DPRESS + 0.2 * sin(2 * M_PI * t / 900) +
+                          0.02 * nz * gauss(&sy->envnoise));
+  return 0;
+}
+
+/** @brief Keep the frame for anyone inspecting the backend.
+ */
+static void synthFrame(dlhat_t *hat, const uint16_t (*frame)[8]) {
+  memcpy(((synth_t *)hat->state)->fb, frame, sizeof(synth_t::fb));
+}
+
+/** @brief No joystick without hardware.
+ */
+static int noJoystick(dlhat_t *hat) { return 0; }
+
+/** @brief Release a malloc'd backend state.
+ */
+static void freeState(dlhat_t *hat) { free(hat->state); }
+
+/** @brief Set up the synthetic backend from its key=value options.
+ *  @return 0 on success, -1 with errno set
+ */
+static int openSynthetic(dlhat_t *hat, const char *opts) {
+  synth_t *sy = (synth_t *)calloc(1, sizeof(synth_t));
+
+  if (sy == NULL) {
+    return -1;
+  }
+  sy->rate = specValue(opts, "rate", 100);
+  sy->noise = specValue(opts, "noise", 1);
+  sy->vib = specValue(opts, "vib", 0.02);
+  sy->tilt = specValue(opts, "tilt", 3);
+  sy->period = specValue(opts, "period", 20);
+  uint64_t seed = (uint64_t)specValue(opts, "seed", 252);
+  if (sy->rate <= 0 || sy->period <= 0) {
+    free(sy);
+    errno = EINVAL;
+    return -1;
+  }
+  sy->imunoise.s = seed * 2 + 1;
+  sy->envnoise.s = seed * 2 + 2;
+  sy->start = DlMonotonicNs();
+  hat->kind = DLHAT_SYNTHETIC;
+  hat->name = "synthetic";
+  hat->imu = synthImu;
+  hat->env = synthEnv;
+  hat->frame = synthFrame;
+  hat->joystick = noJoystick;
+  hat->close = freeState;
+  hat->state = sy;
+  return 0;
+}
+
+/** @brief Replay time of a capture time, CLOCK_MONOTONIC ns.
+ */
+static int64_t replayTime(const replay_t *rp, int64_t capture) {
+  double ofs = (double)(capture - rp->first);
+  return rp->start + (int64_t)((rp->speed > 0) ? ofs / rp->speed : ofs);
+}
+
+/** @brief Move a cursor to the next record, starting a new pass at the end
+ *  of the segment.
+ */
+static void advance(replay_t *rp, cursor_t *c) {
+  if (++c->i == rp->map.nrecs) {
+    c->i = 0;
+    c->shift += rp->span;
+  }
+}
+
+/** @brief Replayed IMU samples due since the last call.
+ *
+ *  Records repeat the last IMU sample when another group triggered them,
+ *  so only records with a new IMU capture time are handed out.
+ */
+static int replayImu(dlhat_t *hat, imu_s *batch, int max) {
+  replay_t *rp = (replay_t *)hat->state;
+  int64_t now = DlMonotonicNs();
+  int n = 0;
+
+  for (size_t seen = 0; n < max && seen < rp->map.nrecs; seen++) {
+    reading_s r;
+    DlSegRead(&rp->map, rp->imu.i, &r);
+    int64_t capture = r.imut + rp->imu.shift;
+    if (r.imut == 0 || capture <= rp->imu.last) {
+      advance(rp, &rp->imu);
+      continue;
+    }
+    int64_t t = replayTime(rp, capture);
+    if (rp->speed > 0 && t > now) {
+      break;
+    }
+    imu_s &imu = batch[n++];
+    imu = imu_s{0};
+    imu.t = t;
+    imu.xa = r.xa;
+    imu.ya = r.ya;
+    imu.za = r.za;
+    imu.pitch = r.pitch;
+    imu.roll = r.roll;
+    imu.yaw = r.yaw;
+    imu.xm = r.xm;
+    imu.ym = r.ym;
+    imu.zm = r.zm;
+    rp->imu.last = capture;
+    advance(rp, &rp->imu);
+  }
+  return n;
+}
+
+/** @brief The latest replayed environmental sample that is due.
+ *
+ *  The records hold the corrected temperature only, so it is handed out
+ *  as both the raw and the corrected value.
+ */
+static int replayEnv(dlhat_t *hat, dlhatenv_t *env) {
+  replay_t *rp = (replay_t *)hat->state;
+  int64_t now = DlMonotonicNs();
+  int found = -1;
+
+  for (size_t seen = 0; seen < rp->map.nrecs; seen++) {
+    reading_s r;
+    DlSegRead(&rp->map, rp->env.i, &r);
+    int64_t capture = r.envt + rp->env.shift;
+    if (r.envt != 0 && capture > rp->env.last) {
+      int64_t t = replayTime(rp, capture);
+      if (rp->speed > 0 && t > now) {
+        break;
+      }
+      env->t = t;
+      // The records hold no CPU temperature, only the corrected value
+      env->rawtemp = env->temperature = r.temperature;
+      env->cputemp = NAN;
+      env->humidity = r.humidity;
+      env->pressure = r.pressure;
+      rp->env.last = capture;
+      found = 0;
+    }
+    advance(rp, &rp->env);
+    if (found == 0 && rp->speed <= 0) {
+      break;
+    }
+  }
+  return found;
+}
+
+/** @brief Keep the frame for anyone inspecting the backend.
+ */
+static void replayFrame(dlhat_t *hat, const uint16_t (*frame)[8]) {
+  memcpy(((replay_t *)hat->state)->fb, frame, sizeof(replay_t::fb));
+}
+
+/** @brief Unmap the segment and release the replay state.
+ */
+static void replayClose(dlhat_t *hat) {
+  replay_t *rp = (replay_t *)hat->state;
+  DlSegUnmap(&rp->map);
+  free(rp);
+}
+
+/** @brief Set up the replay backend from "<segment>[,speed=N]".
+ *  @return 0 on success, -1 with errno set
+ */
+static int openReplay(dlhat_t *hat, const char *opts) {
+  char path[SPECSZ];
+  const char *comma = strchr(opts, ',');
+  size_t len = (comma != NULL) ? (size_t)(comma - opts) : strlen(opts);
+
+  if (len == 0 || len >= sizeof(path)) {
+    errno = EINVAL;
+    return -1;
+  }
+  memcpy(path, opts, len);
+  path[len] = '\0';
+  replay_t *rp = (replay_t *)calloc(1, sizeof(replay_t));
+  if (rp == NULL) {
+    return -1;
+  }
+  if (DlSegMap(&rp->map, path) < 0) {
+    free(rp);
+    errno = (errno != 0) ? errno : EINVAL;
+    return -1;
+  }
+
+  int64_t last = 0;
+  for (size_t i = 0; i < rp->map.nrecs; i++) {
+    reading_s r;
+    DlSegRead(&rp->map, i, &r);
+    if (r.imut != 0 && (rp->first == 0 || r.imut < rp->first)) {
+      rp->first = r.imut;
+    }
+    last = (r.imut > last) ? r.imut : last;
+    last = (r.envt > last) ? r.envt : last;
+  }
+  if (rp->first == 0) {
+    DlSegUnmap(&rp->map);
+    free(rp);
+    errno = ENODATA;
+    return -1;
+  }
+  rp->span = last - rp->first + DLHAT_REPLAYGAP;
+  rp->speed = specValue(comma, "speed", 1);
+  rp->start = DlMonotonicNs();
+  hat->kind = DLHAT_REPLAY;
+  hat->name = "replay";
+  hat->imu = replayImu;
+  hat->env = replayEnv;
+  hat->frame = replayFrame;
+  hat->joystick = noJoystick;
+  hat->close = replayClose;
+  hat->state = rp;
+  return 0;
+}
+
+/** @brief Open the sensor backend named by a spec.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param hat output backend
+ *  @param spec "hardware", "synthetic[:key=value,...]" or
+ *  "replay:<segment>[,speed=N]", see dlhat.h
+ *  @return 0 on success, -1 with errno set if the spec is malformed or the
+ *  backend cannot start, ENOTSUP for hardware when built with HAT=none
+ */
+int DlHatOpen(dlhat_t *hat, const char *spec) {
+  const char *colon = strchr(spec, ':');
+  size_t len = (colon != NULL) ? (size_t)(colon - spec) : strlen(spec);
+  const char *opts = (colon != NULL) ? colon + 1 : "";
+
+  memset(hat, 0, sizeof(*hat));
+  if (len == 8 && strncmp(spec, "hardware", len) == 0) {
+#if DLHAT_HW
+    return DlHatOpenHardware(hat);
+#else
+    errno = ENOTSUP;
+    return -1;
+#endif
+  }
+  if (len == 9 && strncmp(spec, "synthetic", len) == 0) {
+    return openSynthetic(hat, opts);
+  }
+  if (len == 6 && strncmp(spec, "replay", len) == 0) {
+    return openReplay(hat, opts);
+  }
+  errno = EINVAL;
+  return -1;
+}
+
+/** @brief Get the IMU samples produced since the last call.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param hat backend
+ *  @param batch output samples, oldest first
+ *  @param max capacity of batch
+ *  @return number of samples
+ */
+int DlHatImu(dlhat_t *hat, imu_s *batch, int max) {
+  int n = hat->imu(hat, batch, max);
+  hat->imusamples += n;
+  return n;
+}
+
+/** @brief Take one environmental sample: pressure, sensor, CPU and
+ *  corrected temperatures and humidity, all from the same cycle.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param hat backend
+ *  @param env output sample, with the I2C transactions and time the cycle
+ *  took
+ *  @return 0 on success, -1 if the backend has no new sample
+ */
+int DlHatEnv(dlhat_t *hat, dlhatenv_t *env) {
+  int64_t start = DlMonotonicNs();
+
+  env->i2c = 0;
+  if (hat->env(hat, env) < 0) {
+    return -1;
+  }
+  env->ns = (uint32_t)(DlMonotonicNs() - start);
+  hat->envsamples++;
+  hat->envi2c += env->i2c;
+  hat->envns += env->ns;
+  return 0;
+}
+
+/** @brief Correct the SenseHat temperature for the heat of the CPU below
+ *  it.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param senseHatTemp sensor temperature, degrees Celsius
+ *  @param cpuTemp CPU temperature, degrees Celsius, NaN if unknown
+ *  @return corrected temperature, the sensor's if cpuTemp is NaN
+ */
+float DlHatCorrectTemp(float senseHatTemp, float cpuTemp) {
+  if (std::isnan(cpuTemp)) {
+    return senseHatTemp;
+  }
+  // temp_calibrated = temp - ((cpu_temp - temp)/FACTOR)
+  return senseHatTemp - (cpuTemp - senseHatTemp) / (float)DLHAT_TEMPFACTOR;
+}
+
+/** @brief Show a frame on the LED matrix.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param hat backend
+ *  @param frame 8x8 RGB565 pixels, [row][column]
+ *  @return void
+ */
+void DlHatFrame(dlhat_t *hat, const uint16_t (*frame)[8]) {
+  hat->frame(hat, frame);
+  hat->frames++;
+}
+
+/** @brief Read a joystick press without waiting.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param hat backend
+ *  @return key code, 0 if there was none
+ */
+int DlHatJoystick(dlhat_t *hat) { return hat->joystick(hat); }
+
+/** @brief Close the backend.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param hat backend, may be one that never opened
+ *  @return void
+ */
+void DlHatClose(dlhat_t *hat) {
+  if (hat->close != NULL) {
+    hat->close(hat);
+  }
+  memset(hat, 0, sizeof(*hat));
+}
@@ -0,0 +1,86 @@
+#ifndef DLHAT_H
+#define DLHAT_H
+/** @file dlhat.h
+ *  @brief Sensor backends behind the SenseHat: IMU, pressure, humidity,
+ *  LED matrix and joystick.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  The logger reaches the hardware only through a dlhat_t, so the whole
+ *  pipeline runs the same on a Pi and on a machine without one. The
+ *  backend is chosen when the logger starts, from the VDL_HAT environment
+ *  variable or else HATSPEC:
+ *
+ *      hardware                     SenseHat through RTIMULib
+ *      synthetic[:key=value,...]    signal generators and noise
+ *      replay:<segment>[,speed=N]   samples of a recorded log segment
+ *
+ *  Synthetic keys are rate (IMU samples a second, default 100), noise
+ *  (scale of every noise term, default 1), vib (engine vibration, g),
+ *  tilt (roll and pitch swing, degrees), period (of the swing, s) and seed.
+ *  A replay follows the IMU and environmental capture times of the
+ *  records, speed times faster, or as fast as it is read with speed=0, and
+ *  starts over at the end of the segment.
+ *
+ *  The hardware backend is only built with make HAT=hardware, the default
+ *  where RTIMULib is installed. Without it, HATSPEC falls back to
+ *  synthetic and a hardware spec fails with ENOTSUP.
+ */
+#include "logger.h"
+#include <cstdint>
+
+// Backends
+#define DLHAT_HARDWARE 0  ///< SenseHat through RTIMULib and the Linux devices
+#define DLHAT_SYNTHETIC 1 ///< Signal generators and noise
+#define DLHAT_REPLAY 2    ///< Samples of a recorded log segment
+
+#define DLHAT_ENV "VDL_HAT"           ///< Environment variable for the spec
+#define DLHAT_MAXLAG 1000000000LL    ///< ns of IMU samples a backend holds
+#define DLHAT_REPLAYGAP 1000000000LL ///< ns between passes of a replay
+#define DLHAT_TEMPFACTOR 1.2         ///< CPU heating of the sensor
+#define DLHAT_I2CREAD 3              ///< I2C transactions of one sensor read
+
+/// Environmental sample, every value from the same cycle
+typedef struct dlhatenv {
+  int64_t t;         ///< Capture time, CLOCK_MONOTONIC ns
+  float rawtemp;     ///< Sensor temperature, degrees Celsius, NaN if not read
+  float cputemp;     ///< CPU temperature, degrees Celsius, NaN if none
+  float temperature; ///< Corrected for the heat of the CPU, degrees Celsius
+  float humidity;    ///< Per cent relative humidity, NaN if not read
+  float pressure;    ///< hPa, NaN if not read
+  uint32_t i2c;      ///< I2C transactions of the cycle
+  uint32_t ns;       ///< Time the cycle took
+} dlhatenv_t;
+
+typedef struct dlhat dlhat_t;
+
+/// Backend operations and state
+struct dlhat {
+  int kind;                            ///< DLHAT_*
+  const char *name;                    ///< Backend name
+  int (*imu)(dlhat_t *, imu_s *, int); ///< Samples since the last call
+  int (*env)(dlhat_t *, dlhatenv_t *); ///< One sample, 0 or -1
+  void (*frame)(dlhat_t *, const uint16_t (*)[8]); ///< Show 8x8 RGB565
+  int (*joystick)(dlhat_t *);          ///< Key code of a press, 0 for none
+  void (*close)(dlhat_t *);            ///< Release the state
+  void *state;                         ///< Backend state
+  uint64_t imusamples;                 ///< IMU samples handed out
+  uint64_t envsamples;                 ///< Environmental samples handed out
+  uint64_t envi2c;                     ///< I2C transactions of those samples
+  uint64_t envns;                      ///< Time taken by those samples
+  uint64_t frames;                     ///< Frames shown
+  uint64_t lost;                       ///< IMU samples the backend dropped
+};
+
+///\cond INTERNAL
+// Function Prototypes
+int DlHatOpen(dlhat_t *, const char *);
+int DlHatImu(dlhat_t *, imu_s *, int);
+int DlHatEnv(dlhat_t *, dlhatenv_t *);
+float DlHatCorrectTemp(float, float);
+void DlHatFrame(dlhat_t *, const uint16_t (*)[8]);
+int DlHatJoystick(dlhat_t *);
+void DlHatClose(dlhat_t *);
+int DlHatOpenHardware(dlhat_t *);
+///\endcond
+#endif
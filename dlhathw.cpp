@@ -0,0 +1,106 @@
+/** @file dlhathw.cpp
+ *  @brief SenseHat hardware backend.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlhat.h"
+#include "dlclock.h"
+#include "sensehat.h"
+#include <cmath>
+#include <time.h>
+
+/** @brief Every sample waiting in the IMU FIFO, up to max.
+ */
+static int hwImu(dlhat_t *hat, imu_s *batch, int max) {
+  SenseHat *sh = (SenseHat *)hat->state;
+  RTIMU_DATA data[IMUBATCH];
+  struct timespec rt;
+  int64_t now = DlMonotonicNs();
+
+  clock_gettime(CLOCK_REALTIME, &rt);
+  // RTIMULib stamps samples in system clock microseconds
+  int64_t ofs = (int64_t)rt.tv_sec * 1000000000 + rt.tv_nsec - now;
+  int n = sh->GetImuBatch(data, (max < IMUBATCH) ? max : IMUBATCH);
+  for (int i = 0; i < n; i++) {
+    imu_s &imu = batch[i];
+    int64_t t = (int64_t)data[i].timestamp * 1000 - ofs;
+    imu = imu_s{0};
+    imu.t = (data[i].timestamp == 0 || t > now) ? now : t;
+    imu.xa = data[i].accel.x();
+    imu.ya = data[i].accel.y();
+    imu.za = data[i].accel.z();
+    imu.pitch = data[i].gyro.x();
+    imu.roll = data[i].gyro.y();
+    imu.yaw = data[i].gyro.z();
+    imu.xm = data[i].compass.x();
+    imu.ym = data[i].compass.y();
+    imu.zm = data[i].compass.z();
+    imu.pose = data[i].fusionPoseValid;
+    if (imu.pose) {
+      imu.froll = data[i].fusionPose.x();
+      imu.fpitch = data[i].fusionPose.y();
+      imu.fyaw = data[i].fusionPose.z();
+    }
+  }
+  return n;
+}
+
+/** @brief One combined environmental cycle.
+ *
+ *  The HTS221 and the LPS25H are each read once, which gives humidity,
+ *  pressure and the sensor temperature together, and the CPU temperature
+ *  comes from the thermal zone SenseHat keeps open. A read with fresh data
+ *  is a status transaction and two output bursts; one that fails stops
+ *  after the status.
+ */
+static int hwEnv(dlhat_t *hat, dlhatenv_t *env) {
+  SenseHat *sh = (SenseHat *)hat->state;
+  RTIMU_DATA data;
+
+  env->t = DlMonotonicNs();
+  int reads = sh->GetEnvironment(data);
+  env->i2c = reads * DLHAT_I2CREAD + (2 - reads);
+  env->cputemp = sh->getCpuTemperature();
+  env->rawtemp = data.temperatureValid ? data.temperature : NAN;
+  env->temperature = DlHatCorrectTemp(env->rawtemp, env->cputemp);
+  env->humidity = data.humidityValid ? data.humidity : NAN;
+  env->pressure = data.pressureValid ? data.pressure : NAN;
+  return 0;
+}
+
+/** @brief Copy a frame to the LED framebuffer.
+ */
+static void hwFrame(dlhat_t *hat, const uint16_t (*frame)[8]) {
+  ((SenseHat *)hat->state)->ViewFrame(frame);
+}
+
+/** @brief Next joystick press.
+ */
+static int hwJoystick(dlhat_t *hat) {
+  return ((SenseHat *)hat->state)->ScanJoystick();
+}
+
+/** @brief Release the SenseHat.
+ */
+static void hwClose(dlhat_t *hat) { delete (SenseHat *)hat->state; }
+
+/** @brief Open the SenseHat through RTIMULib and the Linux devices.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param hat output backend
+ *  @return 0
+ *
+ *  SenseHat retries each device and ends the program if one never comes
+ *  up, so this only returns once the hardware is ready.
+ */
+int DlHatOpenHardware(dlhat_t *hat) {
+  hat->kind = DLHAT_HARDWARE;
+  hat->name = "hardware";
+  hat->imu = hwImu;
+  hat->env = hwEnv;
+  hat->frame = hwFrame;
+  hat->joystick = hwJoystick;
+  hat->close = hwClose;
+  hat->state = new SenseHat();
+  return 0;
+}
@@ -0,0 +1,214 @@
+/** @file dlindex.cpp
+ *  @brief Sparse segment index and catalog functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlindex.h"
+#include "dllog.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+/** @brief Note one appended record.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param idx index being built
+ *  @param rtime rtime of the record
+ *  @return void
+ *
+ *  An entry that cannot be allocated is skipped; the index then only
+ *  covers less of the segment and a query reads a few more records.
+ */
+void DlIndexAdd(dlidx_t *idx, int64_t rtime) {
+  if (idx->nrecs == 0) {
+    idx->first = rtime;
+  }
+  if (idx->nrecs % DLIDX_EVERY == 0) {
+    if (idx->nents == idx->cap) {
+      uint32_t cap = (idx->cap == 0) ? 64 : idx->cap * 2;
+      dlidxent_t *ents =
+          (dlidxent_t *)realloc(idx->ents, cap * sizeof(dlidxent_t));
+      if (ents != NULL) {
+        idx->ents = ents;
+        idx->cap = cap;
+      }
+    }
+    if (idx->nents < idx->cap) {
+      idx->ents[idx->nents++] = dlidxent_t{rtime, idx->nrecs, 0};
+    }
+  }
+  idx->last = rtime;
+  idx->nrecs++;
+}
+
+/** @brief Release an index and clear it for reuse.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param idx index
+ *  @return void
+ */
+void DlIndexFree(dlidx_t *idx) {
+  free(idx->ents);
+  memset(idx, 0, sizeof(*idx));
+}
+
+/** @brief Index file name of a segment, compressed or not.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param segpath segment file
+ *  @param out output path
+ *  @param size size of out
+ *  @return 0 on success, -1 if out is too small
+ */
+int DlIndexPath(const char *segpath, char *out, size_t size) {
+  size_t len = strlen(segpath);
+  size_t zlen = strlen(DLSEG_ZSUFFIX);
+
+  if (len > zlen && strcmp(segpath + len - zlen, DLSEG_ZSUFFIX) == 0) {
+    len -= zlen;
+  }
+  if (len + sizeof(DLIDX_SUFFIX) > size) {
+    return -1;
+  }
+  memcpy(out, segpath, len);
+  memcpy(out + len, DLIDX_SUFFIX, sizeof(DLIDX_SUFFIX));
+  return 0;
+}
+
+/** @brief Write the index file of a segment.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param segpath segment file
+ *  @param idx index of the segment
+ *  @return 0 on success, -1 on error
+ */
+int DlIndexWrite(const char *segpath, const dlidx_t *idx) {
+  char path[DLSEG_PATHSZ + sizeof(DLIDX_SUFFIX)];
+  dlidxhdr_t hdr;
+  int fd;
+
+  if (DlIndexPath(segpath, path, sizeof(path)) < 0) {
+    return -1;
+  }
+  memset(&hdr, 0, sizeof(hdr));
+  hdr.magic = DLIDX_MAGIC;
+  hdr.version = DLIDX_VERSION;
+  hdr.every = DLIDX_EVERY;
+  hdr.nrecs = idx->nrecs;
+  hdr.nents = idx->nents;
+  hdr.first = idx->first;
+  hdr.last = idx->last;
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return -1;
+  }
+  size_t len = idx->nents * sizeof(dlidxent_t);
+  int status = (write(fd, &hdr, sizeof(hdr)) == (ssize_t)sizeof(hdr) &&
+                write(fd, idx->ents, len) == (ssize_t)len)
+                   ? 0
+                   : -1;
+  close(fd);
+  if (status < 0) {
+    unlink(path);
+  }
+  return status;
+}
+
+/** @brief Read the index file of a segment.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param segpath segment file
+ *  @param idx output index, release with DlIndexFree
+ *  @return 0 on success, -1 if there is no valid index
+ */
+int DlIndexLoad(const char *segpath, dlidx_t *idx) {
+  char path[DLSEG_PATHSZ + sizeof(DLIDX_SUFFIX)];
+  dlidxhdr_t hdr;
+  int fd;
+
+  memset(idx, 0, sizeof(*idx));
+  if (DlIndexPath(segpath, path, sizeof(path)) < 0 ||
+      (fd = open(path, O_RDONLY)) < 0) {
+    return -1;
+  }
+  if (read(fd, &hdr, sizeof(hdr)) != (ssize_t)sizeof(hdr) ||
+      hdr.magic != DLIDX_MAGIC || hdr.version != DLIDX_VERSION) {
+    close(fd);
+    return -1;
+  }
+  size_t len = hdr.nents * sizeof(dlidxent_t);
+  idx->ents = (dlidxent_t *)malloc(len + 1);
+  if (idx->ents == NULL || read(fd, idx->ents, len) != (ssize_t)len) {
+    close(fd);
+    DlIndexFree(idx);
+    return -1;
+  }
+  close(fd);
+  idx->nents = idx->cap = hdr.nents;
+  idx->nrecs = hdr.nrecs;
+  idx->first = hdr.first;
+  idx->last = hdr.last;
+  return 0;
+}
+
+/** @brief Find where to start reading for a time.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param idx index of the segment
+ *  @param rtime start of the wanted range
+ *  @return record number of the last index entry before rtime, 0 if there
+ *  is none; the first record at or after rtime is at most DLIDX_EVERY
+ *  records further
+ */
+uint32_t DlIndexSeek(const dlidx_t *idx, int64_t rtime) {
+  uint32_t lo = 0;
+  uint32_t hi = idx->nents;
+
+  // First entry at or after rtime
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (idx->ents[mid].rtime < rtime) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return (lo == 0) ? 0 : idx->ents[lo - 1].rec;
+}
+
+/** @brief Add a closed segment to the catalog of its directory.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param dir log directory
+ *  @param seq segment sequence number
+ *  @param segpath segment file
+ *  @param idx index of the segment
+ *  @return 0 on success, -1 on error
+ */
+int DlCatalogAppend(const char *dir, uint32_t seq, const char *segpath,
+                    const dlidx_t *idx) {
+  char path[DLSEG_PATHSZ + sizeof(DLCAT_FILE)];
+  const char *name = strrchr(segpath, '/');
+  dlcatent_t ent;
+  int fd;
+
+  memset(&ent, 0, sizeof(ent));
+  ent.seq = seq;
+  ent.nrecs = idx->nrecs;
+  ent.first = idx->first;
+  ent.last = idx->last;
+  name = (name != NULL) ? name + 1 : segpath;
+  snprintf(ent.name, sizeof(ent.name), "%s", name);
+  snprintf(path, sizeof(path), "%s/" DLCAT_FILE, dir);
+  fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) {
+    return -1;
+  }
+  // One write per entry so a reader never sees half of one
+  ssize_t n = write(fd, &ent, sizeof(ent));
+  close(fd);
+  return (n == (ssize_t)sizeof(ent)) ? 0 : -1;
+}
@@ -0,0 +1,71 @@
+#ifndef DLINDEX_H
+#define DLINDEX_H
+/** @file dlindex.h
+ *  @brief Sparse time index of log segments and the segment catalog.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  While a segment is written, the rtime of every DLIDX_EVERY-th record is
+ *  noted. When the segment is closed the notes go to a <segment>.idx file
+ *  next to it, and a dlcatent_t with the time range of the segment is
+ *  appended to the catalog of the log directory. A query binary searches
+ *  the catalog for the first segment of a time range, then that segment's
+ *  index for the first record, so the work does not grow with the size of
+ *  the archive. Records are fixed width, so a record number is also a byte
+ *  offset: hdrsize + rec * recsize.
+ */
+#include <cstddef>
+#include <cstdint>
+
+#define DLIDX_MAGIC 0x58444944 // "DIDX"
+#define DLIDX_VERSION 1
+#define DLIDX_EVERY 256
+#define DLIDX_SUFFIX ".idx"
+#define DLCAT_FILE "loggerdata.cat"
+#define DLCAT_NAMESZ 64
+
+typedef struct dlidxent {
+  int64_t rtime; ///< rtime of the record
+  uint32_t rec;  ///< Record number within the segment
+  uint32_t reserved;
+} dlidxent_t;
+
+typedef struct dlidxhdr {
+  uint32_t magic;   ///< DLIDX_MAGIC
+  uint16_t version; ///< DLIDX_VERSION
+  uint16_t every;   ///< Records between entries
+  uint32_t nrecs;   ///< Records in the segment
+  uint32_t nents;   ///< Entries following this header
+  int64_t first;    ///< rtime of the first record
+  int64_t last;     ///< rtime of the last record
+} dlidxhdr_t;
+
+/// Index being built for, or loaded from, one segment
+typedef struct dlidx {
+  dlidxent_t *ents; ///< Entries, malloc owned
+  uint32_t nents;   ///< Entries in use
+  uint32_t cap;     ///< Entries allocated
+  uint32_t nrecs;   ///< Records seen
+  int64_t first;    ///< rtime of the first record
+  int64_t last;     ///< rtime of the last record
+} dlidx_t;
+
+typedef struct dlcatent {
+  uint32_t seq;             ///< Segment sequence number
+  uint32_t nrecs;           ///< Records in the segment
+  int64_t first;            ///< rtime of the first record
+  int64_t last;             ///< rtime of the last record
+  char name[DLCAT_NAMESZ];  ///< Segment file name, without .gz
+} dlcatent_t;
+
+///\cond INTERNAL
+// Function Prototypes
+void DlIndexAdd(dlidx_t *, int64_t);
+void DlIndexFree(dlidx_t *);
+int DlIndexPath(const char *, char *, size_t);
+int DlIndexWrite(const char *, const dlidx_t *);
+int DlIndexLoad(const char *, dlidx_t *);
+uint32_t DlIndexSeek(const dlidx_t *, int64_t);
+int DlCatalogAppend(const char *, uint32_t, const char *, const dlidx_t *);
+///\endcond
+#endif
@@ -0,0 +1,279 @@
+/** @file dlled.cpp
+ *  @brief LED matrix renderer functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlled.h"
+#include "dlsched.h"
+#include "font.h"
+#include "spsc.h"
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+typedef int (*tiltsrc_t)(float *, float *);
+
+static const uint16_t logo[8][8] = {
+    HB, HB, HB, HB, HB, HB, HB, HB, HB, HB, HW, HB, HB, HW, HB, HY,
+    HB, HB, HW, HB, HB, HW, HY, HY, HB, HB, HW, HB, HB, HW, HY, HY,
+    HB, HB, HW, HW, HW, HW, HY, HY, HB, HB, HW, HY, HY, HW, HY, HY,
+    HB, HY, HW, HY, HY, HW, HY, HY, HY, HY, HY, HY, HY, HY, HY, HY,
+};
+
+// Scene, each part written by any thread and read once a frame
+static std::atomic<int> scene(DLLED_BLANK);
+static std::atomic<uint64_t> level(0); ///< xa and ya floats, packed
+static std::atomic<tiltsrc_t> tilt(nullptr);
+static std::atomic<uint16_t> glyphs[DLLED_GLYPHS];
+
+// Messages waiting to scroll, from the one thread that queues text
+static SpscRing<dlledtext_t, DLLED_TEXTQ> texts;
+
+static std::atomic<bool> running(false);
+static std::atomic<uint64_t> frameCount(0);
+static std::atomic<uint64_t> commitCount(0);
+static std::atomic<uint64_t> textCount(0);
+static std::thread renderThread;
+static dlhat_t *matrix;
+static int64_t framePeriod;
+
+/** @brief Draw the spirit level bubble for a tilt in g.
+ */
+static void drawLevel(uint16_t (*frame)[8], float xa, float ya) {
+  int x = (int)(ya * -30.0 + 4);
+  int y = (int)(xa * -30.0 + 4);
+
+  x = (x < 0) ? 0 : (x > 6) ? 6 : x;
+  y = (y < 0) ? 0 : (y > 6) ? 6 : y;
+  frame[x][y] = HY;
+  frame[x + 1][y] = HY;
+  frame[x][y + 1] = HY;
+  frame[x + 1][y + 1] = HY;
+}
+
+/** @brief Compose the current scene and status glyphs off screen.
+ */
+static void compose(uint16_t (*frame)[8]) {
+  switch (scene.load(std::memory_order_relaxed)) {
+  case DLLED_LOGO:
+    memcpy(frame, logo, sizeof(logo));
+    break;
+  case DLLED_LEVEL: {
+    float xa, ya;
+    tiltsrc_t src = tilt.load(std::memory_order_acquire);
+    memset(frame, 0, sizeof(logo));
+    if (src == nullptr || src(&xa, &ya) < 0) {
+      uint64_t packed = level.load(std::memory_order_relaxed);
+      uint32_t half = (uint32_t)packed;
+      memcpy(&xa, &half, sizeof(xa));
+      half = (uint32_t)(packed >> 32);
+      memcpy(&ya, &half, sizeof(ya));
+    }
+    drawLevel(frame, xa, ya);
+    break;
+  }
+  default:
+    memset(frame, 0, sizeof(logo));
+    break;
+  }
+
+  static const int corner[DLLED_GLYPHS][2] = {{0, 0}, {0, 7}, {7, 0}, {7, 7}};
+  for (int i = 0; i < DLLED_GLYPHS; i++) {
+    uint16_t color = glyphs[i].load(std::memory_order_relaxed);
+    if (color != 0) {
+      frame[corner[i][0]][corner[i][1]] = color;
+    }
+  }
+}
+
+/** @brief Draw the 8-column window of a message strip starting at column
+ *  first; columns past the end are background.
+ */
+static void drawText(uint16_t (*frame)[8], const dlledtext_t *text,
+                     uint32_t first) {
+  for (int k = 0; k < 8; k++) {
+    uint8_t column = (first + k < text->n) ? text->strip[first + k] : 0;
+    for (int j = 0; j < 8; j++) {
+      frame[j][k] = (column >> j & 1) ? text->fg : text->bg;
+    }
+  }
+}
+
+/** @brief Renderer thread, one frame per period.
+ *
+ *  The shown frame is kept so an unchanged frame is never copied out
+ *  again. The first frame is always shown, whatever was on the matrix.
+ *  While a message is scrolling its window replaces the scene; the window
+ *  starts on the first column and follows the time since the message
+ *  started, so it keeps its pace at any frame rate.
+ */
+static void renderTask(void) {
+  static dlledtext_t text;
+  dlchan_t ch;
+  uint16_t frame[8][8];
+  uint16_t shown[8][8];
+  bool any = false;
+  bool scrolling = false;
+  int64_t started = 0;
+
+  DlChanInit(&ch, "led", framePeriod);
+  while (running.load(std::memory_order_relaxed)) {
+    if (DlSchedWait(&ch, 1) < 0) {
+      continue;
+    }
+    if (!scrolling && texts.Pop(text)) {
+      scrolling = true;
+      started = ch.next - framePeriod;
+    }
+    if (scrolling) {
+      int64_t first = (ch.next - framePeriod - started) / text.colns;
+      if (first >= text.n) {
+        scrolling = false;
+        textCount.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        drawText(frame, &text, (uint32_t)first);
+      }
+    }
+    if (!scrolling) {
+      compose(frame);
+    }
+    frameCount.fetch_add(1, std::memory_order_relaxed);
+    if (any && memcmp(frame, shown, sizeof(frame)) == 0) {
+      continue;
+    }
+    DlHatFrame(matrix, frame);
+    memcpy(shown, frame, sizeof(frame));
+    any = true;
+    commitCount.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+/** @brief Start the renderer thread.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param hat backend whose LED matrix is drawn, used by no other thread
+ *  while the renderer runs
+ *  @param fps frames a second
+ *  @return 0 on success, -1 if the renderer is already running
+ */
+int DlLedStart(dlhat_t *hat, int fps) {
+  if (fps <= 0 || running.exchange(true)) {
+    return -1;
+  }
+  matrix = hat;
+  framePeriod = 1000000000LL / fps;
+  renderThread = std::thread(renderTask);
+  return 0;
+}
+
+/** @brief Stop the renderer thread, leaving the last frame shown.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return void
+ */
+void DlLedStop(void) {
+  if (!running.exchange(false)) {
+    return;
+  }
+  renderThread.join();
+}
+
+/** @brief Select the scene, from any thread, without waiting.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param id DLLED_BLANK, DLLED_LOGO or DLLED_LEVEL
+ *  @return void
+ */
+void DlLedScene(int id) { scene.store(id, std::memory_order_relaxed); }
+
+/** @brief Set the spirit level tilt and show the level.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param xa x acceleration, g
+ *  @param ya y acceleration, g
+ *  @return void
+ *
+ *  A tilt source set with DlLedTilt takes precedence while it has samples.
+ */
+void DlLedLevel(float xa, float ya) {
+  uint32_t x, y;
+
+  memcpy(&x, &xa, sizeof(x));
+  memcpy(&y, &ya, sizeof(y));
+  level.store((uint64_t)y << 32 | x, std::memory_order_relaxed);
+  scene.store(DLLED_LEVEL, std::memory_order_relaxed);
+}
+
+/** @brief Have the spirit level follow a tilt source.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param src called by the renderer once a frame for the x and y
+ *  acceleration in g, returning -1 while it has no sample; NULL to use
+ *  DlLedLevel values only. It must not block.
+ *  @return void
+ */
+void DlLedTilt(int (*src)(float *, float *)) {
+  tilt.store(src, std::memory_order_release);
+}
+
+/** @brief Light or clear a status glyph.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param id DLLED_GPS, DLLED_FENCE, DLLED_LOG or DLLED_USER
+ *  @param color RGB565 colour, 0 to clear
+ *  @return void
+ */
+void DlLedStatus(int id, uint16_t color) {
+  if (id >= 0 && id < DLLED_GLYPHS) {
+    glyphs[id].store(color, std::memory_order_relaxed);
+  }
+}
+
+/** @brief Queue a message to scroll across the LED matrix.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param message text, UTF-8 accented letters included
+ *  @param ms time each column takes to scroll by
+ *  @param fg RGB565 text colour
+ *  @param bg RGB565 background colour
+ *  @return 0, -1 if DLLED_TEXTQ messages are already waiting
+ *
+ *  The text is rendered here, into a strip of the lit columns of each
+ *  glyph followed by one blank column, cut at DLLED_TEXTCOLS. It never
+ *  waits on the renderer. Only one thread may queue messages.
+ */
+int DlLedText(const char *message, int ms, uint16_t fg, uint16_t bg) {
+  dlledtext_t text;
+
+  text.n = 0;
+  for (const char *p = message; *p != '\0'; p++) {
+    uint8_t c = (uint8_t)*p;
+    // Accented letters are two bytes, 195 then the code in the font
+    if (c == 195) {
+      continue;
+    }
+    if (text.n + atlas.width[c] + 1 > DLLED_TEXTCOLS) {
+      break;
+    }
+    memcpy(text.strip + text.n, atlas.columns[c] + atlas.first[c],
+           atlas.width[c]);
+    text.n += atlas.width[c];
+    text.strip[text.n++] = 0;
+  }
+  text.colns = (int64_t)((ms > 0) ? ms : 1) * 1000000;
+  text.fg = fg;
+  text.bg = bg;
+  return texts.Push(text) ? 0 : -1;
+}
+
+/** @brief Get the renderer counters.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param stats output counters
+ *  @return void
+ */
+void DlLedStats(dlledstats_t *stats) {
+  stats->frames = frameCount.load(std::memory_order_relaxed);
+  stats->commits = commitCount.load(std::memory_order_relaxed);
+  stats->texts = textCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,72 @@
+#ifndef DLLED_H
+#define DLLED_H
+/** @file dlled.h
+ *  @brief LED matrix renderer thread.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  Only the renderer thread ever writes the LED matrix. On every frame it
+ *  composes the current scene into an off-screen 8x8 RGB565 frame and
+ *  hands it to the backend as one 128-byte copy, and only when it differs
+ *  from the frame already shown, so the matrix never shows a half-drawn
+ *  frame and a still scene costs no framebuffer writes.
+ *
+ *  Callers change the scene from any thread without waiting: each part of
+ *  it is a separate atomic the renderer reads once per frame. The spirit
+ *  level can follow a tilt source, normally the latest IMU sample the
+ *  pipeline publishes, which the renderer reads itself at the frame rate,
+ *  so the level moves with the IMU without any work on the sampling path.
+ *
+ *  Status glyphs are single pixels in the corners, drawn over the scene.
+ *
+ *  A text message is rendered once, by the caller, into a strip of glyph
+ *  columns and queued for the renderer, which shows an 8-column window of
+ *  it in place of the scene and slides the window one column per column
+ *  period until the message has gone by. Messages play in the order they
+ *  were queued and must all come from one thread.
+ */
+#include "dlhat.h"
+#include <cstdint>
+
+// Scenes
+#define DLLED_BLANK 0 ///< All LEDs off
+#define DLLED_LOGO 1  ///< Logger logo
+#define DLLED_LEVEL 2 ///< Spirit level
+
+// Status glyphs, one corner each
+#define DLLED_GPS 0   ///< Top left
+#define DLLED_FENCE 1 ///< Top right
+#define DLLED_LOG 2   ///< Bottom left
+#define DLLED_USER 3  ///< Bottom right
+#define DLLED_GLYPHS 4
+
+#define DLLED_TEXTCOLS 1024 ///< Columns of one message strip, about 170 chars
+#define DLLED_TEXTQ 4       ///< Messages waiting to scroll
+
+/// Message rendered to a strip, one byte per column, bit j lit row j
+typedef struct dlledtext {
+  uint8_t strip[DLLED_TEXTCOLS]; ///< Glyph columns
+  uint32_t n;                    ///< Columns in strip
+  int64_t colns;                 ///< ns per column scrolled
+  uint16_t fg;                   ///< RGB565 text colour
+  uint16_t bg;                   ///< RGB565 background colour
+} dlledtext_t;
+
+typedef struct dlledstats {
+  uint64_t frames;  ///< Frames composed
+  uint64_t commits; ///< Frames that changed and were shown
+  uint64_t texts;   ///< Messages scrolled
+} dlledstats_t;
+
+///\cond INTERNAL
+// Function Prototypes
+int DlLedStart(dlhat_t *, int);
+void DlLedStop(void);
+void DlLedScene(int);
+void DlLedLevel(float, float);
+void DlLedTilt(int (*)(float *, float *));
+void DlLedStatus(int, uint16_t);
+int DlLedText(const char *, int, uint16_t, uint16_t);
+void DlLedStats(dlledstats_t *);
+///\endcond
+#endif
@@ -0,0 +1,552 @@
+/** @file dllog.cpp
+ *  @brief Binary segment log functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dllog.h"
+#include "dlformat.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#define FIELD(n, t)                                                            \
+  { #n, t, (uint8_t)offsetof(dlrecord_t, n), 0 }
+
+static const dlfield_t fieldLayout[DLSEG_FIELDS] = {
+    FIELD(rtime, DLF_I64),     FIELD(temperature, DLF_F32),
+    FIELD(humidity, DLF_F32),  FIELD(pressure, DLF_F32),
+    FIELD(xa, DLF_F32),        FIELD(ya, DLF_F32),
+    FIELD(za, DLF_F32),        FIELD(pitch, DLF_F32),
+    FIELD(roll, DLF_F32),      FIELD(yaw, DLF_F32),
+    FIELD(xm, DLF_F32),        FIELD(ym, DLF_F32),
+    FIELD(zm, DLF_F32),        FIELD(latitude, DLF_F32),
+    FIELD(longitude, DLF_F32), FIELD(altitude, DLF_F32),
+    FIELD(speed, DLF_F32),     FIELD(heading, DLF_F32),
+    FIELD(imut, DLF_I64),      FIELD(envt, DLF_I64),
+    FIELD(gpst, DLF_I64),      FIELD(wallofs, DLF_I64),
+    FIELD(lat7, DLF_I32),      FIELD(lon7, DLF_I32),
+    FIELD(fence, DLF_I32),     FIELD(fenceev, DLF_I32),
+};
+
+/** @brief Copy a reading into its on-disk record.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param r reading
+ *  @param rec output record
+ *  @return void
+ */
+void DlLogPack(const reading_s *r, dlrecord_t *rec) {
+  rec->rtime = (int64_t)r->rtime;
+  rec->temperature = r->temperature;
+  rec->humidity = r->humidity;
+  rec->pressure = r->pressure;
+  rec->xa = r->xa;
+  rec->ya = r->ya;
+  rec->za = r->za;
+  rec->pitch = r->pitch;
+  rec->roll = r->roll;
+  rec->yaw = r->yaw;
+  rec->xm = r->xm;
+  rec->ym = r->ym;
+  rec->zm = r->zm;
+  rec->latitude = (float)((double)r->latitude / DLDEGE7);
+  rec->longitude = (float)((double)r->longitude / DLDEGE7);
+  rec->altitude = r->altitude;
+  rec->speed = r->speed;
+  rec->heading = r->heading;
+  rec->reserved = 0;
+  rec->imut = r->imut;
+  rec->envt = r->envt;
+  rec->gpst = r->gpst;
+  rec->wallofs = r->wallofs;
+  rec->lat7 = r->latitude;
+  rec->lon7 = r->longitude;
+  rec->fence = r->fence;
+  rec->fenceev = r->fenceev;
+}
+
+/** @brief Copy an on-disk record back into a reading.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param rec record
+ *  @param r output reading
+ *  @return void
+ */
+void DlLogUnpack(const dlrecord_t *rec, reading_s *r) {
+  r->rtime = (time_t)rec->rtime;
+  r->temperature = rec->temperature;
+  r->humidity = rec->humidity;
+  r->pressure = rec->pressure;
+  r->xa = rec->xa;
+  r->ya = rec->ya;
+  r->za = rec->za;
+  r->pitch = rec->pitch;
+  r->roll = rec->roll;
+  r->yaw = rec->yaw;
+  r->xm = rec->xm;
+  r->ym = rec->ym;
+  r->zm = rec->zm;
+  r->latitude = rec->lat7;
+  r->longitude = rec->lon7;
+  r->altitude = rec->altitude;
+  r->speed = rec->speed;
+  r->heading = rec->heading;
+  r->imut = rec->imut;
+  r->envt = rec->envt;
+  r->gpst = rec->gpst;
+  r->wallofs = rec->wallofs;
+  r->fence = rec->fence;
+  r->fenceev = rec->fenceev;
+}
+
+/** @brief Fill in a segment header for the current schema.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param hdr output header
+ *  @param serial unit serial
+ *  @param created creation time, epoch seconds
+ *  @return void
+ */
+void DlLogInitHeader(dlseghdr_t *hdr, uint64_t serial, int64_t created) {
+  memset(hdr, 0, sizeof(*hdr));
+  hdr->magic = DLSEG_MAGIC;
+  hdr->version = DLSEG_VERSION;
+  hdr->hdrsize = sizeof(dlseghdr_t);
+  hdr->serial = serial;
+  hdr->created = created;
+  hdr->recsize = sizeof(dlrecord_t);
+  hdr->nfields = DLSEG_FIELDS;
+  memcpy(hdr->fields, fieldLayout, sizeof(fieldLayout));
+}
+
+/** @brief Write a whole buffer, retrying short writes.
+ *  @return 0 on success, -1 on error
+ */
+static int writeAll(int fd, const void *buf, size_t len) {
+  const uint8_t *p = (const uint8_t *)buf;
+  while (len > 0) {
+    ssize_t n = write(fd, p, len);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    p += n;
+    len -= n;
+  }
+  return 0;
+}
+
+/** @brief Split a segment file name into its sequence number and state.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param name file name without directory
+ *  @param seq output sequence number
+ *  @param compressed output, 1 for a .gz segment
+ *  @return 1 if name is a log segment, 0 otherwise
+ */
+int DlSegParseName(const char *name, uint32_t *seq, int *compressed) {
+  size_t len = strlen(name);
+  size_t plen = strlen(DLSEG_PREFIX);
+  size_t slen = strlen(DLSEG_SUFFIX);
+  size_t zlen = strlen(DLSEG_ZSUFFIX);
+
+  if (strncmp(name, DLSEG_PREFIX, plen) != 0) {
+    return 0;
+  }
+  *compressed = 0;
+  if (len > zlen && strcmp(name + len - zlen, DLSEG_ZSUFFIX) == 0) {
+    *compressed = 1;
+    len -= zlen;
+  }
+  if (len < plen + slen + 2 ||
+      strncmp(name + len - slen, DLSEG_SUFFIX, slen) != 0) {
+    return 0;
+  }
+  len -= slen;
+  size_t start = len;
+  while (start > plen && name[start - 1] >= '0' && name[start - 1] <= '9') {
+    start--;
+  }
+  if (start == len || name[start - 1] != '.') {
+    return 0;
+  }
+  *seq = (uint32_t)strtoul(name + start, NULL, 10);
+  return 1;
+}
+
+/** @brief List the segments in a directory, oldest first.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param dir segment directory
+ *  @return segments sorted by sequence number, none with errno set to
+ *  ENAMETOOLONG if a segment path does not fit in DLSEG_PATHSZ
+ */
+std::vector<dlsegent_t> DlSegList(const char *dir) {
+  std::vector<dlsegent_t> ents;
+  DIR *d = opendir(dir);
+  struct dirent *e;
+
+  if (d == NULL) {
+    return ents;
+  }
+  while ((e = readdir(d)) != NULL) {
+    dlsegent_t ent;
+    struct stat st;
+    if (!DlSegParseName(e->d_name, &ent.seq, &ent.compressed)) {
+      continue;
+    }
+    int len = snprintf(ent.path, sizeof(ent.path), "%s/%s", dir, e->d_name);
+    if (len < 0 || (size_t)len >= sizeof(ent.path)) {
+      closedir(d);
+      ents.clear();
+      errno = ENAMETOOLONG;
+      return ents;
+    }
+    if (stat(ent.path, &st) < 0) {
+      continue;
+    }
+    ent.size = st.st_size;
+    ents.push_back(ent);
+  }
+  closedir(d);
+  std::sort(ents.begin(), ents.end(),
+            [](const dlsegent_t &x, const dlsegent_t &y) {
+              return x.seq < y.seq;
+            });
+  return ents;
+}
+
+/** @brief Read a compressed segment into memory.
+ *  @return 0 on success, -1 on error
+ */
+static int inflateSegment(dlsegmap_t *m, const char *path) {
+  gzFile gz = gzopen(path, "rb");
+  size_t cap = 1 << 20;
+  size_t len = 0;
+  uint8_t *buf = (uint8_t *)malloc(cap);
+  int n;
+
+  if (gz == NULL || buf == NULL) {
+    free(buf);
+    if (gz != NULL) {
+      gzclose(gz);
+    }
+    return -1;
+  }
+  while ((n = gzread(gz, buf + len, cap - len)) > 0) {
+    len += n;
+    if (len == cap) {
+      uint8_t *grown = (uint8_t *)realloc(buf, cap * 2);
+      if (grown == NULL) {
+        break;
+      }
+      buf = grown;
+      cap *= 2;
+    }
+  }
+  gzclose(gz);
+  if (n < 0) {
+    free(buf);
+    return -1;
+  }
+  m->base = buf;
+  m->len = len;
+  m->heap = 1;
+  return 0;
+}
+
+/** @brief Create the next segment file and write its header.
+ *  @return 0 on success, -1 on error, with errno ENAMETOOLONG if the path
+ *  does not fit in DLSEG_PATHSZ
+ */
+static int startSegment(dlseg_t *seg) {
+  dlseghdr_t hdr;
+  char stamp[16];
+  struct tm tm;
+
+  seg->seq++;
+  seg->created = time(NULL);
+  localtime_r(&seg->created, &tm);
+  strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%S", &tm);
+  int len = snprintf(seg->path, sizeof(seg->path),
+                     "%s/" DLSEG_PREFIX "-%llu-%s.%06u" DLSEG_SUFFIX,
+                     seg->dir, (unsigned long long)seg->serial, stamp,
+                     seg->seq);
+  if (len < 0 || (size_t)len >= sizeof(seg->path)) {
+    seg->path[0] = '\0';
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  seg->fd = open(seg->path, O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644);
+  if (seg->fd < 0) {
+    return -1;
+  }
+  DlLogInitHeader(&hdr, seg->serial, (int64_t)seg->created);
+  if (writeAll(seg->fd, &hdr, sizeof(hdr)) < 0) {
+    close(seg->fd);
+    seg->fd = -1;
+    return -1;
+  }
+  seg->size = sizeof(hdr);
+  return 0;
+}
+
+/** @brief Check whether the open segment has outlived its rotation period.
+ *  @return 1 if the wall clock has entered a new period
+ */
+static int periodElapsed(const dlseg_t *seg) {
+  if (seg->period <= 0) {
+    return 0;
+  }
+  return time(NULL) / seg->period != seg->created / seg->period;
+}
+
+/** @brief Open a new segment for appending.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param seg writer state
+ *  @param dir directory for the segment files
+ *  @param serial unit serial
+ *  @param maxsize size bound of one segment in bytes
+ *  @return 0 on success, -1 on error, with errno ENAMETOOLONG if the
+ *  segment paths under dir do not fit in DLSEG_PATHSZ
+ *
+ *  Segments are also rotated when the wall clock crosses a multiple of
+ *  seg->period seconds, and seg->closed is told about every segment that
+ *  is closed; both may be set after opening.
+ */
+int DlSegOpen(dlseg_t *seg, const char *dir, uint64_t serial, size_t maxsize) {
+  memset(seg, 0, sizeof(*seg));
+  seg->fd = -1;
+  int len = snprintf(seg->dir, sizeof(seg->dir), "%s", dir);
+  if (len < 0 || (size_t)len >= sizeof(seg->dir)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  errno = 0;
+  std::vector<dlsegent_t> ents = DlSegList(dir);
+  if (ents.empty() && errno == ENAMETOOLONG) {
+    return -1;
+  }
+  seg->serial = serial;
+  seg->maxsize = maxsize;
+  seg->seq = ents.empty() ? 0 : ents.back().seq;
+  seg->fd = -1;
+  return startSegment(seg);
+}
+
+/** @brief Append records, starting a new segment when the bound is reached.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param seg writer state
+ *  @param recs records to append
+ *  @param n number of records
+ *  @param written output, records that reached the segments, may be NULL
+ *  @return 0 on success, -1 on error, after which recs[*written] is the
+ *  first record not written
+ */
+int DlSegAppend(dlseg_t *seg, const dlrecord_t *recs, size_t n,
+                size_t *written) {
+  if (written != NULL) {
+    *written = 0;
+  }
+  while (n > 0) {
+    if (seg->fd >= 0 && seg->size > sizeof(dlseghdr_t) &&
+        periodElapsed(seg)) {
+      DlSegClose(seg);
+    }
+    if (seg->fd < 0 && startSegment(seg) < 0) {
+      return -1;
+    }
+    size_t room = 0;
+    if (seg->maxsize > seg->size) {
+      room = (seg->maxsize - seg->size) / sizeof(dlrecord_t);
+    }
+    if (room == 0) {
+      if (seg->size > sizeof(dlseghdr_t)) {
+        DlSegClose(seg);
+        continue;
+      }
+      room = 1; // always make progress, even with a tiny bound
+    }
+    size_t count = (n < room) ? n : room;
+    if (writeAll(seg->fd, recs, count * sizeof(dlrecord_t)) < 0) {
+      // Drop a torn tail so a retry starts on a record boundary
+      int err = errno;
+      if (ftruncate(seg->fd, seg->size) < 0) {
+        DlSegClose(seg);
+      }
+      errno = err;
+      return -1;
+    }
+    for (size_t i = 0; i < count; i++) {
+      DlIndexAdd(&seg->idx, recs[i].rtime);
+    }
+    seg->size += count * sizeof(dlrecord_t);
+    recs += count;
+    n -= count;
+    if (written != NULL) {
+      *written += count;
+    }
+  }
+  return 0;
+}
+
+/** @brief Close the open segment.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param seg writer state
+ *  @return void
+ */
+void DlSegClose(dlseg_t *seg) {
+  if (seg->fd >= 0) {
+    if (seg->syncclose) {
+      fdatasync(seg->fd);
+    }
+    close(seg->fd);
+    seg->fd = -1;
+    if (seg->idx.nrecs > 0) {
+      DlIndexWrite(seg->path, &seg->idx);
+      DlCatalogAppend(seg->dir, seg->seq, seg->path, &seg->idx);
+    }
+    DlIndexFree(&seg->idx);
+    if (seg->closed != NULL) {
+      seg->closed(seg->path, seg->closedarg);
+    }
+  }
+}
+
+/** @brief Map a segment read-only and validate its header.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param m output mapping
+ *  @param path segment file
+ *  @return 0 on success, -1 on error
+ */
+int DlSegMap(dlsegmap_t *m, const char *path) {
+  struct stat st;
+  int fd;
+  size_t len = strlen(path);
+  size_t zlen = strlen(DLSEG_ZSUFFIX);
+
+  memset(m, 0, sizeof(*m));
+  if (len > zlen && strcmp(path + len - zlen, DLSEG_ZSUFFIX) == 0) {
+    if (inflateSegment(m, path) < 0) {
+      return -1;
+    }
+  } else {
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+      return -1;
+    }
+    if (fstat(fd, &st) < 0 ||
+        (size_t)st.st_size < offsetof(dlseghdr_t, fields)) {
+      close(fd);
+      return -1;
+    }
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+      return -1;
+    }
+    m->base = (const uint8_t *)p;
+    m->len = st.st_size;
+    madvise(p, m->len, MADV_SEQUENTIAL);
+  }
+  m->hdr = (const dlseghdr_t *)m->base;
+
+  // Older readers can still walk newer segments as long as the fields they
+  // know about keep their place, so only the common prefix of the layout is
+  // checked. Segments older than this reader have shorter records.
+  const dlseghdr_t *h = m->hdr;
+  size_t fixed = offsetof(dlseghdr_t, fields);
+  if (m->len < fixed || h->magic != DLSEG_MAGIC ||
+      h->nfields < DLSEG_V1FIELDS ||
+      h->hdrsize < fixed + h->nfields * sizeof(dlfield_t) ||
+      h->hdrsize > m->len) {
+    DlSegUnmap(m);
+    return -1;
+  }
+  size_t common = (h->nfields < DLSEG_FIELDS) ? h->nfields : DLSEG_FIELDS;
+  const dlfield_t &lastField = fieldLayout[common - 1];
+  uint32_t minsize = lastField.offset + ((lastField.type == DLF_I64) ? 8 : 4);
+  if (memcmp(h->fields, fieldLayout, common * sizeof(dlfield_t)) != 0 ||
+      h->recsize < minsize) {
+    DlSegUnmap(m);
+    return -1;
+  }
+  // A partially written tail record is ignored
+  m->nrecs = (m->len - m->hdr->hdrsize) / m->hdr->recsize;
+  return 0;
+}
+
+/** @brief Unmap a segment.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param m mapping
+ *  @return void
+ */
+void DlSegUnmap(dlsegmap_t *m) {
+  if (m->heap) {
+    free((void *)m->base);
+  } else if (m->base != NULL) {
+    munmap((void *)m->base, m->len);
+  }
+  memset(m, 0, sizeof(*m));
+}
+
+/** @brief Read one record of a mapped segment.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param m mapped segment
+ *  @param i record index, must be below m->nrecs
+ *  @param r output reading
+ *  @return void
+ */
+void DlSegRead(const dlsegmap_t *m, size_t i, reading_s *r) {
+  dlrecord_t rec;
+  size_t len = m->hdr->recsize;
+
+  if (len > sizeof(rec)) {
+    len = sizeof(rec);
+  }
+  memset(&rec, 0, sizeof(rec));
+  memcpy(&rec, m->base + m->hdr->hdrsize + i * m->hdr->recsize, len);
+  if (len < offsetof(dlrecord_t, lon7) + sizeof(rec.lon7)) {
+    // Written before the integer coordinates
+    rec.lat7 = (int32_t)lround((double)rec.latitude * DLDEGE7);
+    rec.lon7 = (int32_t)lround((double)rec.longitude * DLDEGE7);
+  }
+  DlLogUnpack(&rec, r);
+}
+
+/** @brief Export a mapped segment in the loggerdata.csv format.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param m mapped segment
+ *  @param fp output stream
+ *  @return number of records written
+ */
+int DlSegExportCsv(const dlsegmap_t *m, FILE *fp) {
+  char line[DLFMT_BUFSZ];
+
+  for (size_t i = 0; i < m->nrecs; i++) {
+    reading_s r;
+    DlSegRead(m, i, &r);
+    int len = DlFormatCsv(&r, line, sizeof(line));
+    if (len < 0 || fwrite(line, 1, len, fp) != (size_t)len) {
+      return (int)i;
+    }
+  }
+  return (int)m->nrecs;
+}
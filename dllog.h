@@ -0,0 +1,143 @@
+#ifndef DLLOG_H
+#define DLLOG_H
+/** @file dllog.h
+ *  @brief Binary segment log format, segment writer and mmap reader.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  A segment is a dlseghdr_t followed by fixed-width dlrecord_t records.
+ *  Segments are append-only; once a segment reaches its size bound or its
+ *  rotation period the writer closes it and starts the next one. Segment
+ *  files are named loggerdata-<serial>-<start time>.<seq>.vdl, and closed
+ *  segments may later be gzip compressed in place (.vdl.gz). The header
+ *  describes the record layout so readers can check it without knowing the
+ *  schema version in advance. New fields are only ever added at the end of
+ *  the record, so a segment written by an older version is still readable;
+ *  the fields it lacks read as zero. Coordinates are kept exactly as 1e-7
+ *  degree integers from version 3 on; the float latitude and longitude are
+ *  still written for older readers, and are what a version 1 or 2 segment
+ *  is read from. Version 4 adds the geofence fields.
+ */
+#include "dlindex.h"
+#include "logger.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#define DLSEG_MAGIC 0x474C4456 // "VDLG"
+#define DLSEG_VERSION 4
+#define DLSEG_FIELDS 26
+#define DLSEG_V1FIELDS 18 ///< Fields of version 1, a prefix of the layout
+#define DLSEG_NAMESZ 12
+#define DLSEG_PATHSZ 256
+#define DLSEG_PREFIX "loggerdata"
+#define DLSEG_SUFFIX ".vdl"
+#define DLSEG_ZSUFFIX ".gz"
+
+// Field types
+#define DLF_I64 1
+#define DLF_F32 2
+#define DLF_I32 3
+
+typedef struct dlfield {
+  char name[DLSEG_NAMESZ]; ///< Field name, NUL padded
+  uint8_t type;            ///< DLF_I64, DLF_F32 or DLF_I32
+  uint8_t offset;          ///< Byte offset within the record
+  uint16_t reserved;
+} dlfield_t;
+
+typedef struct dlseghdr {
+  uint32_t magic;                  ///< DLSEG_MAGIC
+  uint16_t version;                ///< Schema version
+  uint16_t hdrsize;                ///< Size of this header in bytes
+  uint64_t serial;                 ///< Unit serial from DlGetSerial
+  int64_t created;                 ///< Segment creation time, epoch seconds
+  uint32_t recsize;                ///< Size of one record in bytes
+  uint32_t nfields;                ///< Number of entries used in fields
+  dlfield_t fields[DLSEG_FIELDS];  ///< Record layout
+} dlseghdr_t;
+
+typedef struct dlrecord {
+  int64_t rtime;     ///< Reading time, epoch seconds
+  float temperature; ///< Degrees Celsius
+  float humidity;    ///< Per cent relative humidity
+  float pressure;    ///< Kilo Pascals
+  float xa;          ///< X-axis accelaration
+  float ya;          ///< Y-axis accelaration
+  float za;          ///< Z-axis accelaration
+  float pitch;       ///< Pitch angle
+  float roll;        ///< Roll angle
+  float yaw;         ///< Yaw angle
+  float xm;          ///< X axis micro Teslas
+  float ym;          ///< Y axis micro Teslas
+  float zm;          ///< Z axis micro Teslas
+  float latitude;    ///< Latitude degrees, for version 2 readers
+  float longitude;   ///< Longitude degrees, for version 2 readers
+  float altitude;    ///< Altitude
+  float speed;       ///< Speed kph
+  float heading;     ///< Heading degrees True
+  uint32_t reserved; ///< Pads the record to a multiple of 8 bytes
+  int64_t imut;      ///< IMU capture time, CLOCK_MONOTONIC ns
+  int64_t envt;      ///< Environmental capture time, CLOCK_MONOTONIC ns
+  int64_t gpst;      ///< GPS fix time, CLOCK_MONOTONIC ns
+  int64_t wallofs;   ///< Wall clock minus CLOCK_MONOTONIC, ns
+  int32_t lat7;      ///< Latitude, 1e-7 degrees
+  int32_t lon7;      ///< Longitude, 1e-7 degrees
+  int32_t fence;     ///< Id of a geofence the position is in, 0 for none
+  int32_t fenceev;   ///< Geofence +id entered or -id left, 0 for none
+} dlrecord_t;
+
+static_assert(sizeof(dlrecord_t) == 128, "dlrecord_t must stay 128 bytes");
+static_assert(sizeof(dlseghdr_t) == 448, "dlseghdr_t must stay 448 bytes");
+
+/// Segment writer state
+typedef struct dlseg {
+  int fd;                  ///< Open segment, -1 when closed
+  char dir[DLSEG_PATHSZ];  ///< Directory holding the segments
+  char path[DLSEG_PATHSZ]; ///< Path of the open segment
+  uint64_t serial;         ///< Unit serial written into each header
+  uint32_t seq;            ///< Sequence number of the open segment
+  size_t size;             ///< Bytes written to the open segment
+  size_t maxsize;          ///< Size bound of one segment
+  int syncclose;           ///< fdatasync a segment before closing it
+  time_t created;          ///< Wall clock start of the open segment
+  time_t period;           ///< Rotation period in seconds, 0 for none
+  void (*closed)(const char *, void *); ///< Called with each closed segment
+  void *closedarg;                      ///< Argument for closed
+  dlidx_t idx;                          ///< Sparse index of the open segment
+} dlseg_t;
+
+/// Segment found in a log directory
+typedef struct dlsegent {
+  char path[DLSEG_PATHSZ]; ///< Path of the segment file
+  uint32_t seq;            ///< Sequence number
+  int compressed;          ///< 1 for a .gz segment
+  uint64_t size;           ///< File size in bytes
+} dlsegent_t;
+
+/// Memory-mapped segment
+typedef struct dlsegmap {
+  const uint8_t *base;    ///< Start of the mapping
+  size_t len;             ///< Length of the mapping
+  const dlseghdr_t *hdr;  ///< Segment header
+  size_t nrecs;           ///< Number of complete records
+  int heap;               ///< base was inflated into malloc memory
+} dlsegmap_t;
+
+///\cond INTERNAL
+// Function Prototypes
+void DlLogPack(const reading_s *, dlrecord_t *);
+void DlLogUnpack(const dlrecord_t *, reading_s *);
+void DlLogInitHeader(dlseghdr_t *, uint64_t, int64_t);
+int DlSegParseName(const char *, uint32_t *, int *);
+std::vector<dlsegent_t> DlSegList(const char *);
+int DlSegOpen(dlseg_t *, const char *, uint64_t, size_t);
+int DlSegAppend(dlseg_t *, const dlrecord_t *, size_t, size_t *);
+void DlSegClose(dlseg_t *);
+int DlSegMap(dlsegmap_t *, const char *);
+void DlSegUnmap(dlsegmap_t *);
+void DlSegRead(const dlsegmap_t *, size_t, reading_s *);
+int DlSegExportCsv(const dlsegmap_t *, FILE *);
+///\endcond
+#endif
@@ -0,0 +1,358 @@
+/** @file dlpipeline.cpp
+ *  @brief Acquisition pipeline threads.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlpipeline.h"
+#include "dlclock.h"
+#include "dlfence.h"
+#include "dlfusion.h"
+#include "dlsched.h"
+#include "dlsimplify.h"
+#include "seqlock.h"
+#include "spsc.h"
+#include <atomic>
+#include <thread>
+
+// Sample hand-off between the acquisition threads and persistence
+static SpscRing<imu_s, IMURINGSZ> imuRing;
+static SpscRing<env_s, ENVRINGSZ> envRing;
+static SpscRing<fix_s, GPSRINGSZ> gpsRing;
+
+// Latest values for the display and LED level
+static SeqLock<imu_s> imuLatest;
+static SeqLock<env_s> envLatest;
+static SeqLock<fix_s> gpsLatest;
+
+// Scheduling counters of every channel, for reports
+static SeqLock<dlchan_t> chanStats[DLCH_COUNT];
+
+static std::atomic<bool> running(false);
+static std::atomic<uint64_t> imuCount(0);
+static std::atomic<uint64_t> envCount(0);
+static std::atomic<uint64_t> envI2c(0);
+static std::atomic<uint64_t> envNs(0);
+static std::atomic<uint64_t> gpsCount(0);
+static std::atomic<uint64_t> savedCount(0);
+static std::atomic<uint64_t> trackCount(0);
+static std::thread imuThread;
+static std::thread envThread;
+static std::thread gpsThread;
+static std::thread persistThread;
+
+// Geofences, loaded before the threads start and read only after that
+static dlfenceset_t fences;
+
+/** @brief Publish a copy of a channel's scheduling counters.
+ */
+static void publish(int id, const dlchan_t *ch) { chanStats[id].Store(*ch); }
+
+/** @brief IMU acquisition thread.
+ *
+ *  Each poll drains the IMU FIFO once and hands on every sample it held,
+ *  so the ring carries the IMU at its own rate whatever the poll period.
+ *  The fusion filter is owned by this thread. Every sample is run through
+ *  it, and each new fix the GPS thread publishes is folded in first, so
+ *  the samples carry position, speed and heading at the IMU rate.
+ */
+static void imuTask(void) {
+  dlchan_t ch;
+  imu_s batch[IMUBATCH];
+  dlfusion_t nav;
+  uint32_t seq = 0;
+
+  DlFuseInit(&nav);
+  DlChanInit(&ch, "imu", (int64_t)IMUPERIOD * 1000);
+  while (running.load(std::memory_order_relaxed)) {
+    if (DlSchedWait(&ch, 1) < 0) {
+      continue;
+    }
+    int n = DlGetImuBatch(batch, IMUBATCH);
+    if (n == 0) {
+      publish(DLCH_IMU, &ch);
+      continue;
+    }
+    fix_s fix;
+    gpsLatest.Load(fix);
+    if (fix.seq != seq) {
+      seq = fix.seq;
+      DlFuseGps(&nav, &fix);
+    }
+    for (int i = 0; i < n; i++) {
+      DlFuseImu(&nav, &batch[i]);
+    }
+    imuRing.PushBatch(batch, n);
+    imuLatest.Store(batch[n - 1]);
+    imuCount.fetch_add(n, std::memory_order_relaxed);
+    publish(DLCH_IMU, &ch);
+  }
+}
+
+/** @brief Environmental sensor thread.
+ *
+ *  Each period is one combined cycle: pressure, humidity, sensor and CPU
+ *  temperatures are read once together and handed on as a single sample,
+ *  with the I2C transactions and time the cycle took added to the counters.
+ */
+static void envTask(void) {
+  dlchan_t ch;
+
+  DlChanInit(&ch, "env", (int64_t)ENVPERIOD * 1000);
+  while (running.load(std::memory_order_relaxed)) {
+    if (DlSchedWait(&ch, 1) < 0) {
+      continue;
+    }
+    env_s s = DlGetEnvReadings();
+    envRing.Push(s);
+    envLatest.Store(s);
+    envCount.fetch_add(1, std::memory_order_relaxed);
+    envI2c.fetch_add(s.i2c, std::memory_order_relaxed);
+    envNs.fetch_add(s.ns, std::memory_order_relaxed);
+    publish(DLCH_ENV, &ch);
+  }
+}
+
+/** @brief GPS acquisition thread.
+ *
+ *  The thread sleeps until the GPS reader signals a new position and hands
+ *  on every one, at whatever rate the receiver or the replay sends them.
+ *  The channel counts positions, and its jitter is the time from the
+ *  sentence arriving to the fix being handed on. Each position is checked
+ *  against the geofences, and the fix carries the fence it is in and any
+ *  fence entered or left since the last one.
+ */
+static void gpsTask(void) {
+  dlchan_t ch;
+  dlfencetrack_t track;
+
+  DlChanInit(&ch, "gps", 0);
+  DlFenceTrackInit(&track);
+  while (running.load(std::memory_order_relaxed)) {
+    fix_s s;
+    if (DlWaitGpsReadings(&s, GPSWAIT) == 0) {
+      continue;
+    }
+    if (s.quality > 0 && fences.nfences > 0) {
+      s.nevents = (uint8_t)DlFenceCheck(&fences, &track, s.latitude,
+                                        s.longitude, s.events, FENCEEVENTS);
+      s.fence = track.ninside ? fences.fences[track.inside[0]].id : 0;
+    }
+    gpsRing.Push(s);
+    gpsLatest.Store(s);
+    gpsCount.fetch_add(1, std::memory_order_relaxed);
+    int64_t late = DlMonotonicNs() - s.t;
+    ch.runs++;
+    ch.jittersum += late;
+    ch.jittermax = (late > ch.jittermax) ? late : ch.jittermax;
+    publish(DLCH_GPS, &ch);
+  }
+}
+
+/** @brief Save a record carrying a fix that the simplifier kept as a track
+ *  vertex.
+ */
+static void saveVertex(reading_s *creads, const fix_s *vertex) {
+  DlMergeReadings(creads, NULL, NULL, vertex);
+  DlStampReading(creads);
+  DlSaveLoggerData(*creads);
+  savedCount.fetch_add(1, std::memory_order_relaxed);
+  trackCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+/** @brief Persistence thread, the only consumer of the rings and the only
+ *  caller of DlSaveLoggerData.
+ *
+ *  The IMU and environmental groups each have their own persistence
+ *  period. A record is written when a group's period has elapsed and that
+ *  group has new samples; the record carries the latest IMU and
+ *  environmental values and the fused position, but not the raw fix. With
+ *  IMUSAVEALL every IMU sample is written instead. Fixes go through the
+ *  track simplifier, and only a fix it keeps as a vertex is stored, as a
+ *  record of its own, so straight runs of road are not stored fix by fix.
+ *  A geofence event is written at once, as a record of its own with
+ *  fenceev set and the fix it happened at.
+ */
+static void persistTask(void) {
+  reading_s creads{0};
+  dlchan_t drain;
+  dlchan_t save[2];
+  dlsimplify_t track;
+  dltrackpt_t vertex;
+  fix_s last{0};
+  bool fresh[2] = {false, false};
+  bool fused = false;
+
+  DlChanInit(&drain, "persist", (int64_t)PERSISTPERIOD * 1000);
+  DlChanInit(&save[0], "imusave", (int64_t)IMUSAVEPERIOD * 1000);
+  DlChanInit(&save[1], "envsave", (int64_t)ENVSAVEPERIOD * 1000);
+  DlSimplifyInit(&track, TRACKTOL, TRACKVTOL);
+  while (true) {
+    bool stop = !running.load(std::memory_order_relaxed);
+    imu_s imus[IMUBATCH];
+    size_t nimu;
+    env_s env;
+    fix_s fix;
+
+    // Fixes first, so the fused position of later IMU samples wins
+    while (gpsRing.Pop(fix)) {
+      if (fix.quality > 0) {
+        dltrackpt_t pt{fix.latitude, fix.longitude, fix.altitude, fix.seq};
+        if (DlSimplifyPush(&track, &pt, &vertex)) {
+          saveVertex(&creads, (vertex.tag == fix.seq) ? &fix : &last);
+        }
+        last = fix;
+      }
+      DlMergeReadings(&creads, NULL, NULL, &fix);
+      fused = false;
+      for (int i = 0; i < fix.nevents; i++) {
+        creads.fenceev = fix.events[i];
+        DlStampReading(&creads);
+        DlSaveLoggerData(creads);
+        savedCount.fetch_add(1, std::memory_order_relaxed);
+      }
+      creads.fenceev = 0;
+    }
+    while ((nimu = imuRing.PopBatch(imus, IMUBATCH)) > 0) {
+      for (size_t i = 0; i < nimu; i++) {
+        DlMergeReadings(&creads, &imus[i], NULL, NULL);
+        fused = imus[i].nav;
+        if (IMUSAVEALL) {
+          DlStampReading(&creads);
+          DlSaveSensorData(creads, fused);
+          savedCount.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      fresh[0] = !IMUSAVEALL;
+    }
+    while (envRing.Pop(env)) {
+      DlMergeReadings(&creads, NULL, &env, NULL);
+      fresh[1] = true;
+    }
+
+    int64_t now = DlMonotonicNs();
+    bool due = false;
+    for (int i = 0; i < 2; i++) {
+      if (DlChanDue(&save[i], now) && fresh[i]) {
+        due = true;
+      }
+    }
+    if (due) {
+      DlStampReading(&creads);
+      DlSaveSensorData(creads, fused);
+      savedCount.fetch_add(1, std::memory_order_relaxed);
+      fresh[0] = fresh[1] = false;
+    }
+    if (stop && DlSimplifyFlush(&track, &vertex)) {
+      saveVertex(&creads, &last);
+    }
+    DlPollLoggerData();
+    publish(DLCH_PERSIST, &drain);
+    if (stop) {
+      break;
+    }
+    DlSchedWait(&drain, 1);
+  }
+}
+
+/** @brief Start the acquisition and persistence threads.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return 0 on success, -1 if the pipeline is already running
+ */
+int DlPipelineStart(void) {
+  if (running.exchange(true)) {
+    return -1;
+  }
+  // A missing fence file only means there are no fences
+  DlFenceLoad(&fences, FENCEFILE);
+  imuThread = std::thread(imuTask);
+  envThread = std::thread(envTask);
+  gpsThread = std::thread(gpsTask);
+  persistThread = std::thread(persistTask);
+  return 0;
+}
+
+/** @brief Stop the pipeline after a last drain of the rings.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return void
+ */
+void DlPipelineStop(void) {
+  if (!running.exchange(false)) {
+    return;
+  }
+  imuThread.join();
+  envThread.join();
+  gpsThread.join();
+  persistThread.join();
+  DlFenceFree(&fences);
+}
+
+/** @brief Get the most recent value of every channel.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param creads output reading
+ *  @return void
+ */
+void DlPipelineLatest(reading_s *creads) {
+  imu_s imu;
+  env_s env;
+  fix_s fix;
+
+  imuLatest.Load(imu);
+  envLatest.Load(env);
+  gpsLatest.Load(fix);
+  *creads = reading_s{0};
+  DlMergeReadings(creads, &imu, &env, &fix);
+  DlStampReading(creads);
+}
+
+/** @brief Get the acceleration of the latest IMU sample, without waiting.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param xa output x acceleration, g
+ *  @param ya output y acceleration, g
+ *  @return 0, -1 if there is no sample yet
+ *
+ *  This is the tilt source of the LED spirit level.
+ */
+int DlPipelineTilt(float *xa, float *ya) {
+  imu_s imu;
+
+  if (imuLatest.Load(imu) == 0) {
+    return -1;
+  }
+  *xa = imu.xa;
+  *ya = imu.ya;
+  return 0;
+}
+
+/** @brief Get the pipeline counters.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param stats output counters
+ *  @return void
+ */
+void DlPipelineStats(dlpipestats_t *stats) {
+  stats->imu = imuCount.load(std::memory_order_relaxed);
+  stats->env = envCount.load(std::memory_order_relaxed);
+  stats->envi2c = envI2c.load(std::memory_order_relaxed);
+  stats->envns = envNs.load(std::memory_order_relaxed);
+  stats->gps = gpsCount.load(std::memory_order_relaxed);
+  stats->saved = savedCount.load(std::memory_order_relaxed);
+  stats->track = trackCount.load(std::memory_order_relaxed);
+  stats->dropped = imuRing.Dropped() + envRing.Dropped() + gpsRing.Dropped();
+}
+
+/** @brief Get the scheduling counters of every channel.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param chans output array of DLCH_COUNT channels, indexed by DLCH_*
+ *  @return number of channels
+ */
+int DlPipelineChannels(dlchan_t *chans) {
+  for (int i = 0; i < DLCH_COUNT; i++) {
+    chanStats[i].Load(chans[i]);
+  }
+  return DLCH_COUNT;
+}
@@ -0,0 +1,50 @@
+#ifndef DLPIPELINE_H
+#define DLPIPELINE_H
+/** @file dlpipeline.h
+ *  @brief Multi-threaded acquisition pipeline.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  The IMU, environmental sensors and GPS each run on their own thread and
+ *  hand timestamped samples to the persistence thread through SpscRing
+ *  buffers. Every stage also publishes its latest sample in a SeqLock so
+ *  the display and LED level can read current values without ever waiting
+ *  on acquisition or storage. Sampling and persistence rates are set per
+ *  sensor group and driven by dlsched absolute deadlines.
+ */
+#include "dlsched.h"
+#include "logger.h"
+#include <cstdint>
+
+#define IMURINGSZ 256
+#define ENVRINGSZ 16
+#define GPSRINGSZ 16
+
+// Scheduling channels
+#define DLCH_IMU 0
+#define DLCH_ENV 1
+#define DLCH_GPS 2
+#define DLCH_PERSIST 3
+#define DLCH_COUNT 4
+
+typedef struct dlpipestats {
+  uint64_t imu;     ///< IMU samples acquired
+  uint64_t env;     ///< Environmental samples acquired
+  uint64_t envi2c;  ///< I2C transactions of those samples
+  uint64_t envns;   ///< Time taken by those samples
+  uint64_t gps;     ///< GPS fixes acquired
+  uint64_t saved;   ///< Records handed to the log writer
+  uint64_t track;   ///< Fixes kept as track vertices
+  uint64_t dropped; ///< Samples lost to full rings
+} dlpipestats_t;
+
+///\cond INTERNAL
+// Function Prototypes
+int DlPipelineStart(void);
+void DlPipelineStop(void);
+void DlPipelineLatest(reading_s *);
+int DlPipelineTilt(float *, float *);
+void DlPipelineStats(dlpipestats_t *);
+int DlPipelineChannels(dlchan_t *);
+///\endcond
+#endif
@@ -0,0 +1,283 @@
+/** @file dlquery.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Extract a time range from the log archive as CSV
+ *
+ *  Usage: dlquery [-d dir] [-v] from [to]
+ *         dlquery [-d dir] -r
+ *
+ *  from and to are epoch seconds or local times as YYYY-mm-ddTHH:MM:SS,
+ *  to defaults to from. The catalog and the segment indexes locate the
+ *  first record of the range, then records are streamed until the range
+ *  ends. Segments newer than the catalog are searched directly. -v reports
+ *  the segments opened and records read on stderr. -r rebuilds the indexes
+ *  and the catalog from the segments, for archives written before they
+ *  existed; run it while the logger is stopped.
+ */
+
+#include "dlformat.h"
+#include "dlindex.h"
+#include "dllog.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+typedef struct querystats {
+  size_t segments; ///< Segments opened
+  size_t records;  ///< Records read
+  size_t matched;  ///< Records written
+} querystats_t;
+
+/** @brief Parse epoch seconds or a local YYYY-mm-ddTHH:MM:SS time.
+ *  @return 0 on success, -1 if the text is neither
+ */
+static int parseTime(const char *s, int64_t *t) {
+  struct tm tm;
+  char *end;
+
+  long long v = strtoll(s, &end, 10);
+  if (*s != '\0' && *end == '\0') {
+    *t = v;
+    return 0;
+  }
+  memset(&tm, 0, sizeof(tm));
+  end = strptime(s, "%Y-%m-%dT%H:%M:%S", &tm);
+  if (end == NULL || *end != '\0') {
+    return -1;
+  }
+  tm.tm_isdst = -1;
+  *t = (int64_t)mktime(&tm);
+  return 0;
+}
+
+/** @brief Read the whole catalog of a directory.
+ */
+static std::vector<dlcatent_t> loadCatalog(const char *dir) {
+  std::vector<dlcatent_t> cat;
+  char path[DLSEG_PATHSZ + sizeof(DLCAT_FILE)];
+  struct stat st;
+  int fd;
+
+  snprintf(path, sizeof(path), "%s/" DLCAT_FILE, dir);
+  fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return cat;
+  }
+  if (fstat(fd, &st) == 0) {
+    cat.resize(st.st_size / sizeof(dlcatent_t));
+    ssize_t len = cat.size() * sizeof(dlcatent_t);
+    if (read(fd, cat.data(), len) != len) {
+      cat.clear();
+    }
+  }
+  close(fd);
+  return cat;
+}
+
+/** @brief First record of a mapped segment at or after a time.
+ */
+static size_t lowerBound(const dlsegmap_t *m, size_t lo, size_t hi,
+                         int64_t from) {
+  reading_s r;
+
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    DlSegRead(m, mid, &r);
+    if ((int64_t)r.rtime < from) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/** @brief Write the records of one segment that fall in the range.
+ *  @return 1 once a record past the range was seen, 0 otherwise
+ */
+static int scanSegment(const char *path, int64_t from, int64_t to,
+                       querystats_t *qs) {
+  char line[DLFMT_BUFSZ];
+  dlsegmap_t m;
+  dlidx_t idx;
+  size_t start = 0;
+  size_t end;
+  int past = 0;
+
+  if (DlSegMap(&m, path) < 0) {
+    return 0;
+  }
+  qs->segments++;
+  end = m.nrecs;
+  if (DlIndexLoad(path, &idx) == 0) {
+    start = DlIndexSeek(&idx, from);
+    if (start + DLIDX_EVERY < end) {
+      end = start + DLIDX_EVERY;
+    }
+    DlIndexFree(&idx);
+  }
+  start = lowerBound(&m, start, end, from);
+  for (size_t i = start; i < m.nrecs; i++) {
+    reading_s r;
+    DlSegRead(&m, i, &r);
+    qs->records++;
+    if ((int64_t)r.rtime > to) {
+      past = 1;
+      break;
+    }
+    int len = DlFormatCsv(&r, line, sizeof(line));
+    if (len > 0) {
+      fwrite(line, 1, len, stdout);
+      qs->matched++;
+    }
+  }
+  DlSegUnmap(&m);
+  return past;
+}
+
+/** @brief Path of a catalogued segment, compressed or not.
+ *  @return 0 if the segment still exists, -1 otherwise
+ */
+static int segmentPath(const char *dir, const dlcatent_t *e, char *path,
+                       size_t size) {
+  snprintf(path, size, "%s/%.*s", dir, DLCAT_NAMESZ, e->name);
+  if (access(path, R_OK) == 0) {
+    return 0;
+  }
+  snprintf(path, size, "%s/%.*s" DLSEG_ZSUFFIX, dir, DLCAT_NAMESZ, e->name);
+  return access(path, R_OK);
+}
+
+/** @brief Stream every record between from and to.
+ */
+static void query(const char *dir, int64_t from, int64_t to,
+                  querystats_t *qs) {
+  std::vector<dlcatent_t> cat = loadCatalog(dir);
+  char path[DLSEG_PATHSZ + DLCAT_NAMESZ + 8];
+  uint32_t lastSeq = 0;
+  size_t lo = 0;
+  size_t hi = cat.size();
+
+  for (const dlcatent_t &e : cat) {
+    lastSeq = (e.seq > lastSeq) ? e.seq : lastSeq;
+  }
+  // First catalogued segment that ends at or after from
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (cat[mid].last < from) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  for (size_t i = lo; i < cat.size() && cat[i].first <= to; i++) {
+    if (segmentPath(dir, &cat[i], path, sizeof(path)) == 0 &&
+        scanSegment(path, from, to, qs)) {
+      return;
+    }
+  }
+  // Segments closed after the catalog was written, or still open
+  for (const dlsegent_t &e : DlSegList(dir)) {
+    if (e.seq > lastSeq && scanSegment(e.path, from, to, qs)) {
+      return;
+    }
+  }
+}
+
+/** @brief Rebuild every index and the catalog from the segments.
+ *  @return number of segments catalogued, -1 on error
+ */
+static int rebuild(const char *dir) {
+  std::vector<dlsegent_t> segs = DlSegList(dir);
+  char path[DLSEG_PATHSZ + sizeof(DLCAT_FILE)];
+  int count = 0;
+
+  snprintf(path, sizeof(path), "%s/" DLCAT_FILE, dir);
+  if (unlink(path) < 0 && errno != ENOENT) {
+    return -1;
+  }
+  // The newest segment may still be open, queries search it directly
+  for (size_t s = 0; s + 1 < segs.size(); s++) {
+    dlsegmap_t m;
+    dlidx_t idx;
+    if (DlSegMap(&m, segs[s].path) < 0) {
+      continue;
+    }
+    memset(&idx, 0, sizeof(idx));
+    for (size_t i = 0; i < m.nrecs; i++) {
+      reading_s r;
+      DlSegRead(&m, i, &r);
+      DlIndexAdd(&idx, (int64_t)r.rtime);
+    }
+    DlSegUnmap(&m);
+    if (idx.nrecs > 0 && DlIndexWrite(segs[s].path, &idx) == 0) {
+      char name[DLSEG_PATHSZ];
+      size_t len = strlen(segs[s].path);
+      if (segs[s].compressed) {
+        len -= strlen(DLSEG_ZSUFFIX);
+      }
+      snprintf(name, sizeof(name), "%.*s", (int)len, segs[s].path);
+      if (DlCatalogAppend(dir, segs[s].seq, name, &idx) == 0) {
+        count++;
+      }
+    }
+    DlIndexFree(&idx);
+  }
+  return count;
+}
+
+/** @brief Log query main function
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return int program status
+ */
+int main(int argc, char *argv[]) {
+  const char *dir = LOGDIR;
+  querystats_t qs = {0, 0, 0};
+  int verbose = 0;
+  int rebuildOnly = 0;
+  int64_t from, to;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "d:rv")) != -1) {
+    switch (opt) {
+    case 'd':
+      dir = optarg;
+      break;
+    case 'r':
+      rebuildOnly = 1;
+      break;
+    case 'v':
+      verbose = 1;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-d dir] [-v] from [to] | -r\n", argv[0]);
+      return 1;
+    }
+  }
+  if (rebuildOnly) {
+    int n = rebuild(dir);
+    fprintf(stderr, "%d segments catalogued\n", n);
+    return (n < 0) ? 1 : 0;
+  }
+  if (optind >= argc || parseTime(argv[optind], &from) < 0 ||
+      (optind + 1 < argc && parseTime(argv[optind + 1], &to) < 0)) {
+    fprintf(stderr, "usage: %s [-d dir] [-v] from [to] | -r\n", argv[0]);
+    return 1;
+  }
+  if (optind + 1 >= argc) {
+    to = from;
+  }
+  query(dir, from, to, &qs);
+  if (verbose) {
+    fprintf(stderr, "%zu segments opened, %zu records read, %zu written\n",
+            qs.segments, qs.records, qs.matched);
+  }
+  return 0;
+}
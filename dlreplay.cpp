@@ -0,0 +1,256 @@
+/** @file dlreplay.cpp
+ *  @brief NMEA capture replay functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlreplay.h"
+#include "dlclock.h"
+#include "nmea.h"
+#include "nmeascan.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/** @brief Field holding the UTC time of a sentence, -1 if it has none.
+ */
+static int timeField(const nmeatok_t *tok) {
+  switch (tok->type) {
+  case NMEA_GGA:
+  case NMEA_RMC:
+    return (tok->nfields > 1) ? 1 : -1;
+  case NMEA_GLL:
+    return (tok->nfields > 5) ? 5 : -1;
+  }
+  return -1;
+}
+
+/** @brief Milliseconds of the day of a hhmmss.sss field, -1 if malformed.
+ */
+static int64_t utcMs(const char *s, size_t len) {
+  if (len < 6) {
+    return -1;
+  }
+  int64_t v = nmea_fixed(s, len, 3);
+  if (v < 0) {
+    return -1;
+  }
+  int64_t hh = v / 10000000;
+  int64_t mm = (v / 100000) % 100;
+  int64_t ss = v % 100000;
+  if (hh > 23 || mm > 59 || ss >= 60000) {
+    return -1;
+  }
+  return hh * 3600000 + mm * 60000 + ss;
+}
+
+/** @brief Capture time of one line, following on from prev across midnight.
+ *  @return capture ms, or prev if the line carries no time
+ */
+static int64_t lineTime(const char *p, size_t n, int64_t prev, nmeatok_t *tok,
+                        int *field) {
+  nmea_tokenize(p, n, tok);
+  *field = timeField(tok);
+  if (*field < 0) {
+    return prev;
+  }
+  int64_t ms = utcMs(tok->field[*field], tok->len[*field]);
+  if (ms < 0) {
+    *field = -1;
+    return prev;
+  }
+  ms += prev - prev % DLREPLAY_DAYMS;
+  if (ms < prev - DLREPLAY_DAYMS / 2) {
+    ms += DLREPLAY_DAYMS;
+  }
+  return ms;
+}
+
+/** @brief Write a new time into a hhmmss.sss field and fix the checksum.
+ */
+static void restamp(char *buf, size_t n, char *field, size_t flen,
+                    int64_t ms) {
+  static const char hex[] = "0123456789ABCDEF";
+  int64_t hms = ms % DLREPLAY_DAYMS;
+  int64_t frac = hms % 1000;
+  int64_t secs = hms / 1000;
+  int v[3] = {(int)(secs / 3600), (int)(secs / 60 % 60), (int)(secs % 60)};
+
+  for (int i = 0; i < 3; i++) {
+    field[2 * i] = (char)('0' + v[i] / 10);
+    field[2 * i + 1] = (char)('0' + v[i] % 10);
+  }
+  if (flen > 7 && field[6] == '.') {
+    int digits = (int)(flen - 7);
+    for (int i = digits; i < 3; i++) {
+      frac /= 10;
+    }
+    for (int i = 3; i < digits; i++) {
+      frac *= 10;
+    }
+    for (int i = digits - 1; i >= 0; i--) {
+      field[7 + i] = (char)('0' + frac % 10);
+      frac /= 10;
+    }
+  }
+
+  char *dollar = (char *)memchr(buf, '$', n);
+  char *star = (char *)memchr(buf, '*', n);
+  if (dollar != NULL && star != NULL && star > dollar && star + 2 < buf + n) {
+    uint8_t sum = nmea_checksum(dollar + 1, (size_t)(star - dollar - 1));
+    star[1] = hex[sum >> 4];
+    star[2] = hex[sum & 0x0F];
+  }
+}
+
+/** @brief Length of the line at pos, with its '\n'.
+ */
+static size_t lineLength(const dlreplay_t *r, size_t pos) {
+  const char *p = r->base + pos;
+  const char *nl = (const char *)memchr(p, '\n', r->len - pos);
+  return (nl != NULL) ? (size_t)(nl - p) + 1 : r->len - pos;
+}
+
+/** @brief Map a capture and measure the time it covers.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param r replay state
+ *  @param path NMEA capture, one sentence per line
+ *  @param mode DLREPLAY_REALTIME, DLREPLAY_SCALED or DLREPLAY_FAST
+ *  @param speed speed-up for DLREPLAY_SCALED, eg 100 for 100x
+ *  @return 0 on success, -1 with errno set if the capture cannot be mapped
+ *  or is empty
+ */
+int DlReplayOpen(dlreplay_t *r, const char *path, int mode, double speed) {
+  struct stat st;
+  int64_t gap = 0;
+  bool timed = false;
+
+  memset(r, 0, sizeof(*r));
+  r->mode = mode;
+  r->speed = (mode == DLREPLAY_SCALED && speed > 0) ? speed : 1;
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return -1;
+  }
+  if (st.st_size == 0) {
+    close(fd);
+    errno = ENODATA;
+    return -1;
+  }
+  void *m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (m == MAP_FAILED) {
+    return -1;
+  }
+  r->base = (const char *)m;
+  r->len = (size_t)st.st_size;
+
+  for (size_t pos = 0; pos < r->len;) {
+    size_t n = lineLength(r, pos);
+    nmeatok_t tok;
+    int field;
+    int64_t t = lineTime(r->base + pos, n, r->prev, &tok, &field);
+    if (field >= 0) {
+      if (!timed) {
+        r->first = t;
+        timed = true;
+      } else if (gap == 0 && t > r->prev) {
+        gap = t - r->prev;
+      }
+      r->prev = t;
+    }
+    pos += n;
+  }
+  r->span = r->prev - r->first + ((gap > 0) ? gap : DLREPLAY_GAPMS);
+  if (!timed) {
+    r->span = 0;
+  }
+  r->prev = r->first;
+  return 0;
+}
+
+/** @brief Hand out the next sentence once it is due.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param r replay state
+ *  @param buf output line, NUL terminated, with its line end
+ *  @param len size of buf
+ *  @return length of the line in buf, -1 if nothing is mapped
+ *
+ *  The first call starts the clock. Lines longer than len - 1 are
+ *  truncated.
+ */
+int DlReplayNext(dlreplay_t *r, char *buf, size_t len) {
+  nmeatok_t tok;
+  int field;
+
+  if (r->base == NULL || len == 0) {
+    return -1;
+  }
+  if (r->pos >= r->len) {
+    r->pos = 0;
+    r->loops++;
+    r->prev = r->first;
+  }
+  const char *p = r->base + r->pos;
+  size_t n = lineLength(r, r->pos);
+  r->pos += n;
+  r->prev = lineTime(p, n, r->prev, &tok, &field);
+
+  size_t copy = (n < len - 1) ? n : len - 1;
+  memcpy(buf, p, copy);
+  buf[copy] = '\0';
+  int64_t at = (int64_t)r->loops * r->span + r->prev;
+  if (r->loops > 0 && field >= 0) {
+    size_t off = (size_t)(tok.field[field] - p);
+    if (off + tok.len[field] <= copy) {
+      restamp(buf, copy, buf + off, tok.len[field], at);
+    }
+  }
+
+  int64_t now = DlMonotonicNs();
+  if (r->start == 0) {
+    r->start = now;
+  }
+  r->due = r->start + (int64_t)((at - r->first) * 1e6 / r->speed);
+  if (r->mode != DLREPLAY_FAST && r->due > now) {
+    struct timespec ts;
+    ts.tv_sec = r->due / 1000000000;
+    ts.tv_nsec = r->due % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) ==
+           EINTR) {
+    }
+  }
+  r->sentences++;
+  return (int)copy;
+}
+
+/** @brief Time the last sentence was due.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param r replay state
+ *  @return CLOCK_MONOTONIC ns
+ */
+int64_t DlReplayDue(const dlreplay_t *r) { return r->due; }
+
+/** @brief Unmap a capture.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param r replay state
+ *  @return void
+ */
+void DlReplayClose(dlreplay_t *r) {
+  if (r->base != NULL) {
+    munmap((void *)r->base, r->len);
+  }
+  r->base = NULL;
+  r->len = 0;
+}
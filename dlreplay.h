@@ -0,0 +1,49 @@
+#ifndef DLREPLAY_H
+#define DLREPLAY_H
+/** @file dlreplay.h
+ *  @brief Time-accurate replay of NMEA capture files.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  The capture is memory-mapped and handed out one sentence at a time, the
+ *  way a receiver would deliver it. Each sentence is released at the time
+ *  given by the UTC field of the GGA, RMC or GLL sentences, either in real
+ *  time, sped up N times, or as fast as the caller asks. Sentences without
+ *  a time follow the last one that had it. At the end of the file the
+ *  replay starts over and the UTC fields are rewritten, with their
+ *  checksums, so time keeps moving forward across passes.
+ */
+#include <cstddef>
+#include <cstdint>
+
+// Replay modes
+#define DLREPLAY_REALTIME 0 ///< Capture time
+#define DLREPLAY_SCALED 1   ///< Capture time divided by a speed-up
+#define DLREPLAY_FAST 2     ///< No pacing
+
+#define DLREPLAY_DAYMS 86400000LL
+#define DLREPLAY_GAPMS 1000 ///< Gap between passes if the capture has none
+
+typedef struct dlreplay {
+  const char *base;   ///< Mapped capture
+  size_t len;         ///< Length of the capture
+  size_t pos;         ///< Offset of the next sentence
+  int mode;           ///< DLREPLAY_*
+  double speed;       ///< Speed-up of DLREPLAY_SCALED
+  int64_t start;      ///< CLOCK_MONOTONIC ns of the first sentence, 0 before
+  int64_t first;      ///< Capture ms of the first timed sentence
+  int64_t span;       ///< Capture ms of one pass, with the gap to the next
+  int64_t prev;       ///< Capture ms of the last timed sentence this pass
+  int64_t due;        ///< CLOCK_MONOTONIC ns the last sentence was due
+  uint32_t loops;     ///< Passes completed
+  uint64_t sentences; ///< Sentences handed out
+} dlreplay_t;
+
+///\cond INTERNAL
+// Function Prototypes
+int DlReplayOpen(dlreplay_t *, const char *, int, double);
+int DlReplayNext(dlreplay_t *, char *, size_t);
+int64_t DlReplayDue(const dlreplay_t *);
+void DlReplayClose(dlreplay_t *);
+///\endcond
+#endif
@@ -0,0 +1,94 @@
+/** @file dlsched.cpp
+ *  @brief Sampling scheduler functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlsched.h"
+#include "dlclock.h"
+#include <cerrno>
+#include <cstdio>
+#include <time.h>
+
+/** @brief Account for serving a deadline at time now and move to the next.
+ */
+static void advance(dlchan_t *ch, int64_t now) {
+  int64_t late = now - ch->next;
+
+  ch->runs++;
+  ch->jittersum += late;
+  if (late > ch->jittermax) {
+    ch->jittermax = late;
+  }
+  ch->next += ch->period;
+  if (ch->next <= now) {
+    int64_t missed = (now - ch->next) / ch->period + 1;
+    ch->overruns += missed;
+    ch->next += missed * ch->period;
+  }
+}
+
+/** @brief Set up a channel whose first deadline is one period from now.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param ch channel
+ *  @param name channel name
+ *  @param period period in ns
+ *  @return void
+ */
+void DlChanInit(dlchan_t *ch, const char *name, int64_t period) {
+  *ch = dlchan_t{};
+  snprintf(ch->name, sizeof(ch->name), "%s", name);
+  ch->period = period;
+  ch->next = DlMonotonicNs() + period;
+}
+
+/** @brief Check a channel deadline without sleeping.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param ch channel
+ *  @param now current CLOCK_MONOTONIC time in ns
+ *  @return 1 if the deadline has passed and was consumed, 0 otherwise
+ */
+int DlChanDue(dlchan_t *ch, int64_t now) {
+  if (now < ch->next) {
+    return 0;
+  }
+  advance(ch, now);
+  return 1;
+}
+
+/** @brief Sleep until the earliest channel deadline.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param chans channels served by the calling thread
+ *  @param n number of channels
+ *  @return index of the channel whose deadline was reached, -1 if the sleep
+ *  was interrupted by a signal
+ */
+int DlSchedWait(dlchan_t *chans, int n) {
+  int first = 0;
+  struct timespec ts;
+
+  for (int i = 1; i < n; i++) {
+    if (chans[i].next < chans[first].next) {
+      first = i;
+    }
+  }
+  ts.tv_sec = chans[first].next / 1000000000;
+  ts.tv_nsec = chans[first].next % 1000000000;
+  if (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    return -1;
+  }
+  advance(&chans[first], DlMonotonicNs());
+  return first;
+}
+
+/** @brief Mean lateness of a channel.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param ch channel
+ *  @return mean lateness in ns
+ */
+int64_t DlChanJitterMean(const dlchan_t *ch) {
+  return (ch->runs > 0) ? ch->jittersum / (int64_t)ch->runs : 0;
+}
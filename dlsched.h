@@ -0,0 +1,35 @@
+#ifndef DLSCHED_H
+#define DLSCHED_H
+/** @file dlsched.h
+ *  @brief Absolute-deadline periodic scheduling for sampling channels.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  Each channel has a period and an absolute CLOCK_MONOTONIC deadline.
+ *  Waiting uses clock_nanosleep with TIMER_ABSTIME, so the time spent
+ *  sampling does not stretch the period. Lateness at every wake-up is kept
+ *  as jitter, and deadlines missed by a whole period are skipped and
+ *  counted as overruns instead of being run back to back.
+ */
+#include <cstdint>
+
+#define DLCH_NAMESZ 8
+
+typedef struct dlchan {
+  char name[DLCH_NAMESZ]; ///< Channel name for reports
+  int64_t period;         ///< Period in ns
+  int64_t next;           ///< Next deadline, CLOCK_MONOTONIC ns
+  uint64_t runs;          ///< Deadlines served
+  uint64_t overruns;      ///< Deadlines skipped because they were missed
+  int64_t jittermax;      ///< Worst lateness in ns
+  int64_t jittersum;      ///< Sum of lateness in ns, for the mean
+} dlchan_t;
+
+///\cond INTERNAL
+// Function Prototypes
+void DlChanInit(dlchan_t *, const char *, int64_t);
+int DlChanDue(dlchan_t *, int64_t);
+int DlSchedWait(dlchan_t *, int);
+int64_t DlChanJitterMean(const dlchan_t *);
+///\endcond
+#endif
@@ -0,0 +1,86 @@
+/** @file dlshm.cpp
+ *  @brief Logger side of the shared memory live state.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlshm.h"
+#include <cstring>
+#include <new>
+
+static dlshm_t *shm = NULL;
+static dlshmhist_t hist; ///< Writer copy of the history ring
+
+/** @brief Create the shared memory object and start publishing.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param serial unit serial
+ *  @return 0 on success, -1 on error
+ *
+ *  An object left behind by a logger that did not shut down cleanly is
+ *  replaced, clients still holding it see its last state.
+ */
+int DlShmCreate(uint64_t serial) {
+  int fd;
+
+  shm_unlink(DLSHM_NAME);
+  fd = shm_open(DLSHM_NAME, O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0) {
+    return -1;
+  }
+  if (ftruncate(fd, sizeof(dlshm_t)) < 0) {
+    close(fd);
+    shm_unlink(DLSHM_NAME);
+    return -1;
+  }
+  void *p = mmap(NULL, sizeof(dlshm_t), PROT_READ | PROT_WRITE, MAP_SHARED,
+                 fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    shm_unlink(DLSHM_NAME);
+    return -1;
+  }
+  memset(&hist, 0, sizeof(hist));
+  shm = new (p) dlshm_t();
+  shm->history = DLSHM_HISTORY;
+  shm->size = sizeof(dlshm_t);
+  shm->pid = (uint32_t)getpid();
+  shm->serial = serial;
+  shm->version = DLSHM_VERSION;
+  // Clients check the magic last
+  std::atomic_thread_fence(std::memory_order_release);
+  shm->magic = DLSHM_MAGIC;
+  return 0;
+}
+
+/** @brief Publish a saved reading (single writer).
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param r reading
+ *  @return void
+ */
+void DlShmPublish(const reading_s *r) {
+  dlrecord_t rec;
+
+  if (shm == NULL) {
+    return;
+  }
+  DlLogPack(r, &rec);
+  hist.ring[hist.count % DLSHM_HISTORY] = rec;
+  hist.count++;
+  shm->latest.Store(rec);
+  shm->hist.Store(hist);
+}
+
+/** @brief Stop publishing and remove the shared memory object.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return void
+ */
+void DlShmDestroy(void) {
+  if (shm == NULL) {
+    return;
+  }
+  munmap(shm, sizeof(dlshm_t));
+  shm = NULL;
+  shm_unlink(DLSHM_NAME);
+}
@@ -0,0 +1,134 @@
+#ifndef DLSHM_H
+#define DLSHM_H
+/** @file dlshm.h
+ *  @brief Live logger state in POSIX shared memory, and its client API.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  The logger publishes every saved reading into the DLSHM_NAME shared
+ *  memory object: the latest record and a ring of the last DLSHM_HISTORY
+ *  records, each behind a SeqLock. Readers map the object read-only and
+ *  copy from it with no system calls and without ever seeing a half
+ *  written record. Records use the fixed-width dlrecord_t layout of the
+ *  log segments, so any process on the unit can read them.
+ *
+ *  Clients only need this header: DlShmAttach, DlShmLatest, DlShmHistory
+ *  and DlShmDetach are inline. Link with -lrt on older C libraries.
+ */
+#include "dllog.h"
+#include "seqlock.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define DLSHM_NAME "/vdl-live"
+#define DLSHM_MAGIC 0x4D485344 // "DSHM"
+#define DLSHM_VERSION 3
+#define DLSHM_HISTORY 64
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2,
+              "SeqLock in shared memory needs lock-free atomics");
+
+typedef struct dlshmhist {
+  uint64_t count;                   ///< Records published so far
+  dlrecord_t ring[DLSHM_HISTORY];   ///< Record n is at n % DLSHM_HISTORY
+} dlshmhist_t;
+
+typedef struct dlshm {
+  uint32_t magic;                   ///< DLSHM_MAGIC
+  uint16_t version;                 ///< DLSHM_VERSION
+  uint16_t history;                 ///< DLSHM_HISTORY
+  uint32_t size;                    ///< sizeof(dlshm_t)
+  uint32_t pid;                     ///< Publishing logger
+  uint64_t serial;                  ///< Unit serial from DlGetSerial
+  SeqLock<dlrecord_t> latest;       ///< Latest record
+  SeqLock<dlshmhist_t> hist;        ///< Recent records
+} dlshm_t;
+
+///\cond INTERNAL
+// Function Prototypes, logger side
+int DlShmCreate(uint64_t);
+void DlShmPublish(const reading_s *);
+void DlShmDestroy(void);
+///\endcond
+
+/** @brief Map the live state of a running logger.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return read-only live state, NULL if no logger is publishing
+ */
+inline const dlshm_t *DlShmAttach(void) {
+  struct stat st;
+  int fd = shm_open(DLSHM_NAME, O_RDONLY, 0);
+
+  if (fd < 0) {
+    return NULL;
+  }
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(dlshm_t)) {
+    close(fd);
+    return NULL;
+  }
+  void *p = mmap(NULL, sizeof(dlshm_t), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    return NULL;
+  }
+  const dlshm_t *shm = (const dlshm_t *)p;
+  if (shm->magic != DLSHM_MAGIC || shm->version != DLSHM_VERSION ||
+      shm->size != sizeof(dlshm_t)) {
+    munmap(p, sizeof(dlshm_t));
+    return NULL;
+  }
+  return shm;
+}
+
+/** @brief Unmap the live state.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param shm live state from DlShmAttach
+ *  @return void
+ */
+inline void DlShmDetach(const dlshm_t *shm) {
+  if (shm != NULL) {
+    munmap((void *)shm, sizeof(dlshm_t));
+  }
+}
+
+/** @brief Copy the latest record.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param shm live state
+ *  @param rec output record
+ *  @return publication number of rec, 0 if nothing was published yet
+ */
+inline uint32_t DlShmLatest(const dlshm_t *shm, dlrecord_t *rec) {
+  return shm->latest.Load(*rec);
+}
+
+/** @brief Copy the recent records, oldest first.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param shm live state
+ *  @param out output records
+ *  @param max capacity of out
+ *  @return number of records copied
+ */
+inline size_t DlShmHistory(const dlshm_t *shm, dlrecord_t *out, size_t max) {
+  dlshmhist_t h;
+  size_t n;
+
+  shm->hist.Load(h);
+  n = (h.count < DLSHM_HISTORY) ? (size_t)h.count : DLSHM_HISTORY;
+  if (n > max) {
+    n = max;
+  }
+  for (size_t i = 0; i < n; i++) {
+    out[i] = h.ring[(h.count - n + i) % DLSHM_HISTORY];
+  }
+  return n;
+}
+#endif
@@ -0,0 +1,104 @@
+/** @file dlsimplify.cpp
+ *  @brief Streaming track simplification functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlsimplify.h"
+#include <cmath>
+#include <cstring>
+
+#define RAD (M_PI / 180)
+
+/** @brief Make a point the anchor of the next segment.
+ */
+static void setAnchor(dlsimplify_t *s, const dltrackpt_t *p) {
+  s->anchor = *p;
+  s->mlon7 = DLSIMP_MLAT7 * cos(p->lat / 1e7 * RAD);
+  s->n = 0;
+  s->kept++;
+}
+
+/** @brief Whether every held point is within the error of the segment from
+ *  the anchor to p.
+ */
+static int fits(const dlsimplify_t *s, const dltrackpt_t *p) {
+  const dltrackpt_t &a = s->anchor;
+  double dx = ((int64_t)p->lon - a.lon) * s->mlon7;
+  double dy = ((int64_t)p->lat - a.lat) * DLSIMP_MLAT7;
+  double dz = (double)p->alt - a.alt;
+  double len = dx * dx + dy * dy;
+  double tol2 = s->tol * s->tol;
+
+  for (uint32_t k = 0; k < s->n; k++) {
+    const dltrackpt_t &q = s->win[k];
+    double qx = ((int64_t)q.lon - a.lon) * s->mlon7;
+    double qy = ((int64_t)q.lat - a.lat) * DLSIMP_MLAT7;
+    double t = (len > 0) ? (qx * dx + qy * dy) / len : 0;
+    t = (t < 0) ? 0 : (t > 1) ? 1 : t;
+    double ex = qx - t * dx;
+    double ey = qy - t * dy;
+    if (ex * ex + ey * ey > tol2 ||
+        fabs((double)q.alt - a.alt - t * dz) > s->vtol) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/** @brief Start a new track.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param s simplifier
+ *  @param tol largest error across the ground, metres
+ *  @param vtol largest error in altitude, metres
+ *  @return void
+ */
+void DlSimplifyInit(dlsimplify_t *s, double tol, double vtol) {
+  memset(s, 0, sizeof(*s));
+  s->tol = tol;
+  s->vtol = vtol;
+}
+
+/** @brief Add the next point of the track.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param s simplifier
+ *  @param p point
+ *  @param out set to the new vertex when one is emitted
+ *  @return 1 if out holds a vertex, 0 otherwise
+ */
+int DlSimplifyPush(dlsimplify_t *s, const dltrackpt_t *p, dltrackpt_t *out) {
+  s->points++;
+  if (!s->started) {
+    s->started = 1;
+    setAnchor(s, p);
+    *out = *p;
+    return 1;
+  }
+  if (s->n < DLSIMP_WINDOW && fits(s, p)) {
+    s->win[s->n++] = *p;
+    return 0;
+  }
+  *out = s->win[s->n - 1];
+  setAnchor(s, out);
+  s->win[s->n++] = *p;
+  return 1;
+}
+
+/** @brief End the track, emitting its last point if it is not a vertex yet.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param s simplifier
+ *  @param out set to the last vertex when one is emitted
+ *  @return 1 if out holds a vertex, 0 otherwise
+ *
+ *  The next point pushed continues the track from that vertex.
+ */
+int DlSimplifyFlush(dlsimplify_t *s, dltrackpt_t *out) {
+  if (s->n == 0) {
+    return 0;
+  }
+  *out = s->win[s->n - 1];
+  setAnchor(s, out);
+  return 1;
+}
@@ -0,0 +1,51 @@
+#ifndef DLSIMPLIFY_H
+#define DLSIMPLIFY_H
+/** @file dlsimplify.h
+ *  @brief Streaming simplification of the GPS track.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  Fixes are pushed one at a time and only the vertices needed to redraw
+ *  the track within a set error come out. This is the opening window
+ *  form of Douglas-Peucker: the last vertex anchors a segment to the
+ *  newest point, and while every point since the anchor lies within tol
+ *  metres of that segment across the ground and within vtol metres of it
+ *  in altitude, nothing is emitted. When a point breaks the corridor, the
+ *  point before it becomes the next vertex and the new anchor.
+ *
+ *  At most DLSIMP_WINDOW points are held; a full window forces a vertex,
+ *  so memory and the work per point are bounded however straight the road
+ *  or however long the unit stands still. A vertex is always the first
+ *  point ever pushed or the one pushed just before the current point.
+ */
+#include <cstdint>
+
+#define DLSIMP_WINDOW 64          ///< Points held since the last vertex
+#define DLSIMP_MLAT7 0.011119493 ///< Metres per 1e-7 degree of latitude
+
+typedef struct dltrackpt {
+  int32_t lat; ///< 1e-7 degrees
+  int32_t lon; ///< 1e-7 degrees
+  float alt;   ///< Metres
+  uint32_t tag; ///< Caller's id for the point, such as the fix seq
+} dltrackpt_t;
+
+typedef struct dlsimplify {
+  double tol;                       ///< Error across the ground, metres
+  double vtol;                      ///< Error in altitude, metres
+  dltrackpt_t anchor;               ///< Last vertex
+  double mlon7;                     ///< Metres per 1e-7 degree of longitude
+  dltrackpt_t win[DLSIMP_WINDOW];   ///< Points since the anchor
+  uint32_t n;                       ///< Points in win
+  uint8_t started;                  ///< A point has been pushed
+  uint64_t points;                  ///< Points pushed
+  uint64_t kept;                    ///< Vertices emitted
+} dlsimplify_t;
+
+///\cond INTERNAL
+// Function Prototypes
+void DlSimplifyInit(dlsimplify_t *, double, double);
+int DlSimplifyPush(dlsimplify_t *, const dltrackpt_t *, dltrackpt_t *);
+int DlSimplifyFlush(dlsimplify_t *, dltrackpt_t *);
+///\endcond
+#endif
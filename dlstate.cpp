@@ -0,0 +1,90 @@
+/** @file dlstate.cpp
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @brief Dump the live state of a running logger
+ *
+ *  Usage: dlstate [-j | -c]
+ *
+ *  With no option the latest reading is printed as on the display. -j
+ *  prints it as the loggerdata.json object and -c prints the recent
+ *  history as loggerdata.csv lines, oldest first.
+ */
+
+#include "dlformat.h"
+#include "dlshm.h"
+#include <cstdio>
+#include <unistd.h>
+
+/** @brief Live state dump main function
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return int program status
+ */
+int main(int argc, char *argv[]) {
+  char buf[DLFMT_BUFSZ];
+  dlrecord_t recs[DLSHM_HISTORY];
+  reading_s r;
+  int mode = 't';
+  int opt;
+
+  while ((opt = getopt(argc, argv, "jc")) != -1) {
+    switch (opt) {
+    case 'j':
+    case 'c':
+      mode = opt;
+      break;
+    default:
+      fprintf(stderr, "usage: %s [-j | -c]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  const dlshm_t *shm = DlShmAttach();
+  if (shm == NULL) {
+    fprintf(stderr, "%s: no logger is publishing\n", argv[0]);
+    return 1;
+  }
+  if (mode == 'c') {
+    size_t n = DlShmHistory(shm, recs, DLSHM_HISTORY);
+    for (size_t i = 0; i < n; i++) {
+      DlLogUnpack(&recs[i], &r);
+      if (DlFormatCsv(&r, buf, sizeof(buf)) < 0) {
+        fprintf(stderr, "%s: cannot format reading\n", argv[0]);
+        DlShmDetach(shm);
+        return 1;
+      }
+      fputs(buf, stdout);
+    }
+    DlShmDetach(shm);
+    return 0;
+  }
+
+  uint32_t seq = DlShmLatest(shm, &recs[0]);
+  if (seq == 0) {
+    fprintf(stderr, "%s: nothing published yet\n", argv[0]);
+    DlShmDetach(shm);
+    return 1;
+  }
+  DlLogUnpack(&recs[0], &r);
+  if (mode == 'j') {
+    if (DlFormatJson(&r, buf, sizeof(buf)) < 0) {
+      fprintf(stderr, "%s: cannot format reading\n", argv[0]);
+      DlShmDetach(shm);
+      return 1;
+    }
+    printf("%s\n", buf);
+  } else {
+    printf("Unit %llu, logger pid %u, reading %u\n",
+           (unsigned long long)shm->serial, shm->pid, seq);
+    *DlFmtTime(buf, r.rtime) = '\0';
+    printf("%s\n", buf);
+    if (DlFormatText(&r, buf, sizeof(buf)) < 0) {
+      fprintf(stderr, "%s: cannot format reading\n", argv[0]);
+      DlShmDetach(shm);
+      return 1;
+    }
+    fputs(buf, stdout);
+  }
+  DlShmDetach(shm);
+  return 0;
+}
@@ -0,0 +1,177 @@
+/** @file dlwriter.cpp
+ *  @brief Buffered log writer functions.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "dlwriter.h"
+#include "dlcompress.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+/** @brief Milliseconds elapsed between two CLOCK_MONOTONIC times.
+ */
+static int64_t elapsedMs(const struct timespec *from,
+                         const struct timespec *to) {
+  return (int64_t)(to->tv_sec - from->tv_sec) * 1000 +
+         (to->tv_nsec - from->tv_nsec) / 1000000;
+}
+
+/** @brief Segment close callback, queues the segment for compression.
+ */
+static void segmentClosed(const char *path, void *arg) {
+  (void)arg;
+  DlCompressQueue(path);
+}
+
+/** @brief Open the segment file for a logging session.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param w writer state
+ *  @param dir directory for the log segments
+ *  @param serial unit serial
+ *  @param cfg flush and durability settings
+ *  @return 0 on success, -1 on error
+ */
+int DlWriterOpen(dlwriter_t *w, const char *dir, uint64_t serial,
+                 const dlwriter_cfg_t *cfg) {
+  memset(w, 0, sizeof(*w));
+  w->cfg = *cfg;
+  if (w->cfg.maxrecs == 0 || w->cfg.maxrecs > DLW_MAXBATCH) {
+    w->cfg.maxrecs = DLW_MAXBATCH;
+  }
+  // Segments left uncompressed by a past session are queued before this
+  // one opens its own
+  w->background = (w->cfg.compress > 0 || w->cfg.budget > 0);
+  if (w->background) {
+    DlCompressStart(dir, w->cfg.budget, w->cfg.compress);
+  }
+  if (DlSegOpen(&w->seg, dir, serial, w->cfg.segsize) < 0) {
+    if (w->background) {
+      int err = errno;
+      DlCompressStop();
+      w->background = 0;
+      errno = err;
+    }
+    return -1;
+  }
+  w->seg.period = w->cfg.segperiod;
+  if (w->background) {
+    w->seg.closed = segmentClosed;
+  }
+  // A segment that rolls over must be on disk before it is closed
+  w->seg.syncclose = (w->cfg.fsyncpolicy != DLW_FSYNC_NEVER);
+  clock_gettime(CLOCK_MONOTONIC, &w->lastsync);
+  return 0;
+}
+
+/** @brief Queue one record, flushing the batch when a limit is reached.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param w writer state
+ *  @param rec record to append
+ *  @return 0 on success, -1 if a flush failed, in which case the record is
+ *  dropped only if the batch was still full from an earlier failed flush
+ */
+int DlWriterAppend(dlwriter_t *w, const dlrecord_t *rec) {
+  if (w->count >= w->cfg.maxrecs && DlWriterFlush(w) < 0) {
+    w->dropped++;
+    return -1;
+  }
+  if (w->count == 0) {
+    clock_gettime(CLOCK_MONOTONIC, &w->oldest);
+  }
+  w->batch[w->count++] = *rec;
+  if (w->count >= w->cfg.maxrecs ||
+      (w->cfg.maxbytes > 0 &&
+       w->count * sizeof(dlrecord_t) >= w->cfg.maxbytes)) {
+    return DlWriterFlush(w);
+  }
+  return DlWriterPoll(w);
+}
+
+/** @brief Apply the time based flush and fsync limits.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param w writer state
+ *  @return 0 on success, -1 on error
+ */
+int DlWriterPoll(dlwriter_t *w) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (w->count > 0 && elapsedMs(&w->oldest, &now) >= w->cfg.maxdelayms) {
+    return DlWriterFlush(w);
+  }
+  if (w->cfg.fsyncpolicy == DLW_FSYNC_INTERVAL &&
+      elapsedMs(&w->lastsync, &now) >= w->cfg.fsyncms) {
+    return DlWriterSync(w);
+  }
+  return 0;
+}
+
+/** @brief Write the batched records with a single write.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param w writer state
+ *  @return 0 on success, -1 on error
+ */
+int DlWriterFlush(dlwriter_t *w) {
+  if (w->count > 0) {
+    size_t n;
+    int rc = DlSegAppend(&w->seg, w->batch + w->done, w->count - w->done, &n);
+    w->done += n;
+    if (rc < 0) {
+      return -1;
+    }
+    w->count = 0;
+    w->done = 0;
+    w->flushes++;
+  }
+  switch (w->cfg.fsyncpolicy) {
+  case DLW_FSYNC_BATCH:
+    return DlWriterSync(w);
+  case DLW_FSYNC_INTERVAL: {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (elapsedMs(&w->lastsync, &now) >= w->cfg.fsyncms) {
+      return DlWriterSync(w);
+    }
+    break;
+  }
+  }
+  return 0;
+}
+
+/** @brief Force written records to stable storage.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param w writer state
+ *  @return 0 on success, -1 on error
+ */
+int DlWriterSync(dlwriter_t *w) {
+  clock_gettime(CLOCK_MONOTONIC, &w->lastsync);
+  if (w->seg.fd < 0) {
+    return 0;
+  }
+  w->syncs++;
+  return fdatasync(w->seg.fd);
+}
+
+/** @brief Flush outstanding records and close the session's segment.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param w writer state
+ *  @return void
+ */
+void DlWriterClose(dlwriter_t *w) {
+  DlWriterFlush(w);
+  if (w->cfg.fsyncpolicy == DLW_FSYNC_INTERVAL) {
+    DlWriterSync(w);
+  }
+  DlSegClose(&w->seg);
+  if (w->background) {
+    DlCompressStop();
+    w->background = 0;
+  }
+}
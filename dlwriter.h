@@ -0,0 +1,62 @@
+#ifndef DLWRITER_H
+#define DLWRITER_H
+/** @file dlwriter.h
+ *  @brief Buffered log writer with group commit.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  The writer keeps the segment file open for the whole session. Records
+ *  are batched in memory and written with one write(2) when the batch
+ *  reaches a record count, a byte size or an age limit.
+ *  Closed segments are handed to the dlcompress thread, which also keeps
+ *  the directory within its disk budget.
+ */
+#include "dllog.h"
+#include <cstddef>
+#include <cstdint>
+#include <time.h>
+
+// Durability policies
+#define DLW_FSYNC_NEVER 0    ///< Leave write-back to the kernel
+#define DLW_FSYNC_BATCH 1    ///< fdatasync after every batch
+#define DLW_FSYNC_INTERVAL 2 ///< fdatasync at most every fsyncms
+
+#define DLW_MAXBATCH 1024
+
+typedef struct dlwriter_cfg {
+  size_t maxrecs;       ///< Flush after this many records
+  size_t maxbytes;      ///< Flush after this many bytes
+  uint32_t maxdelayms;  ///< Flush when the oldest record is this old
+  int fsyncpolicy;      ///< One of DLW_FSYNC_*
+  uint32_t fsyncms;     ///< Interval for DLW_FSYNC_INTERVAL
+  size_t segsize;       ///< Size bound of one segment
+  uint32_t segperiod;   ///< Rotation period in seconds, 0 for none
+  uint64_t budget;      ///< Disk budget of the directory, 0 for none
+  int compress;         ///< gzip level for closed segments, 0 for none
+} dlwriter_cfg_t;
+
+typedef struct dlwriter {
+  dlseg_t seg;                    ///< Segment being appended to
+  dlwriter_cfg_t cfg;             ///< Flush and durability settings
+  dlrecord_t batch[DLW_MAXBATCH]; ///< Records waiting to be written
+  size_t count;                   ///< Records in batch
+  size_t done;                    ///< Records of batch already written
+  struct timespec oldest;         ///< When the first batched record arrived
+  struct timespec lastsync;       ///< Last fdatasync
+  uint64_t flushes;               ///< Batches written
+  uint64_t syncs;                 ///< fdatasync calls
+  uint64_t dropped;               ///< Records refused with the batch full
+  int background;                 ///< dlcompress thread started
+} dlwriter_t;
+
+///\cond INTERNAL
+// Function Prototypes
+int DlWriterOpen(dlwriter_t *, const char *, uint64_t,
+                 const dlwriter_cfg_t *);
+int DlWriterAppend(dlwriter_t *, const dlrecord_t *);
+int DlWriterPoll(dlwriter_t *);
+int DlWriterFlush(dlwriter_t *);
+int DlWriterSync(dlwriter_t *);
+void DlWriterClose(dlwriter_t *);
+///\endcond
+#endif
@@ -4,12 +4,16 @@
  *  @date Feb 14 2022
  */
 
+#include <stdint.h>
+
+#define BLANKWIDTH 4 ///< Columns of a blank glyph such as the space
+
 typedef struct {
-  char caractere;
+  uint8_t caractere;
   bool binarypattern[8][8];
 } Tfont;
 
-const Tfont font[] = {{'\n',
+constexpr Tfont font[] = {{'\n',
                        {
                            {0, 0, 0, 0, 0, 0, 0, 0},
                            {0, 0, 0, 0, 0, 0, 0, 0},
@@ -1084,3 +1088,56 @@ const Tfont font[] = {{'\n',
                            {0, 1, 0, 0, 0, 0, 0, 0},
                            {0, 1, 1, 1, 1, 1, 0, 0},
                        }}};
+
+/// Every character code mapped to its glyph, one byte per column
+typedef struct {
+  uint8_t columns[256][8]; ///< Bit j of column k is row j of the glyph
+  uint8_t first[256];      ///< First lit column
+  uint8_t width[256];      ///< Columns from first to the last lit one
+} Tatlas;
+
+/** @brief Build the glyph atlas from the font table.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return atlas where a code missing from font has the glyph of 255 and a
+ *  blank glyph is BLANKWIDTH columns wide
+ */
+constexpr Tatlas MakeAtlas(void) {
+  Tatlas atlas{};
+  bool present[256]{};
+  int n = sizeof(font) / sizeof(Tfont);
+
+  for (int i = 0; i < n; i++) {
+    uint8_t c = font[i].caractere;
+    if (present[c]) {
+      continue;
+    }
+    present[c] = true;
+    int lo = 8, hi = -1;
+    for (int k = 0; k < 8; k++) {
+      uint8_t column = 0;
+      for (int j = 0; j < 8; j++) {
+        column |= font[i].binarypattern[j][k] << j;
+      }
+      atlas.columns[c][k] = column;
+      if (column != 0) {
+        lo = (lo < 8) ? lo : k;
+        hi = k;
+      }
+    }
+    atlas.first[c] = (hi < 0) ? 0 : lo;
+    atlas.width[c] = (hi < 0) ? BLANKWIDTH : hi - lo + 1;
+  }
+  for (int c = 0; c < 256; c++) {
+    if (!present[c]) {
+      for (int k = 0; k < 8; k++) {
+        atlas.columns[c][k] = atlas.columns[255][k];
+      }
+      atlas.first[c] = atlas.first[255];
+      atlas.width[c] = atlas.width[255];
+    }
+  }
+  return atlas;
+}
+
+constexpr Tatlas atlas = MakeAtlas();
@@ -6,9 +6,15 @@
 
 #include "logger.h"
 #include "cursesMatrix.h"
+#include "dlclock.h"
+#include "dlformat.h"
 #include "dlgps.h"
-#include "font.h"
-#include "sensehat.h"
+#include "dlhat.h"
+#include "dlled.h"
+#include "dlshm.h"
+#include "dlwriter.h"
+#include <cerrno>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <ncurses.h>
@@ -17,21 +23,56 @@
 #include <string>
 
 // Global Objects
-SenseHat sh;
+dlwriter_t logwriter;
+
+// Sensor backend, opened at initialization
+static dlhat_t hat;
+
+// Unit serial, read once at initialization
+static uint64_t unitSerial = 0;
+
+// Set by interruptHandler, polled by the main loop
+static volatile sig_atomic_t stopRequested = 0;
 
 using namespace std;
 
 /** @brief Initialize data logger.
  *  @author Caio Cotts
  *  @date Feb 14 2022
- *  @return 0 if initialization successful.
+ *  @return 0 if initialization successful, -1 if the sensors cannot be
+ *  opened, -2 if the log cannot, with errno set
+ *
+ *  The logger still runs if the live state cannot be published, with a
+ *  warning on the start screen.
  */
 int DlInitialization(void) {
 
+  dlwriter_cfg_t wcfg = {LOGBATCHRECS, LOGBATCHBYTES, LOGBATCHMS,
+                         LOGFSYNC,     LOGFSYNCMS,    LOGSEGSZ,
+                         LOGSEGPERIOD, LOGBUDGET,     LOGCOMPRESS};
+  const char *spec = getenv(DLHAT_ENV);
+  spec = (spec != NULL && *spec != '\0') ? spec : HATSPEC;
+  if (DlHatOpen(&hat, spec) < 0) {
+    return -1;
+  }
+  DlLedStart(&hat, LEDFPS);
+  unitSerial = DlGetSerial();
+  if (DlWriterOpen(&logwriter, LOGDIR, unitSerial, &wcfg) < 0) {
+    int err = errno;
+    DlLedStop();
+    DlHatClose(&hat);
+    errno = err;
+    return -2;
+  }
+  int shmerr = (DlShmCreate(unitSerial) < 0) ? errno : 0;
+
 #if CURSE
   DlGpsInit();
   mvprintw(0, 0, "Caio Cotts' CENG252 Vehicle Data Logger\n");
   printw("Data Logger Initialization\n");
+  if (shmerr != 0) {
+    printw("Live state not published: %s\n", strerror(shmerr));
+  }
   refresh();
   for (int i = 0; i <= 30; i++) {
     printw("#");
@@ -44,6 +85,9 @@ int DlInitialization(void) {
   DlGpsInit();
   cout << "Caio Cotts' CENG252 Vehicle Data Logger\n";
   cout << "Data Logger Initialization\n\n";
+  if (shmerr != 0) {
+    cerr << "Live state not published: " << strerror(shmerr) << "\n";
+  }
   return 0;
 #endif
 }
@@ -61,68 +105,209 @@ uint64_t DlGetSerial(void) {
   stringstream buffer;
   buffer << t.rdbuf();
   string buf = buffer.str();
-  regex_search(buf, match, rgx);
+  if (!regex_search(buf, match, rgx)) {
+    return 0;
+  }
   uint64_t serial = stoull(match.str(1));
 
   return serial;
 }
 
-/** @brief Get sensor readings.
+/** @brief Get every IMU sample since the last call.
  *  @author Caio Cotts
- *  @date Feb 14 2022
- *  @return reading_s object
+ *  @date Oct 16 2026
+ *  @param batch output samples, oldest first
+ *  @param max capacity of batch
+ *  @return number of samples, 0 if the IMU had none
+ *
+ *  The sensor backend's FIFO is drained once, so accelerometer, gyro and
+ *  compass of a sample come from the same instant, and each sample is
+ *  stamped with its own capture time on CLOCK_MONOTONIC.
  */
-reading_s DlGetLoggerReadings(void) {
-  reading_s creads{0};
-  creads.rtime = time(NULL);
-  loc_t gpsdata{0};
+int DlGetImuBatch(imu_s *batch, int max) { return DlHatImu(&hat, batch, max); }
+
+/** @brief Get environmental readings, one combined sensor cycle.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return env_s object, holding the previous values if the backend had no
+ *  new sample
+ */
+env_s DlGetEnvReadings(void) {
+  static env_s env{0};
+  dlhatenv_t s;
+
+  if (DlHatEnv(&hat, &s) == 0) {
+    env.t = s.t;
+    env.temperature = s.temperature;
+    env.humidity = s.humidity;
+    env.pressure = s.pressure;
+    env.rawtemp = s.rawtemp;
+    env.cputemp = s.cputemp;
+    env.i2c = s.i2c;
+    env.ns = s.ns;
+  }
+  return env;
+}
 
 #if GPSDEVICE
-  gpsdata = DlGpsLocation();
-  creads.latitude = gpsdata.latitude;
-  creads.longitude = gpsdata.longitude;
-  creads.altitude = gpsdata.altitude;
-  creads.speed = gpsdata.speed;
+/** @brief Copy a receiver fix into a fix_s, setting the clock from a new
+ *  position.
+ */
+static void gpsToFix(const gpsfix_t *gps, uint32_t *lastseq, fix_s *fix) {
+  const loc_t &gpsdata = gps->loc;
+
+  fix->t = gps->post;
+  fix->seq = gps->seq;
+#if !SIMGPS
+  // The capture file replays old dates, only a receiver can set the clock
+  if (gps->seq != *lastseq && gps->velt != 0) {
+    DlClockGpsFix(gpsdata.utc, gpsdata.date, gps->post);
+  }
+#endif
+  *lastseq = gps->seq;
+  fix->latitude = gpsdata.latitude;
+  fix->longitude = gpsdata.longitude;
+  fix->altitude = gpsdata.altitude;
+  fix->speed = gpsdata.speed;
+  fix->course = gpsdata.course;
+  fix->hdop = gpsdata.hdop;
+  fix->vdop = gpsdata.vdop;
+  fix->pdop = gpsdata.pdop;
+  fix->quality = gpsdata.quality;
+  fix->fixtype = gpsdata.fixtype;
+  fix->satused = gpsdata.satused;
+  fix->satview = gpsdata.satview;
+}
+#endif
 
+/** @brief Get the latest GPS fix from the fix cache, without waiting.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return fix_s object, t is 0 until the receiver has sent a position
+ */
+fix_s DlGetGpsReadings(void) {
+  fix_s fix{0};
+
+#if GPSDEVICE
+  static uint32_t lastseq = 0;
+  gpsfix_t gps;
+  DlGpsLatest(&gps);
+  gpsToFix(&gps, &lastseq, &fix);
 #else
-  creads.latitude = DLAT;
-  creads.longitude = DLONG;
-  creads.altitude = DALT;
-  creads.speed = DSPEED;
+  static uint32_t seq = 0;
+  fix.t = DlMonotonicNs();
+  fix.seq = ++seq;
+  fix.latitude = DLAT;
+  fix.longitude = DLONG;
+  fix.altitude = DALT;
+  fix.speed = DSPEED;
+  fix.course = DHEADING;
 
 #endif
+  return fix;
+}
 
-#if SENSEHAT
-  creads.temperature = sh.GetTemperature();
-  creads.humidity = sh.GetHumidity();
-  creads.pressure = sh.GetPressure();
-  sh.GetAcceleration(creads.xa, creads.ya, creads.za);
-  usleep(IMUDELAY);
-  sh.GetOrientation(creads.pitch, creads.roll, creads.yaw);
-  usleep(IMUDELAY);
-  sh.GetMagnetism(creads.xm, creads.ym, creads.zm);
-  usleep(IMUDELAY);
-  creads.heading = DHEADING;
+/** @brief Wait for the next GPS position.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param fix output fix
+ *  @param timeout ms to wait
+ *  @return 1 with the fix of every position the receiver sends, in order,
+ *  0 if none arrived in time
+ *
+ *  Without a GPS device a fixed position comes every GPSPERIOD us. Only
+ *  one thread may wait.
+ */
+int DlWaitGpsReadings(fix_s *fix, int timeout) {
+#if GPSDEVICE
+  static uint32_t lastseq = 0;
+  gpsfix_t gps;
 
+  if (DlGpsNext(&gps, timeout) == 0) {
+    return 0;
+  }
+  *fix = fix_s{0};
+  gpsToFix(&gps, &lastseq, fix);
+  return 1;
 #else
+  static int64_t next = 0;
+  int64_t wait = next - DlMonotonicNs();
 
-  creads.temperature = DTEMP;
-  creads.humidity = DHUMID;
-  creads.pressure = DPRESS;
-  creads.xa = DXA;
-  creads.ya = DYA;
-  creads.za = DZA;
-  creads.pitch = DPITCH;
-  creads.roll = DROLL;
-  creads.yaw = DYAW;
-  creads.xm = DXM;
-  creads.ym = DYM;
-  creads.zm = DZM;
-  creads.heading = DHEADING;
-
+  if (wait > 0) {
+    usleep((wait < timeout * 1000000LL) ? wait / 1000 : timeout * 1000);
+    return 0;
+  }
+  next = DlMonotonicNs() + (int64_t)GPSPERIOD * 1000;
+  *fix = DlGetGpsReadings();
+  return 1;
 #endif
+}
 
-  return creads;
+/** @brief Merge the latest sample of each sensor group into a reading.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param creads reading to update
+ *  @param imu IMU sample, NULL to leave those fields alone
+ *  @param env environmental sample, NULL to leave those fields alone
+ *  @param fix GPS fix, NULL to leave those fields alone
+ *  @return void
+ *
+ *  Position and speed come from the IMU sample once it carries a fused
+ *  position, since that is newer than any fix.
+ */
+void DlMergeReadings(reading_s *creads, const imu_s *imu, const env_s *env,
+                     const fix_s *fix) {
+  if (fix != NULL) {
+    creads->gpst = fix->t;
+    creads->latitude = fix->latitude;
+    creads->longitude = fix->longitude;
+    creads->altitude = fix->altitude;
+    creads->speed = fix->speed;
+    creads->hdop = fix->hdop;
+    creads->vdop = fix->vdop;
+    creads->pdop = fix->pdop;
+    creads->quality = fix->quality;
+    creads->fixtype = fix->fixtype;
+    creads->satused = fix->satused;
+    creads->satview = fix->satview;
+    creads->fence = fix->fence;
+  }
+  if (imu != NULL) {
+    creads->imut = imu->t;
+    creads->xa = imu->xa;
+    creads->ya = imu->ya;
+    creads->za = imu->za;
+    creads->pitch = imu->pitch;
+    creads->roll = imu->roll;
+    creads->yaw = imu->yaw;
+    creads->xm = imu->xm;
+    creads->ym = imu->ym;
+    creads->zm = imu->zm;
+    creads->heading = imu->heading;
+    if (imu->nav) {
+      creads->latitude = imu->latitude;
+      creads->longitude = imu->longitude;
+      creads->speed = imu->speed;
+    }
+  }
+  if (env != NULL) {
+    creads->envt = env->t;
+    creads->temperature = env->temperature;
+    creads->humidity = env->humidity;
+    creads->pressure = env->pressure;
+  }
+}
+
+/** @brief Set the wall clock time of a reading and the offset to convert its
+ *  capture stamps.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param creads reading to update
+ *  @return void
+ */
+void DlStampReading(reading_s *creads) {
+  creads->wallofs = DlClockOffset();
+  creads->rtime = (time_t)((DlMonotonicNs() + creads->wallofs) / 1000000000);
 }
 
 /** @brief Print sensor readings to standard out.
@@ -131,31 +316,22 @@ reading_s DlGetLoggerReadings(void) {
  *  @return void
  */
 void DlDisplayLoggerReadings(reading_s lreads) {
+  char text[DLFMT_BUFSZ];
+  char ltime[26];
+
+  ctime_r(&lreads.rtime, ltime);
+  DlFormatText(&lreads, text, sizeof(text));
 #if CURSE
-  printw("Unit: %Li", DlGetSerial());
-  printw(" %s\n", ctime(&lreads.rtime));
-  printw("T: %.1fC\t\tH: %.0f%\t\t\tP: %.1fkPa\n", lreads.temperature,
-         lreads.humidity, lreads.pressure);
-  printw("Xa: %fg\t\tYa: %fg\t\tZa: %fg\n", lreads.xa, lreads.ya, lreads.za);
-  printw("Pitch: %f \tRoll: %f\t\tYaw: %f\n", lreads.pitch, lreads.roll,
-         lreads.yaw);
-  printw("Xm: %f\t\tYm: %f\t\tZm: %f\n", lreads.xm, lreads.ym, lreads.zm);
-  printw("Latitude: %f\tLongitude: %f\tAltitude: %f\n", lreads.latitude,
-         lreads.longitude, lreads.altitude);
-  printw("Speed: %f \tHeading: %f\n\n", lreads.speed, lreads.heading);
+  printw("Unit: %llu %s\n", (unsigned long long)unitSerial, ltime);
+  addstr(text);
+  printw("Fix: %u Sats: %u/%u HDOP: %.1f VDOP: %.1f\n", lreads.quality,
+         lreads.satused, lreads.satview, lreads.hdop, lreads.vdop);
 
 #else
-  cout << "Unit: " << DlGetSerial();
-  printf(" %s\n", ctime(&lreads.rtime));
-  printf("T: %.1fC\t\tH: %.0f%\t\t\tP: %.1fkPa\n", lreads.temperature,
-         lreads.humidity, lreads.pressure);
-  printf("Xa: %fg\t\tYa: %fg\t\tZa: %fg\n", lreads.xa, lreads.ya, lreads.za);
-  printf("Pitch: %f \tRoll: %f\t\tYaw: %f\n", lreads.pitch, lreads.roll,
-         lreads.yaw);
-  printf("Xm: %f\t\tYm: %f\t\tZm: %f\n", lreads.xm, lreads.ym, lreads.zm);
-  printf("Latitude: %f\tLongitude: %f\tAltitude: %f\n", lreads.latitude,
-         lreads.longitude, lreads.altitude);
-  printf("Speed: %f \tHeading: %f\n\n", lreads.speed, lreads.heading);
+  printf("Unit: %llu %s\n", (unsigned long long)unitSerial, ltime);
+  fputs(text, stdout);
+  printf("Fix: %u Sats: %u/%u HDOP: %.1f VDOP: %.1f\n", lreads.quality,
+         lreads.satused, lreads.satview, lreads.hdop, lreads.vdop);
 
 #endif
 }
@@ -163,136 +339,100 @@ void DlDisplayLoggerReadings(reading_s lreads) {
 /** @brief Save sensor readings.
  *  @author Caio Cotts
  *  @date Feb 14 2022
- *  @return 0 if data was saved successfuly
+ *  @return 1 if data was saved, 0 if the writer failed
  */
 int DlSaveLoggerData(reading_s creads) {
-#if CURSE
-  mvprintw(15, 70, "Saving Logger Data...\n\n");
-
-  FILE *fp;
-  char ltime[TIMESTRSZ];
-  char jsondata[PAYLOADSTRSZ];
+  dlrecord_t rec;
 
-  fp = fopen("loggerdata.csv", "a");
-  if (fp == NULL) {
+  DlShmPublish(&creads);
+  DlLogPack(&creads, &rec);
+  if (DlWriterAppend(&logwriter, &rec) < 0) {
     return 0;
   }
-
-  strcpy(ltime, ctime(&creads.rtime));
-
-  int commaIndex[] = {3, 7, 10, 19};
-
-  for (int i : commaIndex) {
-    ltime[i] = ',';
-  }
-
-  fprintf(fp,
-          "%.24s,%3.1f,%3.0f,%3.1f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",
-          ltime, creads.temperature, creads.humidity, creads.pressure,
-          creads.xa, creads.ya, creads.za, creads.pitch, creads.roll,
-          creads.yaw, creads.xm, creads.ym, creads.zm, creads.latitude,
-          creads.longitude, creads.altitude, creads.speed, creads.heading);
-
-  fclose(fp);
-
-  sprintf(jsondata,
-          "{\n\t\"temperature\":%-3.1f,\n\t\"humidity\":%-3.0f,"
-          "\n\t\"pressure\":%-3.1f,\n\t\"xa\":%-f,\n\t\"ya\":%-f,\n\t\"za\":%-"
-          "f,\\n\t\"pitch\":%-f,\n\t\"roll\":%-f,\n\t\"yaw\":%-f,\n\t\"xm\":%-"
-          "f,\n\t\"ym\":%-f,\n\t\"zm\":%-f,\n\t\"latitude\":%-f,"
-          "\n\t\"longitude\":%-f,\n\t\"altitude\":%-f,\n\t\"speed\":%-f,"
-          "\n\t\"heading\":%-f,\n\t\"active\": true\n}",
-          creads.rtime, creads.temperature, creads.humidity, creads.pressure,
-          creads.xa, creads.ya, creads.za, creads.pitch, creads.roll,
-          creads.yaw, creads.xm, creads.ym, creads.zm, creads.latitude,
-          creads.longitude, creads.altitude, creads.speed, creads.heading);
-
-  fp = fopen("loggerdata.json", "w");
-  if (fp == NULL) {
-    return -1;
+  return 1;
+}
+/** @brief Save sensor readings without their GPS fix.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param creads reading to save
+ *  @param fused position and speed come from the fusion filter
+ *  @return 1 if data was saved, 0 if the writer failed
+ *
+ *  The shared state still gets the whole reading. The log record has no
+ *  altitude, fix quality or satellites and gpst is 0, so a raw fix is only
+ *  stored with the records that carry it on purpose, such as track
+ *  vertices. A fused position and speed are kept, as is heading and the
+ *  geofence the unit is in; without a fused position the record has none.
+ */
+int DlSaveSensorData(reading_s creads, int fused) {
+  dlrecord_t rec;
+
+  DlShmPublish(&creads);
+  if (!fused) {
+    creads.latitude = 0;
+    creads.longitude = 0;
+    creads.speed = 0;
   }
-
-  fprintf(fp, jsondata);
-  fclose(fp);
-#else
-  FILE *fp;
-  char ltime[TIMESTRSZ];
-  char jsondata[PAYLOADSTRSZ];
-
-  fp = fopen("loggerdata.csv", "a");
-  if (fp == NULL) {
+  creads.gpst = 0;
+  creads.altitude = 0;
+  creads.hdop = 0;
+  creads.vdop = 0;
+  creads.pdop = 0;
+  creads.quality = 0;
+  creads.fixtype = 0;
+  creads.satused = 0;
+  creads.satview = 0;
+  DlLogPack(&creads, &rec);
+  if (DlWriterAppend(&logwriter, &rec) < 0) {
     return 0;
   }
-
-  strcpy(ltime, ctime(&creads.rtime));
-
-  int commaIndex[] = {3, 7, 10, 19};
-
-  for (int i : commaIndex) {
-    ltime[i] = ',';
-  }
-
-  fprintf(fp,
-          "%.24s,%3.1f,%3.0f,%3.1f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f\n",
-          ltime, creads.temperature, creads.humidity, creads.pressure,
-          creads.xa, creads.ya, creads.za, creads.pitch, creads.roll,
-          creads.yaw, creads.xm, creads.ym, creads.zm, creads.latitude,
-          creads.longitude, creads.altitude, creads.speed, creads.heading);
-
-  fclose(fp);
-
-  sprintf(jsondata,
-          "{\n\t\"temperature\":%-3.1f,\n\t\"humidity\":%-3.0f,"
-          "\n\t\"pressure\":%-3.1f,\n\t\"xa\":%-f,\n\t\"ya\":%-f,\n\t\"za\":%-"
-          "f,\\n\t\"pitch\":%-f,\n\t\"roll\":%-f,\n\t\"yaw\":%-f,\n\t\"xm\":%-"
-          "f,\n\t\"ym\":%-f,\n\t\"zm\":%-f,\n\t\"latitude\":%-f,"
-          "\n\t\"longitude\":%-f,\n\t\"altitude\":%-f,\n\t\"speed\":%-f,"
-          "\n\t\"heading\":%-f,\n\t\"active\": true\n}",
-          creads.rtime, creads.temperature, creads.humidity, creads.pressure,
-          creads.xa, creads.ya, creads.za, creads.pitch, creads.roll,
-          creads.yaw, creads.xm, creads.ym, creads.zm, creads.latitude,
-          creads.longitude, creads.altitude, creads.speed, creads.heading);
-
-  fp = fopen("loggerdata.json", "w");
-  if (fp == NULL) {
-    return -1;
-  }
-
-  fprintf(fp, jsondata);
-  fclose(fp);
-#endif
   return 1;
 }
-void DlDisplayLogo() {
-  uint16_t logo[8][8] = {
-      HB, HB, HB, HB, HB, HB, HB, HB, HB, HB, HW, HB, HB, HW, HB, HY,
-      HB, HB, HW, HB, HB, HW, HY, HY, HB, HB, HW, HB, HB, HW, HY, HY,
-      HB, HB, HW, HW, HW, HW, HY, HY, HB, HB, HW, HY, HY, HW, HY, HY,
-      HB, HY, HW, HY, HY, HW, HY, HY, HY, HY, HY, HY, HY, HY, HY, HY,
-  };
-  sh.WipeScreen();
-  sh.ViewPattern(logo);
+void DlDisplayLogo() { DlLedScene(DLLED_LOGO); }
+void DlUpdateLevel(float xa, float ya) { DlLedLevel(xa, ya); }
+
+/** @brief Show the GPS fix and geofence status glyphs on the LED matrix.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param lreads latest readings
+ *  @return void
+ */
+void DlUpdateStatus(reading_s lreads) {
+  DlLedStatus(DLLED_GPS, (lreads.quality > 0) ? HG : 0);
+  DlLedStatus(DLLED_FENCE, (lreads.fence != 0) ? HR : 0);
 }
-void DlUpdateLevel(float xa, float ya) {
-  int x = (int)(ya * -30.0 + 4);
-  int y = (int)(xa * -30.0 + 4);
-  sh.WipeScreen();
-  if (x < 0) {
-    x = 0;
-  } else if (x > 6) {
-    x = 6;
-  }
 
-  if (y < 0) {
-    y = 0;
-  } else if (y > 6) {
-    y = 6;
-  }
+/** @brief Apply the time based flush limits of the log writer.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return 0 on success, -1 on error
+ */
+int DlPollLoggerData(void) { return DlWriterPoll(&logwriter); }
 
-  sh.LightPixel(x, y, HY);
-  sh.LightPixel(x + 1, y, HY);
-  sh.LightPixel(x, y + 1, HY);
-  sh.LightPixel(x + 1, y + 1, HY);
+/** @brief Flush and close the log files.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return void
+ */
+void DlShutdown(void) {
+  DlWriterClose(&logwriter);
+  DlShmDestroy();
+  DlGpsOff();
+  DlLedStop();
+  DlHatClose(&hat);
 }
 
-void interruptHandler() {}
\ No newline at end of file
+/** @brief Check whether the logger should keep running.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return 0 once SIGINT or SIGTERM has been received
+ */
+int DlRunning(void) { return !stopRequested; }
+
+/** @brief SIGINT/SIGTERM handler, asks the main loop to stop.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param sig signal number
+ *  @return void
+ */
+void interruptHandler(int sig) { stopRequested = 1; }
\ No newline at end of file
@@ -3,6 +3,8 @@
  *  @author Caio Cotts
  *  @date  24 jan 22
  */
+#ifndef LOGGER_H
+#define LOGGER_H
 
 #include <cstdint>
 #include <string>
@@ -24,23 +26,53 @@ using namespace std;
 #define DXM 1
 #define DYM 1
 #define DZM 1
-#define DLAT 43.7289
-#define DLONG -79.6074
+#define DLAT 437289000   ///< 43.7289 N in 1e-7 degrees
+#define DLONG -796074000 ///< 79.6074 W in 1e-7 degrees
+#define DLDEGE7 10000000 ///< Coordinate units per degree
 #define DALT 166
 #define DSPEED 99
 #define DHEADING 320
 #define SEARCHSTR "serial\t\t:"
 #define SYSINFOBUSZ 512
 #define SENSEHAT 1
-#define IMUDELAY 200000
+#if SENSEHAT && DLHAT_HW
+#define HATSPEC "hardware" ///< Sensor backend unless VDL_HAT names one
+#else
+#define HATSPEC "synthetic"
+#endif
 #define HB 0x00E7
 #define HY 0xC4A0
 #define HW 0xFFFF
-#define LOGCOUNT 10
+#define HG 0x07E0
+#define HR 0xF800
 #define SLEEPTIME 500000
+#define LEDFPS 25 ///< LED matrix frames a second
 #define GPSDEVICE 1
 #define TIMESTRSZ 25
 #define PAYLOADSTRSZ 400
+#define LOGDIR "."
+#define LOGSEGSZ (16 * 1024 * 1024)
+#define LOGBATCHRECS 64
+#define LOGBATCHBYTES 0
+#define LOGBATCHMS 10000
+#define LOGFSYNC DLW_FSYNC_INTERVAL
+#define LOGFSYNCMS 30000
+#define LOGSEGPERIOD 3600
+#define LOGBUDGET (1024ULL * 1024 * 1024)
+#define LOGCOMPRESS 6
+#define FENCEFILE "fences.txt" ///< Geofences, see dlfence.h
+#define FENCEEVENTS 4 ///< Geofence events one fix can carry
+#define IMUPERIOD 10000
+#define IMUBATCH 32 ///< IMU samples taken from the FIFO per poll, at most
+#define ENVPERIOD 1000000
+#define GPSPERIOD 1000000 ///< us between fixed positions without GPSDEVICE
+#define GPSWAIT 200 ///< ms the GPS thread waits for a position at a time
+#define PERSISTPERIOD 50000
+#define IMUSAVEPERIOD 100000
+#define IMUSAVEALL 0 ///< 1 writes a record for every IMU sample instead
+#define ENVSAVEPERIOD 1000000
+#define TRACKTOL 5.0   ///< Stored track error across the ground, m
+#define TRACKVTOL 10.0 ///< Stored track error in altitude, m
 
 struct reading_s {
   time_t rtime;      ///< Reading time
@@ -56,21 +88,99 @@ struct reading_s {
   float xm;          ///< X axis micro Teslas
   float ym;          ///< Y axis micro Teslas
   float zm;          ///< Z axis micro Teslas
-  float latitude;    ///< Latitude
-  float longitude;   ///< Longitude
+  int32_t latitude;  ///< Latitude, 1e-7 degrees
+  int32_t longitude; ///< Longitude, 1e-7 degrees
   float altitude;    ///< Altitude
   float speed;       ///< Speed kph
   float heading;     ///< Heading degrees True
+  int64_t imut;      ///< IMU capture time, CLOCK_MONOTONIC ns
+  int64_t envt;      ///< Environmental capture time, CLOCK_MONOTONIC ns
+  int64_t gpst;      ///< GPS fix time, CLOCK_MONOTONIC ns
+  int64_t wallofs;   ///< Wall clock minus CLOCK_MONOTONIC, ns
+  float hdop;        ///< Horizontal dilution of precision, 0 if unknown
+  float vdop;        ///< Vertical dilution of precision, 0 if unknown
+  float pdop;        ///< Position dilution of precision, 0 if unknown
+  uint8_t quality;   ///< GGA fix quality, 0 no fix
+  uint8_t fixtype;   ///< GSA fix type, 1 none, 2 2D, 3 3D
+  uint8_t satused;   ///< Satellites used in the solution
+  uint8_t satview;   ///< Satellites in view, all systems
+  int32_t fence;     ///< Id of a geofence the position is in, 0 for none
+  int32_t fenceev;   ///< Geofence +id entered or -id left, 0 for none
+};
+
+struct imu_s {
+  int64_t t;   ///< Capture time, CLOCK_MONOTONIC ns
+  float xa;    ///< X-axis accelaration
+  float ya;    ///< Y-axis accelaration
+  float za;    ///< Z-axis accelaration
+  float pitch; ///< Pitch angle
+  float roll;  ///< Roll angle
+  float yaw;   ///< Yaw angle
+  float xm;    ///< X axis micro Teslas
+  float ym;    ///< Y axis micro Teslas
+  float zm;    ///< Z axis micro Teslas
+  int32_t latitude;  ///< Fused latitude, 1e-7 degrees, when nav
+  int32_t longitude; ///< Fused longitude, 1e-7 degrees, when nav
+  float speed;       ///< Fused speed kph, when nav
+  float heading;     ///< Heading degrees True
+  uint8_t nav;       ///< Position and speed are fused
+  float fpitch;      ///< RTIMULib fusion pitch, radians, when pose
+  float froll;       ///< RTIMULib fusion roll, radians, when pose
+  float fyaw;        ///< RTIMULib fusion yaw, radians, when pose
+  uint8_t pose;      ///< Fusion pose is valid
+};
+
+struct env_s {
+  int64_t t;         ///< Capture time, CLOCK_MONOTONIC ns
+  float temperature; ///< Degrees Celsius, corrected for the CPU
+  float humidity;    ///< Per cent relative humidity
+  float pressure;    ///< Kilo Pascals
+  float rawtemp;     ///< Sensor degrees Celsius before the correction
+  float cputemp;     ///< CPU degrees Celsius, NaN if unknown
+  uint32_t i2c;      ///< I2C transactions of the sample
+  uint32_t ns;       ///< Time the sample took
+};
+
+struct fix_s {
+  int64_t t;       ///< Position time, CLOCK_MONOTONIC ns, 0 before any
+  uint32_t seq;    ///< Positions received, changes with every new fix
+  int32_t latitude;  ///< Latitude, 1e-7 degrees
+  int32_t longitude; ///< Longitude, 1e-7 degrees
+  float altitude;  ///< Altitude
+  float speed;     ///< Speed kph
+  float course;    ///< Course over ground, degrees True
+  float hdop;      ///< Horizontal dilution of precision, 0 if unknown
+  float vdop;      ///< Vertical dilution of precision, 0 if unknown
+  float pdop;      ///< Position dilution of precision, 0 if unknown
+  uint8_t quality; ///< GGA fix quality, 0 no fix
+  uint8_t fixtype; ///< GSA fix type, 1 none, 2 2D, 3 3D
+  uint8_t satused; ///< Satellites used in the solution
+  uint8_t satview; ///< Satellites in view, all systems
+  int32_t fence;   ///< Id of a geofence the position is in, 0 for none
+  uint8_t nevents; ///< Geofence events of this fix
+  int32_t events[FENCEEVENTS]; ///< +id entered, -id left
 };
 
 // Function Prototypes
 ///\cond INTERNAL
 int DlInitialization(void);
 uint64_t DlGetSerial(void);
-reading_s DlGetLoggerReadings(void);
+int DlGetImuBatch(imu_s *, int);
+env_s DlGetEnvReadings(void);
+fix_s DlGetGpsReadings(void);
+int DlWaitGpsReadings(fix_s *, int);
+void DlMergeReadings(reading_s *creads, const imu_s *imu, const env_s *env,
+                     const fix_s *fix);
+void DlStampReading(reading_s *creads);
 void DlDisplayLoggerReadings(reading_s lreads);
 int DlSaveLoggerData(reading_s creads);
+int DlSaveSensorData(reading_s creads, int fused);
+int DlPollLoggerData(void);
 void DlDisplayLogo(void);
 void DlUpdateLevel(float xa, float ya);
-void interruptHandler();
-///\endcond
\ No newline at end of file
+void DlUpdateStatus(reading_s lreads);
+void DlShutdown(void);
+int DlRunning(void);
+void interruptHandler(int sig);
+///\endcond
+#endif
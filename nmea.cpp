@@ -2,66 +2,485 @@
  *  @brief NMEA Functions
  */
 #include "nmea.h"
+#include "nmeascan.h"
 #include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 
-/** @brief Parses GPGGA Message
- *  @author Paul Moggach
- *  @date 25MAR2019
- *  @param char * nmea Pointer to message
- *  @param gpgg_t * loc Pointer to output data structure
+static const double pow10tab[] = {1e0, 1e1, 1e2, 1e3, 1e4,
+                                  1e5, 1e6, 1e7, 1e8, 1e9};
+
+/** @brief Value of a hexadecimal digit, -1 for anything else.
  */
-void nmea_parse_gpgga(char *nmea, gpgga_t *loc) {
-  char *p = nmea;
+static int hexval(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
 
-  p = strchr(p, ',') + 1; // time
-  loc->utc = atof(p);
+/** @brief First character of a field, '\0' when the field is empty or
+ *  missing.
+ */
+static char fieldChar(const nmeatok_t *tok, int i) {
+  return (i < tok->nfields && tok->len[i] > 0) ? tok->field[i][0] : '\0';
+}
 
-  p = strchr(p, ',') + 1;
-  loc->latitude = atof(p);
+/** @brief Numeric value of a field, 0 when the field is empty or missing.
+ */
+static double fieldNumber(const nmeatok_t *tok, int i) {
+  return (i < tok->nfields) ? nmea_number(tok->field[i], tok->len[i]) : 0;
+}
 
-  p = strchr(p, ',') + 1;
-  switch (p[0]) {
-  case 'N':
-    loc->lat = 'N';
-    break;
-  case 'S':
-    loc->lat = 'S';
-    break;
-  case ',':
-    loc->lat = '\0';
-    break;
+/** @brief Signed coordinate of a field and its hemisphere field, 0 when
+ *  either is missing.
+ */
+static int32_t fieldCoord(const nmeatok_t *tok, int i) {
+  if (i + 1 >= tok->nfields) {
+    return 0;
   }
+  return nmea_coord(tok->field[i], tok->len[i], fieldChar(tok, i + 1));
+}
 
-  p = strchr(p, ',') + 1;
-  loc->longitude = atof(p);
+/** @brief Talker of a two letter address prefix, NMEA_TALKER_NONE if it is
+ *  not a satellite system.
+ */
+static uint8_t talkerOf(const char *a) {
+  switch ((a[0] << 8) | a[1]) {
+  case ('G' << 8) | 'P':
+    return NMEA_TALKER_GP;
+  case ('G' << 8) | 'L':
+    return NMEA_TALKER_GL;
+  case ('G' << 8) | 'A':
+    return NMEA_TALKER_GA;
+  case ('G' << 8) | 'B':
+  case ('B' << 8) | 'D':
+    return NMEA_TALKER_GB;
+  case ('G' << 8) | 'Q':
+    return NMEA_TALKER_GQ;
+  case ('G' << 8) | 'N':
+    return NMEA_TALKER_GN;
+  }
+  return NMEA_TALKER_NONE;
+}
 
-  p = strchr(p, ',') + 1;
-  switch (p[0]) {
-  case 'W':
-    loc->lon = 'W';
-    break;
-  case 'E':
-    loc->lon = 'E';
-    break;
-  case ',':
-    loc->lon = '\0';
-    break;
+/** @brief Sentence type of a three letter sentence ID, NMEA_UNKNOWN if no
+ *  parser is registered for it.
+ */
+static uint8_t sentenceOf(const char *id) {
+  switch ((id[0] << 16) | (id[1] << 8) | id[2]) {
+  case ('G' << 16) | ('G' << 8) | 'A':
+    return NMEA_GGA;
+  case ('R' << 16) | ('M' << 8) | 'C':
+    return NMEA_RMC;
+  case ('G' << 16) | ('L' << 8) | 'L':
+    return NMEA_GLL;
+  case ('V' << 16) | ('T' << 8) | 'G':
+    return NMEA_VTG;
+  case ('G' << 16) | ('S' << 8) | 'A':
+    return NMEA_GSA;
+  case ('G' << 16) | ('S' << 8) | 'V':
+    return NMEA_GSV;
   }
+  return NMEA_UNKNOWN;
+}
 
-  p = strchr(p, ',') + 1;
-  loc->quality = (uint8_t)atoi(p);
+/** @brief Split, check and identify one sentence.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param buf sentence, need not be terminated
+ *  @param len bytes available at buf
+ *  @param tok output fields, pointing into buf
+ *  @return NMEA_GGA, NMEA_RMC, NMEA_GLL, NMEA_VTG, NMEA_GSA, NMEA_GSV or
+ *  NMEA_UNKNOWN for a valid sentence,
+ *  NMEA_CHECKSUM_ERR if the checksum does not match, NMEA_MESSAGE_ERR if
+ *  there is no '$', no '*' or no checksum digits
+ *
+ *  The fields are found from the delimiter masks of nmea_scan_kernel, 64
+ *  bytes at a time, and the checksum is XORed by the same kernel. The
+ *  fields are filled in even when the checksum does not match. A line end
+ *  or NUL before the '*' ends the sentence as truncated.
+ */
+uint8_t nmea_tokenize(const char *buf, size_t len, nmeatok_t *tok) {
+  const nmeakernel_t *k = nmea_scan_kernel();
+  const char *end = buf + len;
+  const char *p;
+  const char *start;
+  const char *block;
+  nmeamask_t m;
 
-  p = strchr(p, ',') + 1;
-  loc->satellites = (uint8_t)atoi(p);
+  tok->nfields = 0;
+  tok->talker = NMEA_TALKER_NONE;
+  tok->type = NMEA_MESSAGE_ERR;
+  p = (const char *)memchr(buf, '$', len);
+  if (p == NULL) {
+    return tok->type;
+  }
+  start = ++p;
+  p = end;
+  for (block = start; block < end; block += NMEA_SCANBLOCK) {
+    size_t n = (size_t)(end - block);
+    k->classify(block, n < NMEA_SCANBLOCK ? n : NMEA_SCANBLOCK, &m);
+    uint64_t commas = m.comma;
+    if (m.stop != 0) {
+      // Only the commas before the first stop belong to this sentence
+      commas &= (m.stop & -m.stop) - 1;
+    }
+    while (commas != 0) {
+      const char *c = block + __builtin_ctzll(commas);
+      if (tok->nfields < NMEA_MAXFIELDS) {
+        tok->field[tok->nfields] = start;
+        tok->len[tok->nfields++] = (uint16_t)(c - start);
+      }
+      start = c + 1;
+      commas &= commas - 1;
+    }
+    if (m.stop != 0) {
+      p = block + __builtin_ctzll(m.stop);
+      break;
+    }
+  }
+  if (tok->nfields < NMEA_MAXFIELDS) {
+    tok->field[tok->nfields] = start;
+    tok->len[tok->nfields++] = (uint16_t)(p - start);
+  }
+  uint8_t sum = k->checksum(tok->field[0], (size_t)(p - tok->field[0]));
+  if (p + 2 >= end || *p != '*') {
+    return tok->type;
+  }
+  int hi = hexval(p[1]);
+  int lo = hexval(p[2]);
+  if (hi < 0 || lo < 0) {
+    return tok->type;
+  }
+  if (((hi << 4) | lo) != sum) {
+    tok->type = NMEA_CHECKSUM_ERR;
+  } else if (tok->len[0] == 5) {
+    tok->talker = talkerOf(tok->field[0]);
+    tok->type = (tok->talker != NMEA_TALKER_NONE)
+                    ? sentenceOf(tok->field[0] + 2)
+                    : NMEA_UNKNOWN;
+  } else {
+    tok->type = NMEA_UNKNOWN;
+  }
+  return tok->type;
+}
+
+/** @brief Convert a decimal field to fixed point.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param s field text, need not be terminated
+ *  @param len length of the field
+ *  @param decimals digits kept after the decimal point
+ *  @return value times 10^decimals, rounded half away from zero,
+ *  NMEA_BADFIXED if it would reach NMEA_FIXEDMAX
+ *
+ *  Parsing stops at the first character that is not part of the number,
+ *  an empty field is 0. No digit is taken once the value reaches
+ *  NMEA_FIXEDMAX, so a long run of digits cannot overflow.
+ */
+int64_t nmea_fixed(const char *s, size_t len, int decimals) {
+  size_t i = 0;
+  int64_t v = 0;
+  int frac = -1;
+  bool neg = false;
+  bool up = false;
+
+  if (i < len && (s[i] == '-' || s[i] == '+')) {
+    neg = (s[i++] == '-');
+  }
+  for (; i < len; i++) {
+    char c = s[i];
+    if (c == '.' && frac < 0) {
+      frac = 0;
+      continue;
+    }
+    if (c < '0' || c > '9') {
+      break;
+    }
+    if (frac == decimals) {
+      up = (c >= '5');
+      break;
+    }
+    if (frac >= 0) {
+      frac++;
+    }
+    if (v >= NMEA_FIXEDMAX / 10) {
+      return NMEA_BADFIXED;
+    }
+    v = v * 10 + (c - '0');
+  }
+  for (frac = (frac < 0) ? 0 : frac; frac < decimals; frac++) {
+    if (v >= NMEA_FIXEDMAX / 10) {
+      return NMEA_BADFIXED;
+    }
+    v *= 10;
+  }
+  v += up;
+  return neg ? -v : v;
+}
+
+/** @brief Convert a decimal field to a double without atof.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param s field text, need not be terminated
+ *  @param len length of the field
+ *  @return value of the field, 0 if it is empty
+ *
+ *  Up to nine decimals are kept, further digits are dropped. The result is
+ *  the correctly rounded quotient of two exact integers.
+ */
+double nmea_number(const char *s, size_t len) {
+  size_t i = 0;
+  int64_t v = 0;
+  int frac = -1;
+  bool neg = false;
 
-  p = strchr(p, ',') + 1;
+  if (i < len && (s[i] == '-' || s[i] == '+')) {
+    neg = (s[i++] == '-');
+  }
+  for (; i < len; i++) {
+    unsigned d = (unsigned)(s[i] - '0');
+    if (d > 9) {
+      if (s[i] != '.' || frac >= 0) {
+        break;
+      }
+      frac = 0;
+    } else if (frac < 9) {
+      v = v * 10 + d;
+      frac += (frac >= 0);
+    }
+  }
+  double r = (frac > 0) ? (double)v / pow10tab[frac] : (double)v;
+  return neg ? -r : r;
+}
+
+/** @brief Convert a ddmm.mmmm or dddmm.mmmm coordinate to 1e-7 degrees.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param s field text, need not be terminated
+ *  @param len length of the field
+ *  @param hemi hemisphere, 'S' and 'W' are negative
+ *  @return signed degrees times NMEA_DEGE7, rounded to nearest,
+ *  NMEA_BADCOORD if the field is too long or over 180 degrees
+ *
+ *  Integer arithmetic only: the minutes are kept to seven decimals and
+ *  divided by 60 once, so the result is within half a unit, about 6 mm of
+ *  latitude, of the exact value of the text.
+ */
+int32_t nmea_coord(const char *s, size_t len, char hemi) {
+  int64_t v = nmea_fixed(s, len, 7);
+  if (v == NMEA_BADFIXED) {
+    return NMEA_BADCOORD;
+  }
+  int64_t deg = v / (100 * (int64_t)NMEA_DEGE7);
+  int64_t min = v - deg * (100 * (int64_t)NMEA_DEGE7);
+  int64_t c = deg * NMEA_DEGE7 + (min + 30) / 60;
+  if (c > 180 * (int64_t)NMEA_DEGE7 || c < -180 * (int64_t)NMEA_DEGE7) {
+    return NMEA_BADCOORD;
+  }
 
-  p = strchr(p, ',') + 1;
-  loc->altitude = atof(p);
+  return (hemi == 'S' || hemi == 'W') ? (int32_t)-c : (int32_t)c;
+}
+
+/** @brief Read the fields of a tokenized GPGGA sentence.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param tok sentence fields
+ *  @param loc output data structure
+ *  @return void
+ */
+void nmea_read_gpgga(const nmeatok_t *tok, gpgga_t *loc) {
+  char c;
+
+  loc->utc = fieldNumber(tok, 1);
+  loc->latitude = fieldNumber(tok, 2);
+  c = fieldChar(tok, 3);
+  loc->lat = (c == 'N' || c == 'S') ? c : '\0';
+  loc->longitude = fieldNumber(tok, 4);
+  c = fieldChar(tok, 5);
+  loc->lon = (c == 'E' || c == 'W') ? c : '\0';
+  loc->lat7 = fieldCoord(tok, 2);
+  loc->lon7 = fieldCoord(tok, 4);
+  loc->quality = (uint8_t)fieldNumber(tok, 6);
+  loc->satellites = (uint8_t)fieldNumber(tok, 7);
+  loc->altitude = fieldNumber(tok, 9);
+}
+
+/** @brief Read the fields of a tokenized GPRMC sentence.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param tok sentence fields
+ *  @param loc output data structure
+ *  @return void
+ */
+void nmea_read_gprmc(const nmeatok_t *tok, gprmc_t *loc) {
+  char c;
+
+  loc->utc = fieldNumber(tok, 1);
+  loc->latitude = fieldNumber(tok, 3);
+  c = fieldChar(tok, 4);
+  loc->lat = (c == 'N' || c == 'S') ? c : '\0';
+  loc->longitude = fieldNumber(tok, 5);
+  c = fieldChar(tok, 6);
+  loc->lon = (c == 'E' || c == 'W') ? c : '\0';
+  loc->lat7 = fieldCoord(tok, 3);
+  loc->lon7 = fieldCoord(tok, 5);
+  loc->speed = fieldNumber(tok, 7);
+  loc->course = fieldNumber(tok, 8);
+  loc->date = fieldNumber(tok, 9);
+}
+
+/** @brief Read the fields of a tokenized GLL sentence.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param tok sentence fields
+ *  @param loc output data structure
+ *  @return void
+ */
+void nmea_read_gpgll(const nmeatok_t *tok, gpgll_t *loc) {
+  char c;
+
+  loc->latitude = fieldNumber(tok, 1);
+  c = fieldChar(tok, 2);
+  loc->lat = (c == 'N' || c == 'S') ? c : '\0';
+  loc->longitude = fieldNumber(tok, 3);
+  c = fieldChar(tok, 4);
+  loc->lon = (c == 'E' || c == 'W') ? c : '\0';
+  loc->lat7 = fieldCoord(tok, 1);
+  loc->lon7 = fieldCoord(tok, 3);
+  loc->utc = fieldNumber(tok, 5);
+  loc->status = fieldChar(tok, 6);
+}
+
+/** @brief Read the fields of a tokenized VTG sentence.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param tok sentence fields
+ *  @param loc output data structure
+ *  @return void
+ */
+void nmea_read_gpvtg(const nmeatok_t *tok, gpvtg_t *loc) {
+  loc->course = fieldNumber(tok, 1);
+  loc->coursem = fieldNumber(tok, 3);
+  loc->knots = fieldNumber(tok, 5);
+  loc->kph = fieldNumber(tok, 7);
+  loc->mode = fieldChar(tok, 9);
+}
+
+/** @brief Read the fields of a tokenized GSA sentence.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param tok sentence fields
+ *  @param loc output data structure
+ *  @return void
+ *
+ *  Only the satellite slots that hold a PRN are kept in prn.
+ */
+void nmea_read_gpgsa(const nmeatok_t *tok, gpgsa_t *loc) {
+  loc->mode = fieldChar(tok, 1);
+  loc->fix = (uint8_t)fieldNumber(tok, 2);
+  loc->nprn = 0;
+  for (int i = 3; i < 3 + NMEA_GSAPRNS; i++) {
+    if (i < tok->nfields && tok->len[i] > 0) {
+      loc->prn[loc->nprn++] = (uint8_t)fieldNumber(tok, i);
+    }
+  }
+  loc->pdop = fieldNumber(tok, 15);
+  loc->hdop = fieldNumber(tok, 16);
+  loc->vdop = fieldNumber(tok, 17);
+}
+
+/** @brief Read the fields of a tokenized GSV sentence.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param tok sentence fields
+ *  @param loc output data structure
+ *  @return void
+ */
+void nmea_read_gpgsv(const nmeatok_t *tok, gpgsv_t *loc) {
+  loc->total = (uint8_t)fieldNumber(tok, 1);
+  loc->index = (uint8_t)fieldNumber(tok, 2);
+  loc->inview = (uint8_t)fieldNumber(tok, 3);
+  loc->nsat = 0;
+  for (int i = 4; i + 3 < tok->nfields && loc->nsat < NMEA_GSVSATS; i += 4) {
+    gpgsvsat_t *sv = &loc->sat[loc->nsat++];
+    sv->prn = (uint16_t)fieldNumber(tok, i);
+    sv->elevation = (int8_t)fieldNumber(tok, i + 1);
+    sv->azimuth = (uint16_t)fieldNumber(tok, i + 2);
+    sv->snr = (uint8_t)fieldNumber(tok, i + 3);
+  }
+}
+
+typedef struct nmeaparser {
+  uint8_t type;                                       ///< NMEA_* type
+  void (*read)(const nmeatok_t *, nmeasentence_t *); ///< Fills the union
+} nmeaparser_t;
+
+/** @brief Adapters from the registry to the typed readers.
+ */
+static void readGga(const nmeatok_t *t, nmeasentence_t *s) {
+  nmea_read_gpgga(t, &s->gga);
+}
+static void readRmc(const nmeatok_t *t, nmeasentence_t *s) {
+  nmea_read_gprmc(t, &s->rmc);
+}
+static void readGll(const nmeatok_t *t, nmeasentence_t *s) {
+  nmea_read_gpgll(t, &s->gll);
+}
+static void readVtg(const nmeatok_t *t, nmeasentence_t *s) {
+  nmea_read_gpvtg(t, &s->vtg);
+}
+static void readGsa(const nmeatok_t *t, nmeasentence_t *s) {
+  nmea_read_gpgsa(t, &s->gsa);
+}
+static void readGsv(const nmeatok_t *t, nmeasentence_t *s) {
+  nmea_read_gpgsv(t, &s->gsv);
+}
+
+/// Parser registry, indexed by the bit number of the sentence type
+static const nmeaparser_t parsers[NMEA_NTYPES] = {
+    {NMEA_RMC, readRmc}, {NMEA_GGA, readGga}, {NMEA_GLL, readGll},
+    {NMEA_VTG, readVtg}, {NMEA_GSA, readGsa}, {NMEA_GSV, readGsv},
+};
+
+/** @brief Parse a tokenized sentence into its typed struct.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param tok sentence fields from nmea_tokenize
+ *  @param out output sentence, the union member matching out->type is set
+ *  @return sentence type, NMEA_UNKNOWN or the tokenizer error if there is
+ *  no parser for it
+ */
+uint8_t nmea_read(const nmeatok_t *tok, nmeasentence_t *out) {
+  out->type = tok->type;
+  out->talker = tok->talker;
+  if (tok->type == NMEA_UNKNOWN || (tok->type & NMEA_CHECKSUM_ERR)) {
+    return tok->type;
+  }
+  parsers[__builtin_ctz(tok->type)].read(tok, out);
+  return out->type;
+}
+
+/** @brief Parses GPGGA Message
+ *  @author Paul Moggach
+ *  @date 25MAR2019
+ *  @param char * nmea Pointer to message
+ *  @param gpgg_t * loc Pointer to output data structure
+ */
+void nmea_parse_gpgga(char *nmea, gpgga_t *loc) {
+  nmeatok_t tok;
+
+  nmea_tokenize(nmea, strlen(nmea), &tok);
+  nmea_read_gpgga(&tok, loc);
 }
 
 /** @brief Parses GPRMC Message
@@ -71,48 +490,10 @@ void nmea_parse_gpgga(char *nmea, gpgga_t *loc) {
  *  @param gpgg_t * loc Pointer to output data structure
  */
 void nmea_parse_gprmc(char *nmea, gprmc_t *loc) {
-  char *p = nmea;
-
-  p = strchr(p, ',') + 1; // skip time
-  p = strchr(p, ',') + 1; // skip status
-  p = strchr(p, ',') + 1;
-  loc->latitude = atof(p);
-  p = strchr(p, ',') + 1;
-  switch (p[0]) {
-  case 'N':
-    loc->lat = 'N';
-    break;
-  case 'S':
-    loc->lat = 'S';
-    break;
-  case ',':
-    loc->lat = '\0';
-    break;
-  }
-
-  p = strchr(p, ',') + 1;
-  loc->longitude = atof(p);
-  p = strchr(p, ',') + 1;
-  switch (p[0]) {
-  case 'W':
-    loc->lon = 'W';
-    break;
-  case 'E':
-    loc->lon = 'E';
-    break;
-  case ',':
-    loc->lon = '\0';
-    break;
-  }
-
-  p = strchr(p, ',') + 1;
-  loc->speed = atof(p);
-
-  p = strchr(p, ',') + 1;
-  loc->course = atof(p);
-
-  p = strchr(p, ',') + 1;
-  loc->date = atof(p);
+  nmeatok_t tok;
+
+  nmea_tokenize(nmea, strlen(nmea), &tok);
+  nmea_read_gprmc(&tok, loc);
 }
 
 /** @brief Get the message type (GPGGA, GPRMC, etc..)
@@ -120,20 +501,9 @@ void nmea_parse_gprmc(char *nmea, gprmc_t *loc) {
  *  @return The type of message if it is valid
  */
 uint8_t nmea_get_message_type(const char *message) {
-  uint8_t checksum = 0;
-  if ((checksum = nmea_valid_checksum(message)) != _EMPTY) {
-    return checksum;
-  }
+  nmeatok_t tok;
 
-  if (strstr(message, NMEA_GPGGA_STR) != NULL) {
-    return NMEA_GPGGA;
-  }
-
-  if (strstr(message, NMEA_GPRMC_STR) != NULL) {
-    return NMEA_GPRMC;
-  }
-
-  return NMEA_UNKNOWN;
+  return nmea_tokenize(message, strlen(message), &tok);
 }
 
 /** @brief Checks Message Checksum
@@ -143,18 +513,8 @@ uint8_t nmea_get_message_type(const char *message) {
  *  @return uint8_t Checksum
  */
 uint8_t nmea_valid_checksum(const char *message) {
-  uint8_t checksum = (uint8_t)strtol(strchr(message, '*') + 1, NULL, 16);
-
-  char p;
-  uint8_t sum = 0;
-  ++message;
-  while ((p = *message++) != '*') {
-    sum ^= p;
-  }
-
-  if (sum != checksum) {
-    return NMEA_CHECKSUM_ERR;
-  }
+  nmeatok_t tok;
+  uint8_t type = nmea_tokenize(message, strlen(message), &tok);
 
-  return _EMPTY;
+  return (type & NMEA_CHECKSUM_ERR) ? type : _EMPTY;
 }
@@ -1,8 +1,18 @@
 /** @file nmea.h
  *  @brief Constants, structures, function prototypes for NMEA functions
+ *
+ *  nmea_tokenize checks the checksum, splits the fields and identifies the
+ *  sentence over a byte span without copying it, using the vectorized
+ *  kernels of nmeascan.h. The talker and sentence ID of the address field
+ *  are dispatched with a switch, so any talker (GP, GN, GL, ...) is
+ *  recognised in constant time, and nmea_read then fills the typed struct
+ *  of the sentence from a registry of parsers. Numbers are converted with
+ *  integer fixed-point arithmetic, not atof, and coordinates go straight
+ *  from ddmm.mmmm text to signed 1e-7 degree integers.
  */
 #ifndef NMEA_H
 #define NMEA_H
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -15,9 +25,36 @@
 #define NMEA_UNKNOWN 0x00
 #define _COMPLETED 0x03
 
+// Sentence types, one bit each, whatever the talker
+#define NMEA_RMC NMEA_GPRMC
+#define NMEA_GGA NMEA_GPGGA
+#define NMEA_GLL 0x04
+#define NMEA_VTG 0x08
+#define NMEA_GSA 0x10
+#define NMEA_GSV 0x20
+#define NMEA_NTYPES 6 ///< Sentence types with a parser
+
+// Talkers
+#define NMEA_TALKER_NONE 0
+#define NMEA_TALKER_GP 1 ///< GPS
+#define NMEA_TALKER_GL 2 ///< GLONASS
+#define NMEA_TALKER_GA 3 ///< Galileo
+#define NMEA_TALKER_GB 4 ///< BeiDou, also sent as BD
+#define NMEA_TALKER_GQ 5 ///< QZSS
+#define NMEA_TALKER_GN 6 ///< Combined solution of several systems
+#define NMEA_TALKERS 7
+
 #define NMEA_CHECKSUM_ERR 0x80
 #define NMEA_MESSAGE_ERR 0xC0
 #define NMEAMSGSZ 82
+#define NMEA_MAXFIELDS 24
+#define NMEA_GSAPRNS 12 ///< Satellite slots of a GSA sentence
+#define NMEA_GSVSATS 4  ///< Satellites described by one GSV sentence
+#define NMEA_DEGE7 10000000 ///< Coordinate units per degree
+#define NMEA_FIXEDMAX 100000000000000000LL ///< Bound of nmea_fixed values
+#define NMEA_BADFIXED INT64_MIN ///< nmea_fixed of a field past the bound
+#define NMEA_BADCOORD INT32_MIN ///< nmea_coord of an unusable coordinate
+#define NMEA_KPHKNOT 1.852  ///< km/h per knot
 
 typedef struct gpgga {
   double utc;      ///< UTC Time
@@ -26,6 +63,8 @@ typedef struct gpgga {
   double
       longitude;   ///< Longitude eg: 08151.6838 (XXXYY.ZZKK.. DEG, MIN, SEC.SS)
   char lon;        ///< Longitude eg: W
+  int32_t lat7;    ///< Signed latitude, 1e-7 degrees
+  int32_t lon7;    ///< Signed longitude, 1e-7 degrees
   uint8_t quality; ///< Quality 0, 1, 2
   uint8_t satellites; ///< Number of satellites: 1,2,3,4,5...
   double altitude;    ///< Altitude eg: 280.2 (Meters above mean sea level)
@@ -38,20 +77,100 @@ typedef struct gprmc {
   double
       longitude; ///< Longitude eg: 08151.6838 (XXXYY.ZZKK.. DEG, MIN, SEC.SS)
   char lon;      ///< Longitude eg: W
+  int32_t lat7;  ///< Signed latitude, 1e-7 degrees
+  int32_t lon7;  ///< Signed longitude, 1e-7 degrees
   double speed;  ///< Speed
   double course; ///< Direction
   double date;   ///< Date
 } gprmc_t;
 
+typedef struct gpgll {
+  double latitude;  ///< Latitude eg: 4124.8963 (XXYY.ZZKK.. DEG, MIN, SEC.SS)
+  char lat;         ///< Latitude eg: N
+  double longitude; ///< Longitude eg: 08151.6838 (XXXYY.ZZKK..)
+  char lon;         ///< Longitude eg: W
+  int32_t lat7;     ///< Signed latitude, 1e-7 degrees
+  int32_t lon7;     ///< Signed longitude, 1e-7 degrees
+  double utc;       ///< UTC Time
+  char status;      ///< A valid, V invalid
+} gpgll_t;
+
+typedef struct gpvtg {
+  double course;  ///< Course over ground, degrees true
+  double coursem; ///< Course over ground, degrees magnetic
+  double knots;   ///< Speed over ground, knots
+  double kph;     ///< Speed over ground, km/h
+  char mode;      ///< A autonomous, D differential, N not valid, ...
+} gpvtg_t;
+
+typedef struct gpgsa {
+  char mode;                     ///< M manual, A automatic 2D/3D
+  uint8_t fix;                   ///< 1 none, 2 2D, 3 3D
+  uint8_t nprn;                  ///< Satellites used, entries of prn
+  uint8_t prn[NMEA_GSAPRNS];     ///< PRNs of the satellites used
+  double pdop;                   ///< Position dilution of precision
+  double hdop;                   ///< Horizontal dilution of precision
+  double vdop;                   ///< Vertical dilution of precision
+} gpgsa_t;
+
+typedef struct gpgsvsat {
+  uint16_t prn;      ///< Satellite PRN
+  int8_t elevation;  ///< Degrees
+  uint16_t azimuth;  ///< Degrees true
+  uint8_t snr;       ///< dB-Hz, 0 when not tracked
+} gpgsvsat_t;
+
+typedef struct gpgsv {
+  uint8_t total;                  ///< Sentences in this GSV group
+  uint8_t index;                  ///< Number of this sentence, from 1
+  uint8_t inview;                 ///< Satellites in view
+  uint8_t nsat;                   ///< Entries used in sat
+  gpgsvsat_t sat[NMEA_GSVSATS];   ///< Satellites of this sentence
+} gpgsv_t;
+
+/// Any parsed sentence, tagged with its type and talker
+typedef struct nmeasentence {
+  uint8_t type;   ///< NMEA_* sentence type
+  uint8_t talker; ///< NMEA_TALKER_*
+  union {
+    gpgga_t gga;
+    gprmc_t rmc;
+    gpgll_t gll;
+    gpvtg_t vtg;
+    gpgsa_t gsa;
+    gpgsv_t gsv;
+  };
+} nmeasentence_t;
+
 typedef struct nmeamsg {
   char msgstr[NMEAMSGSZ + 1];
 } nmeamsg_s;
 
+/// Fields of one sentence, pointing into the caller's buffer
+typedef struct nmeatok {
+  uint8_t type;                       ///< NMEA_* type or error
+  uint8_t talker;                     ///< NMEA_TALKER_* of the address
+  uint8_t nfields;                    ///< Fields found, the address is 0
+  const char *field[NMEA_MAXFIELDS];  ///< Start of each field
+  uint16_t len[NMEA_MAXFIELDS];       ///< Length of each field
+} nmeatok_t;
+
 ///\cond INTERNAL
 // Function Prototypes
 uint8_t nmea_get_message_type(const char *);
 uint8_t nmea_valid_checksum(const char *);
 void nmea_parse_gpgga(char *, gpgga_t *);
 void nmea_parse_gprmc(char *, gprmc_t *);
+uint8_t nmea_tokenize(const char *, size_t, nmeatok_t *);
+int64_t nmea_fixed(const char *, size_t, int);
+double nmea_number(const char *, size_t);
+int32_t nmea_coord(const char *, size_t, char);
+void nmea_read_gpgga(const nmeatok_t *, gpgga_t *);
+void nmea_read_gprmc(const nmeatok_t *, gprmc_t *);
+void nmea_read_gpgll(const nmeatok_t *, gpgll_t *);
+void nmea_read_gpvtg(const nmeatok_t *, gpvtg_t *);
+void nmea_read_gpgsa(const nmeatok_t *, gpgsa_t *);
+void nmea_read_gpgsv(const nmeatok_t *, gpgsv_t *);
+uint8_t nmea_read(const nmeatok_t *, nmeasentence_t *);
 ///\endcond
 #endif
@@ -0,0 +1,301 @@
+/** @file nmeascan.cpp
+ *  @brief NMEA scanning kernels
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ */
+#include "nmeascan.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NMEA_X86 1
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NMEA_NEON 1
+#endif
+
+/** @brief Class masks of one byte, shared by every kernel for the tail.
+ */
+static void classifyByte(char c, int i, nmeamask_t *m) {
+  uint64_t bit = (uint64_t)1 << i;
+  if (c == '$') {
+    m->dollar |= bit;
+  } else if (c == ',') {
+    m->comma |= bit;
+  } else if (c == '*' || c == '\r' || c == '\n' || c == '\0') {
+    m->stop |= bit;
+  }
+}
+
+static void scalarClassify(const char *p, size_t len, nmeamask_t *m) {
+  m->dollar = m->comma = m->stop = 0;
+  for (size_t i = 0; i < len; i++) {
+    classifyByte(p[i], (int)i, m);
+  }
+}
+
+static uint8_t scalarChecksum(const char *p, size_t len) {
+  uint8_t sum = 0;
+  for (size_t i = 0; i < len; i++) {
+    sum ^= (uint8_t)p[i];
+  }
+  return sum;
+}
+
+#if NMEA_X86
+/** @brief Masks of 16 bytes with SSE2.
+ */
+static inline void sse2Block(__m128i v, int shift, nmeamask_t *m) {
+  __m128i stop = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('*')),
+                   _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+      _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')),
+                   _mm_cmpeq_epi8(v, _mm_setzero_si128())));
+  m->dollar |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                   _mm_cmpeq_epi8(v, _mm_set1_epi8('$')))
+               << shift;
+  m->comma |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                  _mm_cmpeq_epi8(v, _mm_set1_epi8(',')))
+              << shift;
+  m->stop |= (uint64_t)(uint16_t)_mm_movemask_epi8(stop) << shift;
+}
+
+static void sse2Classify(const char *p, size_t len, nmeamask_t *m) {
+  size_t i = 0;
+
+  m->dollar = m->comma = m->stop = 0;
+  for (; i + 16 <= len; i += 16) {
+    sse2Block(_mm_loadu_si128((const __m128i *)(p + i)), (int)i, m);
+  }
+  for (; i < len; i++) {
+    classifyByte(p[i], (int)i, m);
+  }
+}
+
+static uint8_t sse2Checksum(const char *p, size_t len) {
+  __m128i acc = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    acc = _mm_xor_si128(acc, _mm_loadu_si128((const __m128i *)(p + i)));
+  }
+  acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+  acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 4));
+  acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 2));
+  acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 1));
+  uint8_t sum = (uint8_t)_mm_cvtsi128_si32(acc);
+  for (; i < len; i++) {
+    sum ^= (uint8_t)p[i];
+  }
+  return sum;
+}
+
+/** @brief Masks of 32 bytes with AVX2.
+ */
+__attribute__((target("avx2"))) static inline void
+avx2Block(__m256i v, int shift, nmeamask_t *m) {
+  __m256i stop = _mm256_or_si256(
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('*')),
+                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))),
+      _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')),
+                      _mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+  m->dollar |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                   _mm256_cmpeq_epi8(v, _mm256_set1_epi8('$')))
+               << shift;
+  m->comma |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')))
+              << shift;
+  m->stop |= (uint64_t)(uint32_t)_mm256_movemask_epi8(stop) << shift;
+}
+
+__attribute__((target("avx2"))) static void
+avx2Classify(const char *p, size_t len, nmeamask_t *m) {
+  size_t i = 0;
+
+  m->dollar = m->comma = m->stop = 0;
+  for (; i + 32 <= len; i += 32) {
+    avx2Block(_mm256_loadu_si256((const __m256i *)(p + i)), (int)i, m);
+  }
+  for (; i < len; i++) {
+    classifyByte(p[i], (int)i, m);
+  }
+}
+
+__attribute__((target("avx2"))) static uint8_t avx2Checksum(const char *p,
+                                                             size_t len) {
+  __m256i acc = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 32 <= len; i += 32) {
+    acc = _mm256_xor_si256(acc, _mm256_loadu_si256((const __m256i *)(p + i)));
+  }
+  __m128i x = _mm_xor_si128(_mm256_castsi256_si128(acc),
+                            _mm256_extracti128_si256(acc, 1));
+  x = _mm_xor_si128(x, _mm_srli_si128(x, 8));
+  x = _mm_xor_si128(x, _mm_srli_si128(x, 4));
+  x = _mm_xor_si128(x, _mm_srli_si128(x, 2));
+  x = _mm_xor_si128(x, _mm_srli_si128(x, 1));
+  uint8_t sum = (uint8_t)_mm_cvtsi128_si32(x);
+  for (; i < len; i++) {
+    sum ^= (uint8_t)p[i];
+  }
+  return sum;
+}
+#endif
+
+#if NMEA_NEON
+/** @brief Bitmask of the lanes set in a NEON compare result.
+ */
+static inline uint16_t neonMovemask(uint8x16_t v) {
+  static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                      1, 2, 4, 8, 16, 32, 64, 128};
+  uint8x16_t m = vandq_u8(v, vld1q_u8(weights));
+  uint8x8_t lo = vget_low_u8(m);
+  uint8x8_t hi = vget_high_u8(m);
+  lo = vpadd_u8(lo, lo);
+  hi = vpadd_u8(hi, hi);
+  lo = vpadd_u8(lo, lo);
+  hi = vpadd_u8(hi, hi);
+  lo = vpadd_u8(lo, lo);
+  hi = vpadd_u8(hi, hi);
+  return (uint16_t)(vget_lane_u8(lo, 0) | (vget_lane_u8(hi, 0) << 8));
+}
+
+static void neonClassify(const char *p, size_t len, nmeamask_t *m) {
+  size_t i = 0;
+
+  m->dollar = m->comma = m->stop = 0;
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t v = vld1q_u8((const uint8_t *)p + i);
+    uint8x16_t stop = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('*')),
+                                        vceqq_u8(v, vdupq_n_u8('\n'))),
+                               vorrq_u8(vceqq_u8(v, vdupq_n_u8('\r')),
+                                        vceqq_u8(v, vdupq_n_u8(0))));
+    m->dollar |= (uint64_t)neonMovemask(vceqq_u8(v, vdupq_n_u8('$'))) << i;
+    m->comma |= (uint64_t)neonMovemask(vceqq_u8(v, vdupq_n_u8(','))) << i;
+    m->stop |= (uint64_t)neonMovemask(stop) << i;
+  }
+  for (; i < len; i++) {
+    classifyByte(p[i], (int)i, m);
+  }
+}
+
+static uint8_t neonChecksum(const char *p, size_t len) {
+  uint8x16_t acc = vdupq_n_u8(0);
+  size_t i = 0;
+
+  for (; i + 16 <= len; i += 16) {
+    acc = veorq_u8(acc, vld1q_u8((const uint8_t *)p + i));
+  }
+  uint8x8_t x = veor_u8(vget_low_u8(acc), vget_high_u8(acc));
+  uint64_t w = vget_lane_u64(vreinterpret_u64_u8(x), 0);
+  w ^= w >> 32;
+  w ^= w >> 16;
+  w ^= w >> 8;
+  uint8_t sum = (uint8_t)w;
+  for (; i < len; i++) {
+    sum ^= (uint8_t)p[i];
+  }
+  return sum;
+}
+#endif
+
+static const nmeakernel_t kernels[] = {
+#if NMEA_X86
+    {"avx2", avx2Classify, avx2Checksum},
+    {"sse2", sse2Classify, sse2Checksum},
+#endif
+#if NMEA_NEON
+    {"neon", neonClassify, neonChecksum},
+#endif
+    {"scalar", scalarClassify, scalarChecksum},
+};
+
+/** @brief Check whether the CPU can run a kernel.
+ */
+static bool supported(const nmeakernel_t *k) {
+#if NMEA_X86
+  if (k->classify == avx2Classify) {
+    return __builtin_cpu_supports("avx2");
+  }
+#if !defined(__SSE2__)
+  if (k->classify == sse2Classify) {
+    return __builtin_cpu_supports("sse2");
+  }
+#endif
+#endif
+  (void)k;
+  return true;
+}
+
+/** @brief First kernel the CPU can run; scalar always can.
+ */
+static const nmeakernel_t *pick(void) {
+  const nmeakernel_t *k = kernels;
+
+  while (!supported(k)) {
+    k++;
+  }
+  return k;
+}
+
+/** @brief Best scanning kernel for this CPU.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @return kernel, never NULL
+ *
+ *  Safe to call from any thread; the kernel is picked once, on first use.
+ */
+const nmeakernel_t *nmea_scan_kernel(void) {
+  static const nmeakernel_t *const best = pick();
+  return best;
+}
+
+/** @brief Every kernel this CPU can run, best first.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param out output kernels
+ *  @param max capacity of out
+ *  @return number of kernels
+ */
+size_t nmea_scan_kernels(const nmeakernel_t **out, size_t max) {
+  size_t n = 0;
+
+  for (const nmeakernel_t &k : kernels) {
+    if (n < max && supported(&k)) {
+      out[n++] = &k;
+    }
+  }
+  return n;
+}
+
+/** @brief Classify a buffer with the best kernel.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param buf bytes to classify
+ *  @param len length of buf
+ *  @param masks output, one per NMEA_SCANBLOCK bytes
+ *  @return number of masks written
+ */
+size_t nmea_classify(const char *buf, size_t len, nmeamask_t *masks) {
+  const nmeakernel_t *k = nmea_scan_kernel();
+  size_t n = 0;
+
+  for (size_t off = 0; off < len; off += NMEA_SCANBLOCK) {
+    size_t chunk = (len - off < NMEA_SCANBLOCK) ? len - off : NMEA_SCANBLOCK;
+    k->classify(buf + off, chunk, &masks[n++]);
+  }
+  return n;
+}
+
+/** @brief XOR checksum of a span with the best kernel.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param buf bytes between '$' and '*'
+ *  @param len length of buf
+ *  @return checksum
+ */
+uint8_t nmea_checksum(const char *buf, size_t len) {
+  return nmea_scan_kernel()->checksum(buf, len);
+}
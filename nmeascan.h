@@ -0,0 +1,37 @@
+/** @file nmeascan.h
+ *  @brief Vectorized NMEA checksum and delimiter scanning kernels
+ *
+ *  A kernel classifies 64 bytes at a time into bitmasks of sentence starts,
+ *  field commas and sentence stops, and XORs a span of bytes for the
+ *  checksum. SSE2 and AVX2 kernels are built on x86, a NEON kernel on ARM,
+ *  and a scalar kernel everywhere; nmea_scan_kernel picks the best one the
+ *  CPU supports.
+ */
+#ifndef NMEASCAN_H
+#define NMEASCAN_H
+#include <cstddef>
+#include <cstdint>
+
+#define NMEA_SCANBLOCK 64 ///< Bytes covered by one nmeamask_t
+
+/// Bit i of each mask is set when byte i of the block is of that class
+typedef struct nmeamask {
+  uint64_t dollar; ///< '$'
+  uint64_t comma;  ///< ','
+  uint64_t stop;   ///< '*', '\r', '\n' or NUL
+} nmeamask_t;
+
+typedef struct nmeakernel {
+  const char *name;                                    ///< For reports
+  void (*classify)(const char *, size_t, nmeamask_t *); ///< Up to 64 bytes
+  uint8_t (*checksum)(const char *, size_t);           ///< XOR of a span
+} nmeakernel_t;
+
+///\cond INTERNAL
+// Function Prototypes
+const nmeakernel_t *nmea_scan_kernel(void);
+size_t nmea_scan_kernels(const nmeakernel_t **, size_t);
+size_t nmea_classify(const char *, size_t, nmeamask_t *);
+uint8_t nmea_checksum(const char *, size_t);
+///\endcond
+#endif
@@ -15,6 +15,7 @@
  * readable. Made changes to conform with Allman style.
  */
 #include "sensehat.h"
+#include "dlled.h"
 #include "font.h"
 #include <fcntl.h>
 #include <iostream>
@@ -169,6 +170,7 @@ SenseHat::SenseHat(void) {
   InitializeJoystick();
   InitializeHumidity();
   InitializePressure();
+  thermal = open(THERMAL_ZONE, O_RDONLY | O_CLOEXEC);
   buffer = " ";
   color = BLUE;
   rotation = 0;
@@ -178,7 +180,12 @@ SenseHat::SenseHat(void) {
  * @brief SenseHat::~SenseHat
  * @details Destructeur de la classe
  */
-SenseHat::~SenseHat(void) { delete settings; }
+SenseHat::~SenseHat(void) {
+  if (thermal >= 0) {
+    close(thermal);
+  }
+  delete settings;
+}
 
 /**
  * @brief SenseHat::operator<<
@@ -257,26 +264,40 @@ uint16_t SenseHat::GetPixel(int row, int column) {
  *          en tenant compte de l'angle de rotation
  */
 void SenseHat::ViewPattern(uint16_t pattern[][8]) {
+  struct fb_t image;
+
+  // composé hors écran puis copié d'un coup, sans image à moitié affichée
   for (int row = 0; row < 8; row++) {
     for (int column = 0; column < 8; column++) {
       switch (this->rotation) {
       case 90:
       case -270:
-        fb->pixel[7 - column][row] = pattern[row][column];
+        image.pixel[7 - column][row] = pattern[row][column];
         break;
       case 180:
       case -180:
-        fb->pixel[7 - row][7 - column] = pattern[row][column];
+        image.pixel[7 - row][7 - column] = pattern[row][column];
         break;
       case 270:
       case -90:
-        fb->pixel[column][7 - row] = pattern[row][column];
+        image.pixel[column][7 - row] = pattern[row][column];
         break;
       default:
-        fb->pixel[row][column] = pattern[row][column];
+        image.pixel[row][column] = pattern[row][column];
       }
     }
   }
+  memcpy(fb, &image, sizeof(image));
+}
+
+/**
+ * @brief SenseHat::ViewFrame
+ * @param frame 8*8 uint16_t, [row][column]
+ * @details Copies a whole frame to the framebuffer at once, without
+ *          rotation
+ */
+void SenseHat::ViewFrame(const uint16_t frame[][8]) {
+  memcpy(fb, frame, sizeof(struct fb_t));
 }
 
 /**
@@ -319,7 +340,22 @@ void SenseHat::RotatePattern(int angle) {
  * @details Affiche la color sur l'ensemble de l'afficheur à leds
  *          une color Noir éteind l'écran
  */
-void SenseHat::WipeScreen(uint16_t color) { memset(fb, color, 128); }
+/**
+ * @brief SenseHat::WipeScreen
+ * @param uint16_t couleur RGB565 de toutes les leds
+ * @details memset ne convient qu'aux couleurs dont les deux octets sont
+ * égaux, chaque pixel est donc écrit
+ */
+void SenseHat::WipeScreen(uint16_t color) {
+  uint16_t frame[8][8];
+
+  for (int i = 0; i < 8; i++) {
+    for (int j = 0; j < 8; j++) {
+      frame[i][j] = color;
+    }
+  }
+  memcpy(fb, frame, sizeof(frame));
+}
 
 /**
  * @brief SenseHat::ScannerJoystick
@@ -423,22 +459,33 @@ float SenseHat::getRawTemperature(void) {
 
 /**
  * @brief SenseHat::getCoreTemperature
- * @return float la valeur de la température exprimée en °C,
+ * @return float la valeur de la température exprimée en °C, NaN si la zone
+ * thermique ne peut être lue
+ * @detail la zone thermique reste ouverte et se relit depuis le début avec
+ * pread, la valeur entière en millièmes de degré est convertie sans stdio
  */
 float SenseHat::getCpuTemperature(void) {
-  FILE *temperatureFile;
-  double T;
-
-  temperatureFile = fopen("/sys/class/thermal/thermal_zone0/temp", "r");
-  if (temperatureFile == NULL) {
-    //      printf ("Error getting Core Temperature!")  ; //print some message
-    return (0);
+  char buf[16];
+  ssize_t len;
+  ssize_t i = 0;
+  long milli = 0;
+  bool negative = false;
+
+  len = (thermal >= 0) ? pread(thermal, buf, sizeof(buf), 0) : -1;
+  if (len <= 0) {
+    return nan("");
+  }
+  if (buf[0] == '-') {
+    negative = true;
+    i++;
   }
-  fscanf(temperatureFile, "%lf", &T);
-  T /= 1000;
-  //    printf ("The temperature is %6.3f C.\n", T);
-  fclose(temperatureFile);
-  return (T);
+  if (i == len || buf[i] < '0' || buf[i] > '9') {
+    return nan("");
+  }
+  for (; i < len && buf[i] >= '0' && buf[i] <= '9'; i++) {
+    milli = milli * 10 + (buf[i] - '0');
+  }
+  return (negative ? -milli : milli) / 1000.0f;
 }
 
 /**
@@ -475,6 +522,31 @@ float SenseHat::GetHumidity(void) {
   return humidi;
 }
 
+/**
+ * @brief SenseHat::GetEnvironment
+ * @param data reçoit pression, température et humidité d'un même cycle
+ * @return int le nombre de lectures de capteur effectuées
+ * @detail une seule lecture du HTS221 puis une seule du LPS25H; le LPS25H
+ * est lu en dernier pour que la température soit la sienne, comme pour
+ * getRawTemperature
+ */
+int SenseHat::GetEnvironment(RTIMU_DATA &data) {
+  int reads = 0;
+
+  data.humidityValid = false;
+  data.pressureValid = false;
+  data.temperatureValid = false;
+  if (humidity->humidityRead(data)) {
+    reads++;
+  }
+  if (pressure->pressureRead(data)) {
+    reads++;
+  } else {
+    data.temperatureValid = false;
+  }
+  return reads;
+}
+
 /**
  * @brief SenseHat::ObtenirOrientation
  * @return float la valeur de l'accélération angulaire suivant pitch roll et yaw
@@ -522,6 +594,41 @@ void SenseHat::GetMagnetism(float &x, float &y, float &z) {
   }
 }
 
+/**
+ * @brief SenseHat::GetImuData
+ * @param data RTIMU_DATA receiving the newest sample
+ * @return true if the IMU produced at least one sample
+ * @detail drains the IMU FIFO once, so accel, gyro and compass all come
+ * from the same instant
+ */
+bool SenseHat::GetImuData(RTIMU_DATA &data) {
+  bool got = false;
+
+  while (imu->IMURead()) {
+    data = imu->getIMUData();
+    got = true;
+  }
+  return got;
+}
+
+/**
+ * @brief SenseHat::GetImuBatch
+ * @param batch array receiving the samples, oldest first
+ * @param max capacity of batch
+ * @return number of samples read
+ * @detail drains the IMU FIFO once and keeps every sample, each with all
+ * nine axes, the fusion pose and its timestamp. Samples beyond max stay in
+ * the FIFO for the next call.
+ */
+int SenseHat::GetImuBatch(RTIMU_DATA *batch, int max) {
+  int n = 0;
+
+  while (n < max && imu->IMURead()) {
+    batch[n++] = imu->getIMUData();
+  }
+  return n;
+}
+
 /**
  * @brief SenseHat::ObtenirMagnetismeSpherique
  * @return la valeur du vecteur champ magnétique en coordonnées sphérique
@@ -644,143 +751,35 @@ void SenseHat::InitializeAcceleration(void) { imu->setAccelEnable(true); }
 /**
  * @brief  SenseHat::ConvertirCaractereEnpattern
  * @detail Converti un caractère en pattern affichable sur la matrice de leds
+ * à partir de l'atlas des glyphes (cf font.h), un caractère inexistant
+ * donne le glyphe inconnu
  * - Fait par Grilo Christophe
  */
 void SenseHat::ConvertCharacterToPattern(char c, uint16_t image[8][8],
                                          uint16_t colorText,
                                          uint16_t colorBackground) {
-  int i = 0;
-  int j, k;
-  int tailleTableDeConvertion = sizeof(font) / sizeof(Tfont);
-
-  // Recherche si le caractere existe dans la table de convertion (cf font.h)
-  while (c != font[i].caractere && i < tailleTableDeConvertion)
-    i++;
-
-  // Si le caractere est dans la table on le converti
-  if (i < tailleTableDeConvertion) {
-    for (j = 0; j < 8; j++) {
-      for (k = 0; k < 8; k++) {
-        if (font[i].binarypattern[j][k]) {
-          image[j][k] = colorText;
-        } else {
-          image[j][k] = colorBackground;
-        }
-      }
-    }
-  } else // caractère inexistant on le remplace par un glyphe inconnu
-         //	ConvertirCaractereEnpattern(255,image,colorText,colorBackground);
-  {
-    ConvertCharacterToPattern(255, image, colorText, colorBackground);
-  }
-}
-
-bool SenseHat::EmptyColumn(int numcolumn, uint16_t image[8][8],
-                           uint16_t colorBackground) {
-  int i = 0;
+  const uint8_t *columns = atlas.columns[(uint8_t)c];
 
-  for (i = 0; i < 8; i++) {
-    if (image[i][numcolumn] != colorBackground) {
-      return false;
-    }
-  }
-  return true;
-}
-
-void SenseHat::ImageContainment(int numcolumn, uint16_t image[][8][8],
-                                int taille) {
-  int i = 0, j = 0, k = 0, l = 0, isuivant, ksuivant;
-  int nombredecolumns = taille * 8; // 8 columns par pattern
-
-  for (l = numcolumn; l < nombredecolumns - 1; l++) {
-    i = l / 8;
-    k = l % 8;
-    isuivant = (l + 1) / 8;
-    ksuivant = (l + 1) % 8;
-    for (j = 0; j < 8; j++) {
-      image[i][j][k] = image[isuivant][j][ksuivant];
+  for (int j = 0; j < 8; j++) {
+    for (int k = 0; k < 8; k++) {
+      image[j][k] = (columns[k] >> j & 1) ? colorText : colorBackground;
     }
   }
 }
 
+/**
+ * @brief SenseHat::AfficherMessage
+ * @param message texte à faire défiler
+ * @param vitesseDefilement ms entre deux colonnes
+ * @details Le message est rendu une seule fois en une bande de colonnes
+ * tassées et confié au thread de rendu des leds (cf dlled.h), seul à
+ * écrire sur la matrice; il défile dans l'ordre où il a été donné et la
+ * méthode retourne aussitôt. Le message est perdu si DLLED_TEXTQ messages
+ * attendent déjà.
+ */
 void SenseHat::ViewMessage(const std::string message, int vitesseDefilement,
                            uint16_t colorText, uint16_t colorBackground) {
-  int taille = message.length();
-  uint16_t chaine[taille][8]
-                 [8]; /* Le tableau de pattern (image/caractère) à afficher */
-  int i = 0, j = 0, k = 0, l = 0, nombreDecolumnVide = 0;
-  int isuivant = 0, ksuivant = 0, nombreDecolumns = 0;
-
-  /* Convertion de tout le message en tableau de patterns
-   * format caractère : 1 column vide + 5 columns réellement utilisées
-   * + 2 columns vides */
-  for (i = 0, j = 0; i < taille; i++, j++) {
-    if (message[i] == 195) // les lettres accentuées sont codées sur deux octets
-                           // (195 167 pour ç)
-    {
-      i++;
-      k++;
-    }
-    // row suivante à décommenter pour obtenir le code des caractères UTF8
-    // std::cout << "code : " << (int)message[i] << std::endl;
-    //	ConvertirCaractereEnpattern(message[i],chaine[j],colorText,colorBackground);
-    ConvertCharacterToPattern(message[i], chaine[j], colorText,
-                              colorBackground);
-  }
-  taille = taille - k;
-  nombreDecolumns = (taille)*8 - 2;
-  k = 0;
-  // Parcours de toutes les columns de tous les patterns qui compose
-  // la chaine de caractères à afficher pour supprimer les columns vides sauf
-  // celle qui sépare les patterns (caractères). + gestion du caractère espace.
-  for (l = 0; l < nombreDecolumns; l++) {
-    i = l / 8;
-    k = l % 8;
-
-    //		if(columnVide(k,chaine[i],colorBackground)) // Une column Vide
-    // avant chaque caractère à ne pas supprimer
-    if (EmptyColumn(k, chaine[i],
-                    colorBackground)) // Une column Vide avant chaque caractère
-                                      // à ne pas supprimer
-
-    {
-      isuivant = (++l) / 8;
-      ksuivant = (l) % 8;
-      nombreDecolumnVide = 1;
-
-      // compter les columns vide après la première afin de les supprimer
-      // si plus de 4 c'est le caractère espace que l'on doit garder
-      //			while(columnVide(ksuivant,chaine[isuivant],colorBackground)
-      //&& nombreDecolumnVide++ < 6)
-      while (EmptyColumn(ksuivant, chaine[isuivant], colorBackground) &&
-             nombreDecolumnVide++ < 6) {
-        //				TassementDeLimage(l,chaine,taille);
-        ImageContainment(l, chaine, taille);
-        nombreDecolumns--;
-      }
-    }
-  }
-
-  // Parcours de toutes les columns de tous les patterns qui composent
-  // la chaine de caractères à afficher (sans les columns vides superflues).
-  for (l = 0; l < nombreDecolumns; l++) {
-    // Decalage des columns vers la gauche sur l'image Numero 0 (celle qu'on
-    // affiche sur la matrice de LED
-    for (i = 0; i < taille; i++) {
-      // Cas Normal, les columns sont sur le même pattern
-      for (j = 0; j < 8; j++) {
-        for (k = 0; k < 7; k++)
-          chaine[i][j][k] = chaine[i][j][k + 1];
-      }
-      // Cas où l'on doit changer de pattern
-      for (j = 0; j < 8; j++) {
-        chaine[i][j][7] = chaine[i + 1][j][0];
-      }
-    }
-    usleep(1000 * vitesseDefilement);
-    //		Afficherpattern(chaine[0]);
-    ViewPattern(chaine[0]);
-  }
+  DlLedText(message.c_str(), vitesseDefilement, colorText, colorBackground);
 }
 
 SenseHat &SenseHat::operator<<(const std::string &message) {
@@ -40,6 +40,7 @@
 #define FB_DEV_NAME "fb"
 #define DEV_INPUT_EVENT "/dev/input"
 #define EVENT_DEV_NAME "event"
+#define THERMAL_ZONE "/sys/class/thermal/thermal_zone0/temp"
 
 #define COLOR_SENSEHAT uint16_t
 #define PI 3.14159265
@@ -80,6 +81,7 @@ public:
   void LightPixel(int row, int column, uint16_t color);
   uint16_t GetPixel(int row, int column);
   void ViewPattern(uint16_t pattern[][8]);
+  void ViewFrame(const uint16_t frame[][8]);
   void RotatePattern(int rotation);
   char ScannerJoystick(void);
   char ScanJoystick(void);
@@ -93,9 +95,12 @@ public:
   float getCpuTemperature(void);
   float GetPressure(void);
   float GetHumidity(void);
+  int GetEnvironment(RTIMU_DATA &data);
   void GetOrientation(float &pitch, float &roll, float &yaw);
   void GetAcceleration(float &x, float &y, float &z);
   void GetMagnetism(float &x, float &y, float &z);
+  bool GetImuData(RTIMU_DATA &data);
+  int GetImuBatch(RTIMU_DATA *batch, int max);
   void GetSphericalMagnetism(float &ro, float &teta, float &delta);
   void Version(void);
   void Flush(void);
@@ -111,9 +116,6 @@ private:
   void InitializeAcceleration(void);
   void ConvertCharacterToPattern(char c, uint16_t image[8][8],
                                  uint16_t colorText, uint16_t colorBackground);
-  bool EmptyColumn(int numcolumn, uint16_t image[8][8],
-                   uint16_t colorBackground);
-  void ImageContainment(int numcolumn, uint16_t image[][8][8], int taille);
 
   struct fb_t *fb;
   int joystick;
@@ -121,6 +123,7 @@ private:
   RTIMU *imu;
   RTPressure *pressure;
   RTHumidity *humidity;
+  int thermal;
   std::string buffer;
   uint16_t color;
   int rotation;
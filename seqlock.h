@@ -0,0 +1,52 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+/** @file seqlock.h
+ *  @brief Single-writer latest-value slot protected by a sequence lock.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  The writer never waits. Readers copy the value and retry if a write
+ *  overlapped the copy, so they always get a complete snapshot. T must be
+ *  trivially copyable.
+ */
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <typename T> class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock needs a trivially copyable type");
+
+public:
+  SeqLock(void) : seq(0) { memset(&value, 0, sizeof(value)); }
+
+  /** @brief Publish a new value (single writer).
+   */
+  void Store(const T &v) {
+    uint32_t s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&value, &v, sizeof(T));
+    seq.store(s + 2, std::memory_order_release);
+  }
+
+  /** @brief Copy out the latest complete value.
+   *  @return sequence number of the copied value, 0 if nothing was stored
+   */
+  uint32_t Load(T &v) const {
+    uint32_t s1, s2;
+    do {
+      s1 = seq.load(std::memory_order_acquire);
+      memcpy(&v, &value, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      s2 = seq.load(std::memory_order_relaxed);
+    } while ((s1 & 1) || s1 != s2);
+    return s1 / 2;
+  }
+
+private:
+  std::atomic<uint32_t> seq; ///< Odd while a write is in progress
+  T value;
+};
+#endif
@@ -1,46 +1,52 @@
 /** @file serial.cpp
  *  @brief serial Functions
-*/
+ */
+#include "serial.h"
+#include "dlclock.h"
+#include <cerrno>
+#include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
-#include <cinttypes>
 #include <cstring>
-#include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <termios.h>
-#include "serial.h"
+#include <time.h>
+#include <unistd.h>
 
-int uart0_filestream = -1;
+#define RINGMASK (SERIAL_RINGSZ - 1)
+
+static_assert((SERIAL_RINGSZ & RINGMASK) == 0,
+              "SERIAL_RINGSZ must be a power of two");
+
+/// Port used by the serial_init/serial_readln interface
+static serial_t uart0 = {-1};
+
+typedef struct baudrate {
+  int bps;      ///< Bits per second
+  speed_t code; ///< termios speed
+} baudrate_t;
+
+static const baudrate_t baudrates[] = {
+    {4800, B4800},     {9600, B9600},     {19200, B19200},
+    {38400, B38400},   {57600, B57600},   {115200, B115200},
+    {230400, B230400}, {460800, B460800}, {921600, B921600},
+};
 
 /** @brief Serial port setup
  *  @author Paul Moggach
  *  @date 01JAN2019
  */
-void serial_init(void)
-{
-    uart0_filestream = open(PORTNAME, O_RDWR | O_NOCTTY | O_NDELAY);
-
-    if (uart0_filestream == -1)
-    {
-        //TODO error handling...
-    }
-}
+void serial_init(void) { serial_open(&uart0, PORTNAME, SERIAL_BAUD); }
 
 /** @brief Serial port configuration
  *  @author Paul Moggach
  *  @date 01JAN2019
+ *
+ *  serial_init already configures the port, this only restores the default
+ *  rate.
  */
-void serial_config(void)
-{
-    struct termios options;
-    tcgetattr(uart0_filestream, &options);
-    options.c_cflag = B9600 | CS8 | CLOCAL | CREAD;
-    options.c_iflag = IGNPAR;
-    options.c_oflag = 0;
-    options.c_lflag = 0;
-    tcflush(uart0_filestream, TCIFLUSH);
-    tcsetattr(uart0_filestream, TCSANOW, &options);
-}
+void serial_config(void) { serial_set_baud(&uart0, SERIAL_BAUD); }
 
 /** @brief Writes a line to the serial port
  *  @author Paul Moggach
@@ -48,22 +54,19 @@ void serial_config(void)
  *  @param line char * to buffer
  *  @param len number of characters to write
  */
-void serial_println(const char *line, int len)
-{
-    if (uart0_filestream != -1)
-	{
-        char *cpstr = (char *)malloc((len+1) * sizeof(char));
-        strcpy(cpstr, line);
-        cpstr[len-1] = '\r';
-        cpstr[len] = '\n';
-
-        int count = write(uart0_filestream, cpstr, len+1);
-        if (count < 0)
-		{
-            //TODO: handle errors...
-        }
-        free(cpstr);
+void serial_println(const char *line, int len) {
+  if (uart0.fd != -1 && len > 0) {
+    char *cpstr = (char *)malloc((len + 1) * sizeof(char));
+    memcpy(cpstr, line, len);
+    cpstr[len - 1] = '\r';
+    cpstr[len] = '\n';
+
+    int count = write(uart0.fd, cpstr, len + 1);
+    if (count < 0) {
+      // TODO: handle errors...
     }
+    free(cpstr);
+  }
 }
 
 /** @brief Reads a line from the serial port.
@@ -71,37 +74,236 @@ void serial_println(const char *line, int len)
  *  @date 01JAN2019
  *  @param buffer char *
  *  @param len int number of characters to read
+ *
+ *  Blocks until a line arrives; buffer is an empty string if the port
+ *  fails.
  */
-void serial_readln(char *buffer, int len)
-{
-    char c;
-    char *b = buffer;
-    int rx_length = -1;
-    while(1)
-	{
-        rx_length = read(uart0_filestream, (void*)(&c), 1);
-
-        if (rx_length <= 0)
-		{
-            //wait for messages
-            sleep(1);
-        } else
-		{
-            if (c == '\n')
-			{
-                *b++ = '\0';
-                break;
-            }
-            *b++ = c;
-        }
-    }
+void serial_readln(char *buffer, int len) {
+  if (len > 0 &&
+      serial_readline(&uart0, buffer, (size_t)len, SERIAL_FOREVER) < 0) {
+    buffer[0] = '\0';
+  }
 }
 
 /** @brief Closes serial port
  *  @author Paul Moggach
  *  @date 01JAN2019
  */
-void serial_close(void)
-{
-    close(uart0_filestream);
+void serial_close(void) { serial_shut(&uart0); }
+
+/** @brief Open a tty in raw mode for event-driven reading.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param port port to set up
+ *  @param path tty device, or the slave side of a pseudo-terminal
+ *  @param baud line rate in bits/s, see serial_set_baud
+ *  @return 0 on success, -1 with errno set on failure
+ */
+int serial_open(serial_t *port, const char *path, int baud) {
+  struct termios options;
+
+  memset(port, 0, sizeof(*port));
+  port->fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (port->fd < 0) {
+    return -1;
+  }
+  if (tcgetattr(port->fd, &options) < 0) {
+    serial_shut(port);
+    return -1;
+  }
+  cfmakeraw(&options);
+  options.c_cflag |= CLOCAL | CREAD;
+  options.c_iflag |= IGNPAR;
+  // poll does the waiting, a read only collects what is already there
+  options.c_cc[VMIN] = 0;
+  options.c_cc[VTIME] = 0;
+  if (tcsetattr(port->fd, TCSANOW, &options) < 0 ||
+      serial_set_baud(port, baud) < 0) {
+    serial_shut(port);
+    return -1;
+  }
+  tcflush(port->fd, TCIFLUSH);
+  return 0;
+}
+
+/** @brief Change the line rate of an open port.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param port open port
+ *  @param baud 4800, 9600, 19200, 38400, 57600, 115200, 230400, 460800 or
+ *  921600
+ *  @return 0 on success, -1 for an unsupported rate or a failed tcsetattr
+ */
+int serial_set_baud(serial_t *port, int baud) {
+  struct termios options;
+
+  for (const baudrate_t &b : baudrates) {
+    if (b.bps != baud) {
+      continue;
+    }
+    if (tcgetattr(port->fd, &options) < 0) {
+      return -1;
+    }
+    cfsetispeed(&options, b.code);
+    cfsetospeed(&options, b.code);
+    return tcsetattr(port->fd, TCSANOW, &options);
+  }
+  errno = EINVAL;
+  return -1;
+}
+
+/** @brief Wait for input and read all of it into the ring.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param port open port
+ *  @param timeout ms to wait for input, 0 to only collect what is there,
+ *  SERIAL_FOREVER to wait without limit
+ *  @return bytes added to the ring, 0 on timeout or a full ring, -1 on
+ *  error or hang-up
+ *
+ *  Reading stops when the ring is full. A full ring without a line end
+ *  cannot form a line, so its contents are dropped.
+ */
+int serial_fill(serial_t *port, int timeout) {
+  struct pollfd pfd = {port->fd, POLLIN, 0};
+  int total = 0;
+
+  if (port->fd < 0) {
+    errno = EBADF;
+    return -1;
+  }
+  if (port->head - port->tail == SERIAL_RINGSZ) {
+    if (memchr(port->ring, '\n', SERIAL_RINGSZ) != NULL) {
+      return 0;
+    }
+    port->dropped += SERIAL_RINGSZ;
+    port->tail = port->head;
+  }
+  int rc = poll(&pfd, 1, timeout);
+  if (rc <= 0) {
+    return (rc == 0 || errno == EINTR) ? 0 : -1;
+  }
+  if (pfd.revents & (POLLERR | POLLNVAL)) {
+    return -1;
+  }
+  while (port->head - port->tail < SERIAL_RINGSZ) {
+    uint32_t at = port->head & RINGMASK;
+    uint32_t space = SERIAL_RINGSZ - (port->head - port->tail);
+    if (space > SERIAL_RINGSZ - at) {
+      space = SERIAL_RINGSZ - at;
+    }
+    ssize_t n = read(port->fd, port->ring + at, space);
+    if (n > 0) {
+      port->head += (uint32_t)n;
+      total += (int)n;
+      if ((uint32_t)n < space) {
+        break;
+      }
+    } else if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n < 0 && errno == EAGAIN) {
+      break;
+    } else {
+      // End of file or a hang-up, an error only if nothing came with it
+      return (total > 0) ? total : -1;
+    }
+  }
+  return total;
+}
+
+/** @brief Take one complete line out of the ring without waiting.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param port open port
+ *  @param buf output, NUL terminated, without the '\n'
+ *  @param len size of buf, at least 2
+ *  @return length of the line in buf, 0 if no complete line is buffered
+ *
+ *  Empty lines are skipped. A line longer than len - 1 is truncated to
+ *  fit, and the rest of it is discarded.
+ */
+int serial_getline(serial_t *port, char *buf, size_t len) {
+  uint32_t n = 0;
+
+  if (len < 2) {
+    return 0;
+  }
+  while (n == 0) {
+    uint32_t used = port->head - port->tail;
+    uint32_t at = port->tail & RINGMASK;
+    uint32_t first = (used < SERIAL_RINGSZ - at) ? used : SERIAL_RINGSZ - at;
+    const char *nl = (const char *)memchr(port->ring + at, '\n', first);
+    if (nl != NULL) {
+      n = (uint32_t)(nl - (port->ring + at));
+    } else {
+      nl = (const char *)memchr(port->ring, '\n', used - first);
+      if (nl == NULL) {
+        return 0;
+      }
+      n = first + (uint32_t)(nl - port->ring);
+    }
+    if (n == 0) {
+      port->tail++;
+      continue;
+    }
+
+    size_t keep = (n < len - 1) ? n : len - 1;
+    size_t part = (keep < first) ? keep : first;
+    memcpy(buf, port->ring + at, part);
+    memcpy(buf + part, port->ring, keep - part);
+    buf[keep] = '\0';
+    port->tail += n + 1;
+    port->lines++;
+    if (keep < n) {
+      port->truncated++;
+    }
+    return (int)keep;
+  }
+  return 0;
+}
+
+/** @brief Read one line, waiting for input as needed.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param port open port
+ *  @param buf output, NUL terminated, without the '\n'
+ *  @param len size of buf, at least 2
+ *  @param timeout ms to wait in total, SERIAL_FOREVER to wait without limit
+ *  @return length of the line in buf, 0 on timeout, -1 on error
+ */
+int serial_readline(serial_t *port, char *buf, size_t len, int timeout) {
+  int64_t deadline = DlMonotonicNs() + (int64_t)timeout * 1000000;
+  int n;
+
+  if (len < 2) {
+    errno = EINVAL;
+    return -1;
+  }
+  while ((n = serial_getline(port, buf, len)) == 0) {
+    int wait = SERIAL_FOREVER;
+    if (timeout != SERIAL_FOREVER) {
+      int64_t left = deadline - DlMonotonicNs();
+      if (left <= 0) {
+        return 0;
+      }
+      wait = (int)((left + 999999) / 1000000);
+    }
+    if (serial_fill(port, wait) < 0) {
+      return -1;
+    }
+  }
+  return n;
+}
+
+/** @brief Close a port.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *  @param port port to close
+ *  @return void
+ */
+void serial_shut(serial_t *port) {
+  if (port->fd >= 0) {
+    close(port->fd);
+  }
+  port->fd = -1;
 }
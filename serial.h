@@ -2,12 +2,35 @@
 #define SERIAL_H
 /** @file serial.h
  *  @brief Constants, structures, function prototypes for serial functions
-*/
+ *
+ *  A serial_t port is put in raw mode with VMIN and VTIME at 0, so a read
+ *  returns whatever the driver holds without blocking. Readers wait for
+ *  input with poll, pull everything available into a byte ring in one read
+ *  and cut complete lines out of the ring, so the latency of a line is the
+ *  poll wake-up rather than a sleep. Lines are always bounded by the caller
+ *  buffer; longer lines are truncated and counted. Any tty works, including
+ *  the slave side of a pseudo-terminal pair.
+ */
+#include <cstddef>
+#include <cstdint>
 #include <inttypes.h>
 
 #ifndef PORTNAME
 #define PORTNAME "/dev/ttyS0"
 #endif
+#define SERIAL_BAUD 9600     ///< Default line rate
+#define SERIAL_RINGSZ 4096   ///< Receive ring, a power of two
+#define SERIAL_FOREVER (-1)  ///< Timeout that never expires
+
+typedef struct serialport {
+  int fd;                     ///< Open tty, -1 when closed
+  char ring[SERIAL_RINGSZ];   ///< Received bytes not yet returned
+  uint32_t head;              ///< Free-running write index
+  uint32_t tail;              ///< Free-running read index
+  uint64_t lines;             ///< Lines returned
+  uint64_t truncated;         ///< Lines cut to fit the caller buffer
+  uint64_t dropped;           ///< Bytes discarded because no line end came
+} serial_t;
 
 ///\cond INTERNAL
 // Function Prototypes
@@ -16,5 +39,11 @@ void serial_config(void);
 void serial_println(const char *, int);
 void serial_readln(char *, int);
 void serial_close(void);
+int serial_open(serial_t *, const char *, int);
+int serial_set_baud(serial_t *, int);
+int serial_fill(serial_t *, int);
+int serial_getline(serial_t *, char *, size_t);
+int serial_readline(serial_t *, char *, size_t, int);
+void serial_shut(serial_t *);
 ///\endcond
 #endif
@@ -0,0 +1,101 @@
+#ifndef SPSC_H
+#define SPSC_H
+/** @file spsc.h
+ *  @brief Bounded lock-free single-producer/single-consumer ring buffer.
+ *  @author Caio Cotts
+ *  @date Oct 16 2026
+ *
+ *  Exactly one thread may call Push and exactly one other thread may call
+ *  Pop. Neither side ever blocks: Push fails when the ring is full and Pop
+ *  fails when it is empty.
+ */
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#define CACHELINESZ 64
+
+template <typename T, size_t N> class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N must be a power of two");
+
+public:
+  SpscRing(void) : head(0), tail(0), dropped(0) {}
+
+  /** @brief Add an item (producer side).
+   *  @return false if the ring is full, the item is then counted as dropped
+   */
+  bool Push(const T &item) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == N) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    slots[h & (N - 1)] = item;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** @brief Add up to n items with one publish (producer side).
+   *  @return number of items added, the rest are counted as dropped
+   */
+  size_t PushBatch(const T *in, size_t n) {
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t room = N - (h - tail.load(std::memory_order_acquire));
+    size_t k = (n < room) ? n : room;
+    for (size_t i = 0; i < k; i++) {
+      slots[(h + i) & (N - 1)] = in[i];
+    }
+    head.store(h + k, std::memory_order_release);
+    if (k < n) {
+      dropped.fetch_add(n - k, std::memory_order_relaxed);
+    }
+    return k;
+  }
+
+  /** @brief Remove the oldest item (consumer side).
+   *  @return false if the ring is empty
+   */
+  bool Pop(T &item) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = slots[t & (N - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** @brief Remove up to max items (consumer side).
+   *  @return number of items copied into out
+   */
+  size_t PopBatch(T *out, size_t max) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t avail = head.load(std::memory_order_acquire) - t;
+    size_t n = (avail < max) ? avail : max;
+    for (size_t i = 0; i < n; i++) {
+      out[i] = slots[(t + i) & (N - 1)];
+    }
+    tail.store(t + n, std::memory_order_release);
+    return n;
+  }
+
+  /// Items currently queued, approximate when called concurrently
+  size_t Size(void) const {
+    return head.load(std::memory_order_acquire) -
+           tail.load(std::memory_order_acquire);
+  }
+
+  size_t Capacity(void) const { return N; }
+
+  /// Items rejected because the ring was full
+  uint64_t Dropped(void) const {
+    return dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  alignas(CACHELINESZ) std::atomic<size_t> head; ///< Written by the producer
+  alignas(CACHELINESZ) std::atomic<size_t> tail; ///< Written by the consumer
+  alignas(CACHELINESZ) std::atomic<uint64_t> dropped;
+  T slots[N];
+};
+#endif
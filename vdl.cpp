@@ -5,7 +5,11 @@
  */
 
 #include "cursesMatrix.h"
+#include "dlled.h"
+#include "dlpipeline.h"
 #include "logger.h"
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <ncurses.h>
 #include <signal.h>
@@ -20,6 +24,12 @@ using namespace std;
  */
 
 int main() {
+  struct sigaction sa = {};
+  sa.sa_handler = interruptHandler;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
 #if CURSE
   initscr();
   curs_set(0);
@@ -28,51 +38,82 @@ int main() {
   init_pair(2, COLOR_BLACK, COLOR_YELLOW);
   init_pair(3, COLOR_BLACK, COLOR_BLUE);
 
-  DlInitialization();
+  int rc = DlInitialization();
+  if (rc < 0) {
+    int err = errno;
+    endwin();
+    fprintf(stderr, "vdl: cannot open the %s: %s\n",
+            (rc == -2) ? "log in " LOGDIR : "sensors", strerror(err));
+    return EXIT_FAILURE;
+  }
   DlDisplayLogo();
   refresh();
   sleep(2);
   clear();
 #else
-  DlInitialization();
+  int rc = DlInitialization();
+  if (rc < 0) {
+    perror((rc == -2) ? "vdl: cannot open the log in " LOGDIR
+                      : "vdl: cannot open the sensors");
+    return EXIT_FAILURE;
+  }
   DlDisplayLogo();
   sleep(5);
 #endif
-  int tc = 0;
+  DlPipelineStart();
+  // The LED level follows the IMU at the frame rate from here on
+  DlLedTilt(DlPipelineTilt);
+  DlLedScene(DLLED_LEVEL);
 
 #if CURSE
-  while (true) {
-    reading_s reads = DlGetLoggerReadings();
+  while (DlRunning()) {
+    reading_s reads;
+    dlpipestats_t stats;
+    dlledstats_t led;
+    dlchan_t chans[DLCH_COUNT];
+    DlPipelineLatest(&reads);
+    DlPipelineStats(&stats);
+    DlPipelineChannels(chans);
+    erase();
     DlDisplayLoggerReadings(reads);
-    cursUpdateLevel(0, 70, reads.xa, reads.ya);
-    DlUpdateLevel(reads.xa, reads.ya);
-    if (tc == LOGCOUNT) {
-      DlSaveLoggerData(reads);
-      tc = 0;
-      sleep(0.5);
-      refresh();
-      clear();
-      continue;
+    printw("Saved: %llu\tDropped: %llu\tTrack: %llu/%llu fixes\n",
+           (unsigned long long)stats.saved, (unsigned long long)stats.dropped,
+           (unsigned long long)stats.track, (unsigned long long)stats.gps);
+    DlLedStats(&led);
+    printw("LED frames: %llu shown of %llu\n",
+           (unsigned long long)led.commits, (unsigned long long)led.frames);
+    if (stats.env > 0) {
+      printw("Env cycle: %.1f I2C, %llu us\n",
+             (double)stats.envi2c / stats.env,
+             (unsigned long long)(stats.envns / stats.env / 1000));
+    }
+    for (dlchan_t &ch : chans) {
+      printw("%-8s runs: %-8llu overruns: %-6llu jitter: %lld/%lld us\n",
+             ch.name, (unsigned long long)ch.runs,
+             (unsigned long long)ch.overruns,
+             (long long)DlChanJitterMean(&ch) / 1000,
+             (long long)ch.jittermax / 1000);
     }
-    tc++;
-    move(0, 0);
+    cursUpdateLevel(0, 70, reads.xa, reads.ya);
+    DlUpdateStatus(reads);
     refresh();
-    sleep(0.5);
+    usleep(SLEEPTIME);
   }
 
 #else
-  while (true) {
-    reading_s reads = DlGetLoggerReadings();
+  while (DlRunning()) {
+    reading_s reads;
+    DlPipelineLatest(&reads);
     DlDisplayLoggerReadings(reads);
-    DlUpdateLevel(reads.xa, reads.ya);
-    if (tc == LOGCOUNT) {
-      DlSaveLoggerData(reads);
-      tc = 0;
-      sleep(0.5);
-      continue;
-    }
-    tc++;
-    sleep(0.5);
+    DlUpdateStatus(reads);
+    usleep(SLEEPTIME);
   }
 #endif
+
+  DlPipelineStop();
+  DlShutdown();
+#if CURSE
+  endwin();
+#endif
+  return 0;
 }
\ No newline at end of file